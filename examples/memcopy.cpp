@@ -0,0 +1,133 @@
+#include <core.h>
+#include <eda/altera/avalon.h>
+#include <eda/altera/avalon_sim.h>
+#include <chrono>
+#include <fstream>
+#include <cstring>
+#include "common.h"
+
+using namespace ch::core;
+using namespace ch::htl;
+using namespace eda::altera::avalon;
+
+// streams a buffer from one Avalon port to another at full bus rate
+class memcopy {
+public:
+  using data_type = ch_bit<avm_v0::DataW>;
+
+  __io (
+    __in (ch_uint<avm_v0::AddrW>) dst,
+    __in (ch_uint<avm_v0::AddrW>) src,
+    __in (ch_uint32)       count,
+      (avalon_st_io)       avs,
+    (avalon_mm_io<avm_v0>) avm_dst,
+    (avalon_mm_io<avm_v0>) avm_src
+  );
+
+  __enum (ctrl_state, (idle, running, done));
+
+  void describe() {
+    ch_reg<ctrl_state> state(ctrl_state::idle);
+    ch_reg<ch_uint32> remaining(0);
+
+    __switch (state)
+    __case (ctrl_state::idle) {
+      __if (io.avs.valid_in) {
+        state->next = ctrl_state::running;
+      };
+    }
+    __case (ctrl_state::running) {
+      __if (0 == remaining) {
+        state->next = ctrl_state::done;
+      };
+    }
+    __case (ctrl_state::done) {
+      __if (!avm_writer_.io.busy && io.avs.ready_in) {
+        state->next = ctrl_state::idle;
+      };
+    };
+
+    auto start = io.avs.valid_in && (state == ctrl_state::idle);
+    __if (start) {
+      remaining->next = io.count;
+    }__elif (avm_writer_.io.enq.ready && avm_writer_.io.enq.valid) {
+      remaining->next = remaining - 1;
+    };
+
+    avm_reader_.io.base_addr = io.src;
+    avm_reader_.io.count = io.count;
+    avm_reader_.io.start = start;
+    avm_reader_.io.avm(io.avm_src);
+
+    avm_writer_.io.enq(avm_reader_.io.deq);
+    avm_writer_.io.base_addr = io.dst;
+    avm_writer_.io.start = start;
+    avm_writer_.io.done = (state == ctrl_state::done);
+    avm_writer_.io.avm(io.avm_dst);
+
+    io.avs.ready_out = (state == ctrl_state::idle);
+    io.avs.valid_out = (state == ctrl_state::done) && !avm_writer_.io.busy;
+  }
+
+private:
+
+  ch_module<avm_reader<data_type>> avm_reader_;
+  ch_module<avm_writer<data_type>> avm_writer_;
+};
+
+int main() {
+  unsigned count = 4096;
+  unsigned block_size = avm_v0::DataW / 8;
+
+  ch_device<memcopy> device;
+
+  // the source buffer is a memory-mapped file
+  const char* src_file = "memcopy.bin";
+  {
+    std::vector<uint8_t> buffer_in(count * block_size);
+    for (unsigned i = 0; i < buffer_in.size(); ++i) {
+      buffer_in[i] = (i * 7) ^ (i >> 8);
+    }
+    std::ofstream out(src_file, std::ios::binary);
+    out.write((const char*)buffer_in.data(), buffer_in.size());
+  }
+  std::vector<uint8_t> buffer_out(count * block_size + block_size);
+
+  avm_slave_driver<avm_v0> avm_driver(2, 128, 20);
+  avm_driver.bind(0, device.io.avm_src, src_file);
+  avm_driver.bind(1, device.io.avm_dst, buffer_out.data(), buffer_out.size());
+
+  // run simulation
+  ch_simulator sim(device);
+  device.io.avs.valid_in = false;
+  device.io.avs.ready_in = false;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  auto ticks = sim.run([&](ch_tick t)->bool {
+    if (2 == t) {
+      device.io.dst   = 0;
+      device.io.src   = 0;
+      device.io.count = count;
+      device.io.avs.valid_in = true;
+      device.io.avs.ready_in = true;
+    }
+    avm_driver.tick();
+    return (!device.io.avs.valid_out && (t < MAX_TICKS));
+  }, 2);
+  auto end_time = std::chrono::high_resolution_clock::now();
+  avm_driver.flush();
+
+  auto cycles = ticks / 2;
+  auto elapsed = std::chrono::duration<double>(end_time - start_time).count();
+  std::cout << "Simulation run time: " << std::dec << cycles << " cycles" << std::endl;
+  std::cout << "Simulation speed: " << uint64_t(cycles / elapsed) << " cycles/sec" << std::endl;
+  std::cout << "memory stats:" << std::endl;
+  std::cout << avm_driver.stats();
+
+  // verify output
+  std::vector<uint8_t> buffer_ref(count * block_size);
+  std::ifstream in(src_file, std::ios::binary);
+  in.read((char*)buffer_ref.data(), buffer_ref.size());
+  CHECK(0 == std::memcmp(buffer_out.data(), buffer_ref.data(), buffer_ref.size()));
+
+  return 0;
+}
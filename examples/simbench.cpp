@@ -0,0 +1,126 @@
+#include <core.h>
+#include <chrono>
+#include "common.h"
+
+using namespace ch::core;
+
+// interpreter throughput benchmark: arithmetic, slice/concat proxies and
+// select chains, simulated with the JIT disabled.
+
+template <typename T>
+auto rotl8(const T& x) {
+  return ch_cat<ch_uint32>(ch_slice<24>(x), ch_slice<8>(x, 24));
+}
+
+struct Mixer {
+  __io (
+    __in (ch_uint32)  seed,
+    __out (ch_uint32) out
+  );
+
+  void describe() {
+    ch_reg<ch_uint32> a(0x12345678), b(0x9abcdef0), c(0x0f1e2d3c), d(0x4b5a6978);
+    auto sel = ch_slice<2>(d, 3);
+    auto na = ch_sel(sel == 0, a + b)
+                    (sel == 1, a ^ c)
+                    (sel == 2, a - d)
+                               (rotl8(a) + 1);
+    auto nb = rotl8(b ^ na);
+    auto nc = c + ch_cat<ch_uint32>(ch_slice<16>(a), ch_slice<16>(b, 16));
+    auto nd = ch_case(ch_slice<2>(c, 7),
+                   0, d + 3)
+                  (1, d ^ b)
+                  (2, d - a)
+                     (d + c);
+    a->next = na;
+    b->next = nb;
+    c->next = nc;
+    d->next = nd ^ io.seed;
+    io.out = a ^ b ^ c ^ d;
+  }
+};
+
+struct SimBench {
+  __io (
+    __in (ch_uint32)  seed,
+    __out (ch_uint32) out
+  );
+
+  void describe() {
+    m0_.io.seed = io.seed;
+    m1_.io.seed = io.seed + 1;
+    m2_.io.seed = io.seed ^ 0x5555;
+    m3_.io.seed = ch_cat<ch_uint32>(ch_slice<16>(io.seed), ch_slice<16>(io.seed, 16));
+    io.out = m0_.io.out ^ m1_.io.out ^ m2_.io.out ^ m3_.io.out;
+  }
+
+  ch_module<Mixer> m0_, m1_, m2_, m3_;
+};
+
+// reference model
+struct MixerModel {
+  uint32_t a = 0x12345678, b = 0x9abcdef0, c = 0x0f1e2d3c, d = 0x4b5a6978;
+
+  static uint32_t rotl8(uint32_t x) {
+    return (x << 8) | (x >> 24);
+  }
+
+  uint32_t out() const {
+    return a ^ b ^ c ^ d;
+  }
+
+  void step(uint32_t seed) {
+    uint32_t na, nd;
+    switch ((d >> 3) & 3) {
+    case 0:  na = a + b; break;
+    case 1:  na = a ^ c; break;
+    case 2:  na = a - d; break;
+    default: na = rotl8(a) + 1; break;
+    }
+    switch ((c >> 7) & 3) {
+    case 0:  nd = d + 3; break;
+    case 1:  nd = d ^ b; break;
+    case 2:  nd = d - a; break;
+    default: nd = d + c; break;
+    }
+    auto nb = rotl8(b ^ na);
+    auto nc = c + ((a << 16) | (b >> 16));
+    a = na;
+    b = nb;
+    c = nc;
+    d = nd ^ seed;
+  }
+};
+
+int main() {
+  uint32_t seed = 0x600dcafe;
+  ch_tick cycles = 1000000;
+
+  ch_setflags(ch_flags::disable_jit);
+
+  ch_device<SimBench> device;
+  ch_simulator sim(device);
+
+  device.io.seed = seed;
+  sim.reset();
+  auto start_time = std::chrono::high_resolution_clock::now();
+  sim.step(cycles * 2);
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto elapsed = std::chrono::duration<double>(end_time - start_time).count();
+  std::cout << "Simulation run time: " << std::dec << cycles << " cycles" << std::endl;
+  std::cout << "Simulation speed: " << uint64_t(cycles / elapsed) << " cycles/sec" << std::endl;
+
+  // verify output
+  MixerModel m[4];
+  uint32_t seeds[4] = {seed, seed + 1, seed ^ 0x5555, (seed << 16) | (seed >> 16)};
+  for (ch_tick t = 0; t < cycles; ++t) {
+    for (int i = 0; i < 4; ++i) {
+      m[i].step(seeds[i]);
+    }
+  }
+  auto out = m[0].out() ^ m[1].out() ^ m[2].out() ^ m[3].out();
+  CHECK(device.io.out == out);
+
+  return 0;
+}
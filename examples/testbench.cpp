@@ -0,0 +1,91 @@
+#include <core.h>
+#include <testbench.h>
+#include "common.h"
+
+using namespace ch::core;
+
+template <typename T, unsigned N>
+struct FiFo {
+  static_assert (ispow2(N), "invalid size");
+  static constexpr unsigned addr_width = log2ceil(N);
+  __io (
+    __in (T)        din,
+    __in (ch_bool)  push,
+    __in (ch_bool)  pop,
+    __out (T)       dout,
+    __out (ch_bool) empty,
+    __out (ch_bool) full
+  );
+
+  void describe() {
+    ch_reg<ch_uint<addr_width+1>> rd_ptr(0), wr_ptr(0);
+
+    auto rd_a = ch_slice<addr_width>(rd_ptr);
+    auto wr_a = ch_slice<addr_width>(wr_ptr);
+
+    auto reading = io.pop && !io.empty;
+    auto writing = io.push && !io.full;
+
+    rd_ptr->next = ch_sel(reading, rd_ptr + 1, rd_ptr);
+    wr_ptr->next = ch_sel(writing, wr_ptr + 1, wr_ptr);
+
+    ch_mem<T, N> mem;
+    mem.write(wr_a, io.din, writing);
+
+    io.dout  = mem.read(rd_a);
+    io.empty = (wr_ptr == rd_ptr);
+    io.full  = (wr_a == rd_a) && (wr_ptr[addr_width] != rd_ptr[addr_width]);
+  }
+};
+
+int main() {
+  const int count = 256;
+  ch_device<FiFo<ch_uint8, 4>> fifo;
+  ch_simulator sim(fifo);
+  ch_testbench tb(sim);
+
+  fifo.io.push = false;
+  fifo.io.pop  = false;
+  sim.reset();
+
+  std::vector<int> received;
+
+  // pushes values with idle gaps, waiting while the queue is full
+  auto producer = [&]() -> ch_task {
+    for (int i = 0; i < count; ++i) {
+      co_await tb.until(fifo.io.full, false);
+      fifo.io.din  = i;
+      fifo.io.push = true;
+      co_await tb.posedge();
+      fifo.io.push = false;
+      co_await tb.posedge(i % 5);
+    }
+  };
+
+  // pops values as soon as they are available, stalling periodically
+  auto consumer = [&]() -> ch_task {
+    while (received.size() < count) {
+      co_await tb.until(fifo.io.empty, false);
+      received.push_back(static_cast<int>(fifo.io.dout));
+      fifo.io.pop = true;
+      co_await tb.posedge();
+      fifo.io.pop = false;
+      if (0 == (received.size() % 32)) {
+        co_await tb.posedge(20);
+      }
+    }
+  };
+
+  tb.spawn(producer());
+  tb.spawn(consumer());
+  auto cycles = tb.run(MAX_TICKS);
+
+  std::cout << "Simulation run time: " << std::dec << cycles << " cycles" << std::endl;
+
+  CHECK(received.size() == count);
+  for (int i = 0; i < count; ++i) {
+    CHECK(received[i] == i);
+  }
+
+  return 0;
+}
@@ -169,6 +169,9 @@ int main() {
   // flush pending requests
   avm_driver.flush();
 
+  std::cout << "memory stats:" << std::endl;
+  std::cout << avm_driver.stats();
+
   // copy output data
   std::vector<ch_system_t<data_type>> test_result(count);
   for (unsigned i = 0; i < count; ++i) {
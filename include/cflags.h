@@ -26,7 +26,9 @@ enum class ch_flags {
   disable_snc     = (1 << 17), // 131072
   disable_cpb     = (1 << 18), // 262144
   merged_only_opt = (1 << 19), // 524288
-  verbose_tracing = (1 << 20)  // 1048576
+  verbose_tracing = (1 << 20), // 1048576
+  deferred_print  = (1 << 21), // 2097152
+  activity_sim    = (1 << 22)  // 4194304
 };
 
 inline constexpr auto operator|(ch_flags lsh, ch_flags rhs) {
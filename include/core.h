@@ -96,6 +96,8 @@ namespace logic {
 
   using ch::internal::ch_udf_comb;
   using ch::internal::ch_udf_seq;
+  using ch::internal::ch_udf_async;
+  using ch::internal::ch_udf_ptr;
 
   using ch::internal::ch_ostream;
 
@@ -347,6 +349,8 @@ namespace logic {
   using ch::internal::ch_assert;
   using ch::internal::ch_tap;
   using ch::internal::ch_now;
+  using ch::internal::ch_cover;
+  using ch::internal::ch_bin;
 }
 
 //
@@ -362,6 +366,7 @@ namespace system {
 
   using ch::internal::ch_read;
   using ch::internal::ch_write;
+  using ch::internal::ch_port_handle;
 
   //
   // basic types
@@ -376,6 +381,10 @@ namespace system {
   using ch::internal::ch_device;
   using ch::internal::ch_simulator;
   using ch::internal::ch_tracer;
+  using ch::internal::ch_divergence;
+  using ch::internal::ch_watch;
+  using ch::internal::ch_coverage;
+  using ch::internal::ch_sim_stats;
   using ch::internal::ch_flags;
 
   //
@@ -392,6 +401,12 @@ namespace system {
 
   using ch::internal::ch_toVerilog;
   using ch::internal::ch_toFIRRTL;
+
+  //
+  // trace functions
+  //
+
+  using ch::internal::ch_traceDiff;
 }
 
 //
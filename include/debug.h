@@ -22,6 +22,37 @@ void registerTap(const lnode& node,
 
 lnodeimpl* getTap(const std::string& name, unsigned instance);
 
+struct ch_bin {
+  ch_bin(const std::string& name, uint64_t value)
+    : name(name), lo(value), hi(value), to_lo(0), to_hi(0), is_transition(false)
+  {}
+
+  ch_bin(const std::string& name, uint64_t lo, uint64_t hi)
+    : name(name), lo(lo), hi(hi), to_lo(0), to_hi(0), is_transition(false)
+  {}
+
+  // value changing from [from] to [to] between two samples
+  static ch_bin transition(const std::string& name, uint64_t from, uint64_t to) {
+    ch_bin bin(name, from);
+    bin.to_lo = to;
+    bin.to_hi = to;
+    bin.is_transition = true;
+    return bin;
+  }
+
+  std::string name;
+  uint64_t lo;
+  uint64_t hi;
+  uint64_t to_lo;
+  uint64_t to_hi;
+  bool is_transition;
+};
+
+void createCoverNode(const std::string& name,
+                     const std::vector<lnode>& values,
+                     const std::vector<std::vector<ch_bin>>& bins,
+                     const source_location& sloc);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // time function
@@ -129,6 +160,29 @@ inline void ch_assert(const ch_bool& cond, const std::string& message, CH_SLOC)
 #endif
 }
 
+// cover functions
+// values are sampled on the active edge of the current clock domain,
+// all matching bins are incremented; an empty bin list creates one bin per value.
+
+template <typename T>
+void ch_cover(const std::string& name,
+              const T& value,
+              const std::vector<ch_bin>& bins,
+              CH_SLOC) {
+  static_assert(is_logic_type_v<T>, "invalid type");
+  createCoverNode(name, {get_lnode(value)}, {bins}, sloc);
+}
+
+template <typename T, typename U>
+void ch_cover(const std::string& name,
+              const T& a, const std::vector<ch_bin>& a_bins,
+              const U& b, const std::vector<ch_bin>& b_bins,
+              CH_SLOC) {
+  static_assert(is_logic_type_v<T>, "invalid type");
+  static_assert(is_logic_type_v<U>, "invalid type");
+  createCoverNode(name, {get_lnode(a), get_lnode(b)}, {a_bins, b_bins}, sloc);
+}
+
 // tap function
 
 template <typename T>
@@ -1,8 +1,8 @@
 #include <vector>
-#include <list>
 #include <memory>
 #include <optional>
 #include <random>
+#include <cstring>
 #include "avalon.h"
 
 namespace eda {
@@ -14,6 +14,44 @@ using namespace ch::extension;
 
 class avm_slave_driver_impl;
 
+// DRAM timing model parameters, timings are in clock cycles
+struct avm_dram_config {
+  uint32_t num_banks = 8;
+  uint32_t row_size  = 2048;  // bytes per row
+  uint32_t tCAS      = 11;    // column access
+  uint32_t tRCD      = 11;    // row activation
+  uint32_t tRP       = 11;    // row precharge
+  uint32_t tREFI     = 7800;  // refresh interval, 0 disables refresh
+  uint32_t tRFC      = 260;   // refresh duration
+  uint32_t bus_width = 0;     // data bus bytes per cycle, 0 for unlimited
+};
+
+struct avm_stats {
+  uint64_t cycles        = 0;
+  uint64_t reads         = 0;
+  uint64_t writes        = 0;
+  uint64_t bytes_read    = 0;
+  uint64_t bytes_written = 0;
+  uint64_t row_hits      = 0;
+  uint64_t row_misses    = 0;
+  uint64_t row_conflicts = 0;
+  uint64_t refreshes     = 0;
+  uint64_t total_latency = 0;
+  uint64_t max_latency   = 0;
+
+  double avg_latency() const {
+    auto count = reads + writes;
+    return count ? double(total_latency) / count : 0.0;
+  }
+
+  // bytes transferred per cycle
+  double bandwidth() const {
+    return cycles ? double(bytes_read + bytes_written) / cycles : 0.0;
+  }
+};
+
+std::ostream& operator<<(std::ostream& out, const avm_stats& stats);
+
 class avm_slave_driver_base {
 public:
 
@@ -21,6 +59,8 @@ public:
 
   void flush();
 
+  const avm_stats& stats() const;
+
 protected:
 
   struct status_t {
@@ -31,7 +71,7 @@ protected:
 
   struct request_t {
     bool write;
-    sdata_type wdata;
+    const uint8_t* wdata;
     uint64_t address;
     uint64_t byteenable;
     uint32_t burstcount;
@@ -41,11 +81,14 @@ protected:
                         uint32_t data_size,
                         uint32_t max_burst_size,
                         uint32_t reqs_queue_size,
-                        uint32_t latency);
+                        uint32_t latency,
+                        const std::optional<avm_dram_config>& dram);
 
   status_t tick(uint32_t reqs_mask);
 
-  void bind(uint32_t channel, const void* buffer, uint32_t size);
+  void bind(uint32_t channel, const void* buffer, uint64_t size);
+
+  void bind(uint32_t channel, const std::string& file);
 
   virtual request_t get_request_info(uint32_t channel) = 0;
 
@@ -64,7 +107,22 @@ public:
                             AVM::DataW / 8,
                             (1 << (AVM::BurstW-1)),
                             reqs_queue_size,
-                            latency)
+                            latency,
+                            std::nullopt)
+    , ports_(num_ports)
+  {}
+
+  // the latency is added to the DRAM access time as controller overhead
+  avm_slave_driver(uint32_t num_ports,
+                   uint32_t reqs_queue_size,
+                   uint32_t latency,
+                   const avm_dram_config& dram)
+    : avm_slave_driver_base(num_ports,
+                            AVM::DataW / 8,
+                            (1 << (AVM::BurstW-1)),
+                            reqs_queue_size,
+                            latency,
+                            dram)
     , ports_(num_ports)
   {}
 
@@ -79,16 +137,28 @@ public:
     ports_[channel] = std::move(port);
   }
 
-  void bind(uint32_t channel, const void* buffer, uint32_t size) {
+  // the buffer is accessed in place, no copy is made
+  void bind(uint32_t channel, const void* buffer, uint64_t size) {
     CH_CHECK(channel < ports_.size(), "invalid port index");
     base::bind(channel, buffer, size);
   }
 
-  void bind(uint32_t channel, const io_type& io, const void* buffer, uint32_t size) {
+  // the file is mapped in memory, writes are stored back to it
+  void bind(uint32_t channel, const std::string& file) {
+    CH_CHECK(channel < ports_.size(), "invalid port index");
+    base::bind(channel, file);
+  }
+
+  void bind(uint32_t channel, const io_type& io, const void* buffer, uint64_t size) {
     this->bind(channel, io);
     this->bind(channel, buffer, size);
   }
 
+  void bind(uint32_t channel, const io_type& io, const std::string& file) {
+    this->bind(channel, io);
+    this->bind(channel, file);
+  }
+
   void tick() {
     // get requests status
     uint32_t reqs_mask = 0;
@@ -110,7 +180,8 @@ public:
       port->writeack = false;
       if (i == status.rsp_channel) {
         if (status.rsp_wdata) {
-          ch_write(port->readdata, 0, status.rsp_wdata, 0, ch_width_v<decltype(port->readdata)>);
+          auto rdata = (uint8_t*)system_accessor::data(port->readdata).words();
+          std::memcpy(rdata, status.rsp_wdata, AVM::DataW / 8);
           port->readdatavalid = true;
         } else {
           port->writeack = true;
@@ -126,7 +197,7 @@ protected:
     assert(channel < ports_.size());
     auto& port = ports_[channel];
     return request_t{static_cast<bool>(port->write),
-                     static_cast<sdata_type>(port->writedata),
+                     (const uint8_t*)system_accessor::data(port->writedata).words(),
                      static_cast<uint64_t>(port->address),
                      static_cast<uint64_t>(port->byteenable),
                      static_cast<uint32_t>(port->burstcount)};
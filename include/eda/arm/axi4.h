@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../../core.h"
+
+namespace eda {
+namespace arm {
+namespace axi4 {
+
+using namespace ch::logic;
+using namespace ch::literals;
+
+template <unsigned D, unsigned A, unsigned I>
+struct axi4_properties {
+  static constexpr unsigned DataW = D;
+  static constexpr unsigned AddrW = A;
+  static constexpr unsigned IdW   = I;
+  static constexpr unsigned LenW  = 8;
+  static constexpr unsigned SizeW = 3;
+  static_assert(ispow2(D) && D >= 8 && D <= 512, "invalid data width");
+  static_assert(A <= 64, "invalid address width");
+  static_assert(I != 0 && I <= 32, "invalid id width");
+};
+
+using axi4_v0 = axi4_properties<512, 64, 4>;
+
+// burst types
+enum class axi4_burst { fixed = 0, incr = 1, wrap = 2 };
+
+// response codes
+enum class axi4_resp { okay = 0, exokay = 1, slverr = 2, decerr = 3 };
+
+template <typename T = axi4_v0>
+__interface (axi4_mm_io, (
+  // write address channel
+  __out (ch_bit<T::IdW>)     awid,
+  __out (ch_bit<T::AddrW>)   awaddr,
+  __out (ch_bit<T::LenW>)    awlen,
+  __out (ch_bit<T::SizeW>)   awsize,
+  __out (ch_bit2)            awburst,
+  __out (ch_bool)            awvalid,
+  __in  (ch_bool)            awready,
+  // write data channel
+  __out (ch_bit<T::DataW>)   wdata,
+  __out (ch_bit<T::DataW/8>) wstrb,
+  __out (ch_bool)            wlast,
+  __out (ch_bool)            wvalid,
+  __in  (ch_bool)            wready,
+  // write response channel
+  __in  (ch_bit<T::IdW>)     bid,
+  __in  (ch_bit2)            bresp,
+  __in  (ch_bool)            bvalid,
+  __out (ch_bool)            bready,
+  // read address channel
+  __out (ch_bit<T::IdW>)     arid,
+  __out (ch_bit<T::AddrW>)   araddr,
+  __out (ch_bit<T::LenW>)    arlen,
+  __out (ch_bit<T::SizeW>)   arsize,
+  __out (ch_bit2)            arburst,
+  __out (ch_bool)            arvalid,
+  __in  (ch_bool)            arready,
+  // read data channel
+  __in  (ch_bit<T::IdW>)     rid,
+  __in  (ch_bit<T::DataW>)   rdata,
+  __in  (ch_bit2)            rresp,
+  __in  (ch_bool)            rlast,
+  __in  (ch_bool)            rvalid,
+  __out (ch_bool)            rready
+));
+
+template <typename T = axi4_v0>
+__interface (axi4_stream_io, (
+  __out (ch_bit<T::DataW>)   tdata,
+  __out (ch_bit<T::DataW/8>) tkeep,
+  __out (ch_bit<T::IdW>)     tid,
+  __out (ch_bool)            tlast,
+  __out (ch_bool)            tvalid,
+  __in  (ch_bool)            tready
+));
+
+}
+}
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstring>
+#include "axi4.h"
+
+namespace eda {
+namespace arm {
+namespace axi4 {
+
+using namespace ch::core;
+using namespace ch::extension;
+
+struct axi4_config {
+  uint32_t latency         = 20;    // cycles from address acceptance to read data or write response
+  uint32_t max_outstanding = 16;    // accepted transactions per port and direction
+  uint32_t bus_width       = 0;     // bytes transferred per cycle across ports, 0 for unlimited
+  bool     reorder         = false; // return transactions with different ids out of order
+};
+
+struct axi4_stats {
+  uint64_t cycles            = 0;
+  uint64_t reads             = 0;
+  uint64_t writes            = 0;
+  uint64_t read_beats        = 0;
+  uint64_t write_beats       = 0;
+  uint64_t bytes_read        = 0;
+  uint64_t bytes_written     = 0;
+  uint64_t read_latency      = 0;
+  uint64_t write_latency     = 0;
+  uint64_t max_read_latency  = 0;
+  uint64_t max_write_latency = 0;
+
+  double avg_read_latency() const {
+    return reads ? double(read_latency) / reads : 0.0;
+  }
+
+  double avg_write_latency() const {
+    return writes ? double(write_latency) / writes : 0.0;
+  }
+
+  // bytes transferred per cycle
+  double bandwidth() const {
+    return cycles ? double(bytes_read + bytes_written) / cycles : 0.0;
+  }
+};
+
+std::ostream& operator<<(std::ostream& out, const axi4_stats& stats);
+
+class axi4_slave_driver_impl;
+
+class axi4_slave_driver_base {
+public:
+
+  virtual ~axi4_slave_driver_base();
+
+  const axi4_stats& stats() const;
+
+protected:
+
+  struct addr_t {
+    uint32_t id;
+    uint64_t addr;
+    uint32_t len;
+    uint32_t size;
+    uint32_t burst;
+  };
+
+  // master signals sampled on a tick
+  struct master_t {
+    bool awvalid;
+    addr_t aw;
+    bool wvalid;
+    bool wlast;
+    uint64_t wstrb;
+    const uint8_t* wdata;
+    bool bready;
+    bool arvalid;
+    addr_t ar;
+    bool rready;
+  };
+
+  // slave signals driven for the next cycle
+  struct slave_t {
+    bool awready;
+    bool wready;
+    bool arready;
+    bool bvalid;
+    uint32_t bid;
+    uint32_t bresp;
+    bool rvalid;
+    uint32_t rid;
+    uint32_t rresp;
+    bool rlast;
+    const uint8_t* rdata;
+  };
+
+  axi4_slave_driver_base(uint32_t num_ports,
+                         uint32_t data_size,
+                         const axi4_config& config);
+
+  void tick(const master_t* masters, slave_t* slaves);
+
+  void bind(uint32_t channel, const void* buffer, uint64_t size);
+
+  void bind(uint32_t channel, const std::string& file);
+
+  axi4_slave_driver_impl* impl_;
+  friend class axi4_slave_driver_impl;
+};
+
+// tick() is called once per clock cycle, a transfer completes when
+// valid and ready were both asserted during that cycle.
+template <typename AXI = axi4_v0>
+class axi4_slave_driver : public axi4_slave_driver_base {
+public:
+  using base = axi4_slave_driver_base;
+  using io_type = ch_flip_io<ch_system_io<axi4_mm_io<AXI>>>;
+
+  static constexpr unsigned DataB = AXI::DataW / 8;
+
+  axi4_slave_driver(uint32_t num_ports, const axi4_config& config = axi4_config())
+    : axi4_slave_driver_base(num_ports, DataB, config)
+    , ports_(num_ports)
+    , masters_(num_ports)
+    , slaves_(num_ports)
+  {}
+
+  void bind(uint32_t channel, const io_type& io) {
+    CH_CHECK(channel < ports_.size(), "invalid port index");
+    auto port = std::make_unique<io_type>(io);
+    // reset output signals
+    port->awready = false;
+    port->wready  = false;
+    port->bvalid  = false;
+    port->arready = false;
+    port->rvalid  = false;
+    port->rlast   = false;
+    ports_[channel] = std::move(port);
+  }
+
+  // the buffer is accessed in place, no copy is made
+  void bind(uint32_t channel, const void* buffer, uint64_t size) {
+    CH_CHECK(channel < ports_.size(), "invalid port index");
+    base::bind(channel, buffer, size);
+  }
+
+  // the file is mapped in memory, writes are stored back to it
+  void bind(uint32_t channel, const std::string& file) {
+    CH_CHECK(channel < ports_.size(), "invalid port index");
+    base::bind(channel, file);
+  }
+
+  void bind(uint32_t channel, const io_type& io, const void* buffer, uint64_t size) {
+    this->bind(channel, io);
+    this->bind(channel, buffer, size);
+  }
+
+  void bind(uint32_t channel, const io_type& io, const std::string& file) {
+    this->bind(channel, io);
+    this->bind(channel, file);
+  }
+
+  void tick() {
+    // sample master signals
+    for (uint32_t i = 0; i < ports_.size(); ++i) {
+      auto& port = ports_[i];
+      auto& master = masters_[i];
+      master.awvalid = static_cast<bool>(port->awvalid);
+      if (master.awvalid) {
+        master.aw = addr_t{static_cast<uint32_t>(port->awid),
+                           static_cast<uint64_t>(port->awaddr),
+                           static_cast<uint32_t>(port->awlen),
+                           static_cast<uint32_t>(port->awsize),
+                           static_cast<uint32_t>(port->awburst)};
+      }
+      master.wvalid = static_cast<bool>(port->wvalid);
+      if (master.wvalid) {
+        master.wdata = (const uint8_t*)system_accessor::data(port->wdata).words();
+        master.wstrb = static_cast<uint64_t>(port->wstrb);
+        master.wlast = static_cast<bool>(port->wlast);
+      }
+      master.bready  = static_cast<bool>(port->bready);
+      master.arvalid = static_cast<bool>(port->arvalid);
+      if (master.arvalid) {
+        master.ar = addr_t{static_cast<uint32_t>(port->arid),
+                           static_cast<uint64_t>(port->araddr),
+                           static_cast<uint32_t>(port->arlen),
+                           static_cast<uint32_t>(port->arsize),
+                           static_cast<uint32_t>(port->arburst)};
+      }
+      master.rready = static_cast<bool>(port->rready);
+    }
+
+    // process tick event
+    base::tick(masters_.data(), slaves_.data());
+
+    // drive slave signals
+    for (uint32_t i = 0; i < ports_.size(); ++i) {
+      auto& port = ports_[i];
+      auto& slave = slaves_[i];
+      port->awready = slave.awready;
+      port->wready  = slave.wready;
+      port->arready = slave.arready;
+      port->bvalid  = slave.bvalid;
+      if (slave.bvalid) {
+        port->bid   = slave.bid;
+        port->bresp = slave.bresp;
+      }
+      port->rvalid = slave.rvalid;
+      port->rlast  = slave.rlast;
+      if (slave.rvalid) {
+        port->rid   = slave.rid;
+        port->rresp = slave.rresp;
+        auto rdata = (uint8_t*)system_accessor::data(port->rdata).words();
+        std::memcpy(rdata, slave.rdata, DataB);
+      }
+    }
+  }
+
+protected:
+
+  std::vector<std::unique_ptr<io_type>> ports_;
+  std::vector<master_t> masters_;
+  std::vector<slave_t> slaves_;
+};
+
+}
+}
+}
@@ -311,5 +311,88 @@ public:
   }
 };
 
+///////////////////////////////////////////////////////////////////////////////
+
+// direct access to a device port's simulation storage, bypassing the
+// system io buffers. handles are valid once the simulator is created.
+template <typename T>
+class ch_port_handle {
+public:
+  static_assert(is_system_io_v<T>, "invalid type");
+  static constexpr uint32_t ch_width = ch_width_v<T>;
+  static constexpr uint32_t block_width = bitwidth_v<block_type>;
+  static constexpr uint32_t num_words = ceildiv(ch_width, block_width);
+  static constexpr bool is_writable = (ch_direction_v<T> == ch_direction::in);
+
+  explicit ch_port_handle(const T& port)
+    : words_(const_cast<block_type*>(system_accessor::data(port).words()))
+  {}
+
+  template <typename U>
+  U read() const {
+    static_assert(std::is_integral_v<U>, "invalid type");
+    static_assert(ch_width <= bitwidth_v<U>, "invalid size");
+    if constexpr (std::is_same_v<U, bool>) {
+      return (0 != this->read<uint8_t>());
+    } else {
+      using R = std::make_unsigned_t<U>;
+      R value;
+      if constexpr (1 == num_words) {
+        value = R(words_[0]);
+      } else {
+        value = 0;
+        for (uint32_t i = 0; i < num_words; ++i) {
+          value |= R(words_[i]) << (i * block_width);
+        }
+      }
+      if constexpr (ch_signed_v<T> && ch_width < bitwidth_v<R>) {
+        return U(sign_ext(value, ch_width));
+      } else {
+        return U(value);
+      }
+    }
+  }
+
+  template <typename U>
+  void write(U value) {
+    static_assert(is_writable, "invalid port direction");
+    static_assert(std::is_integral_v<U>, "invalid type");
+    static_assert(ch_width <= bitwidth_v<U>, "invalid size");
+    if constexpr (std::is_same_v<U, bool>) {
+      this->write<uint8_t>(value);
+    } else {
+      using R = std::make_unsigned_t<U>;
+      auto data = R(value);
+      if constexpr (ch_width < bitwidth_v<R>) {
+        data &= (R(1) << ch_width) - 1;
+      }
+      if constexpr (1 == num_words) {
+        words_[0] = block_type(data);
+      } else {
+        for (uint32_t i = 0; i < num_words; ++i) {
+          words_[i] = block_type(data);
+          data >>= (block_width < bitwidth_v<R> ? block_width : 0);
+        }
+      }
+    }
+  }
+
+  template <typename U>
+  ch_port_handle& operator=(U value) {
+    this->write(value);
+    return *this;
+  }
+
+  template <typename U,
+            CH_REQUIRES(std::is_integral_v<U>)>
+  explicit operator U() const {
+    return this->read<U>();
+  }
+
+protected:
+
+  block_type* words_;
+};
+
 }
 }
@@ -20,6 +20,7 @@ sdata_type loadInitData(const T& container,
   static constexpr uint32_t WORD_SIZE = bitwidth_v<block_type>;
   static constexpr uint32_t WORD_MASK = WORD_SIZE - 1;
 
+  CH_CHECK(uint64_t(data_width) * num_items <= std::numeric_limits<uint32_t>::max(), "memory too large for initialization data");
   sdata_type out(data_width * num_items);
   uint32_t src_width = bitwidth_v<typename T::value_type>;
   CH_CHECK(container.size() == (ceildiv(data_width, src_width) * num_items), "invalid input size");
@@ -52,7 +53,15 @@ class memory {
 public:
   memory(uint32_t data_width,
          uint32_t num_items,
-         const sdata_type& init_data,
+         sdata_type init_data,
+         bool force_logic_ram,
+         const std::string& name,
+         const source_location& sloc);
+
+  // hex files, or binary images mapped from '.bin' files
+  memory(uint32_t data_width,
+         uint32_t num_items,
+         const std::string& init_file,
          bool force_logic_ram,
          const std::string& name,
          const source_location& sloc);
@@ -71,6 +80,8 @@ public:
              const lnode& enable, 
              const source_location& sloc);
 
+  void set_name(const std::string& name);
+
 protected:
   memimpl* impl_;
 };
@@ -87,7 +98,7 @@ public:
   static constexpr unsigned addr_width = traits::addr_width;
   
   ch_rom(const std::string& init_file, CH_SRC_INFO)
-    : mem_(ch_width_v<T>, N, loadInitData(init_file, data_width, N), ForceLogicRAM, srcinfo.name(), srcinfo.sloc())
+    : mem_(ch_width_v<T>, N, init_file, ForceLogicRAM, srcinfo.name(), srcinfo.sloc())
   {}
 
   ch_rom(const std::initializer_list<uint32_t>& init_data, CH_SRC_INFO)
@@ -115,6 +126,11 @@ public:
     return make_logic_type<T>(mem_.aread(laddr, srcinfo.name(), srcinfo.sloc()));
   }
 
+  // name used to access the memory from the simulator
+  void set_name(const std::string& name) {
+    mem_.set_name(name);
+  }
+
 protected:
   memory mem_;
 };
@@ -130,10 +146,10 @@ public:
   static constexpr unsigned data_width = traits::data_width;
   static constexpr unsigned addr_width = traits::addr_width;
 
-  explicit ch_mem(CH_SRC_INFO) : mem_(ch_width_v<T>, N, {}, false, srcinfo.name(), srcinfo.sloc()) {}
+  explicit ch_mem(CH_SRC_INFO) : mem_(ch_width_v<T>, N, sdata_type(), false, srcinfo.name(), srcinfo.sloc()) {}
 
   ch_mem(const std::string& init_file, CH_SRC_INFO)
-    : mem_(ch_width_v<T>, N, loadInitData(init_file, data_width, N), false, srcinfo.name(), srcinfo.sloc())
+    : mem_(ch_width_v<T>, N, init_file, false, srcinfo.name(), srcinfo.sloc())
   {}
 
   ch_mem(const std::initializer_list<uint32_t>& init_data, CH_SRC_INFO)
@@ -190,6 +206,11 @@ public:
     auto l_enable = get_lnode(enable);
     mem_.write(l_addr, l_value, l_enable, srcinfo.sloc());
   }
+
+  // name used to access the memory from the simulator
+  void set_name(const std::string& name) {
+    mem_.set_name(name);
+  }
     
 protected:
   memory mem_;
@@ -7,11 +7,85 @@ namespace internal {
 
 class simulatorimpl;
 
+struct ch_divergence {
+  ch_tick tick;
+  std::string signal;
+  sdata_type expected;
+  sdata_type actual;
+};
+
+struct ch_coverage {
+  struct bin_t {
+    std::string name;
+    uint64_t hits;
+  };
+
+  struct point_t {
+    std::string name;
+    std::vector<bin_t> bins;
+  };
+
+  // fraction of bins hit at least once
+  double ratio() const;
+
+  // accumulate hits from another run, new points and bins are appended
+  void merge(const ch_coverage& other);
+
+  void save(const std::string& file) const;
+
+  void load(const std::string& file);
+
+  void report(std::ostream& out) const;
+
+  std::vector<point_t> points;
+};
+
+// build and simulation statistics, times are in seconds
+struct ch_sim_stats {
+  struct pass_t {
+    std::string name;
+    uint64_t deleted; // nodes removed by the pass
+  };
+
+  double elaboration_time = 0; // device construction, including its optimization
+  double optimize_time    = 0; // optimization passes
+  double eval_list_time   = 0; // evaluation list scheduling
+  double compile_time     = 0; // simulation code generation
+  double run_time         = 0; // step(), run() and advance() calls
+  std::vector<pass_t> passes;
+  uint64_t num_nodes  = 0;     // nodes of the simulated design
+  uint64_t eval_nodes = 0;     // scheduled nodes
+  uint64_t code_size  = 0;     // generated machine code bytes, 0 if unavailable
+  uint64_t state_size = 0;     // simulation state bytes
+  uint64_t ticks      = 0;
+  uint64_t cycles     = 0;
+
+  double cycles_per_sec() const {
+    return run_time ? (cycles / run_time) : 0.0;
+  }
+
+  void report(std::ostream& out) const;
+
+  // export as a JSON object
+  void to_json(std::ostream& out) const;
+
+  void save(const std::string& file) const;
+};
+
+// condition of a value watch
+enum class ch_watch {
+  equals,  // the port takes the given value
+  changes, // the port value changes
+  rising,  // a single-bit port goes from 0 to 1
+};
+
 class ch_simulator {
 public:  
   
   ch_simulator();
 
+  // simulators of the same devices share the compiled design and the device ports,
+  // only forks can be evaluated concurrently with the simulator they came from.
   ch_simulator(const std::vector<device_base>& devices);
 
   template <typename... Devices>
@@ -39,8 +113,116 @@ public:
 
   void eval();
 
+  bool replay(const std::string& file, ch_divergence* divergence = nullptr);
+
+  // apply a record of the binary file to the input ports at the start of
+  // every cycle, each port takes a whole number of bytes in a record.
+  template <typename... Ports>
+  void stream_inputs(const std::string& file, const Ports&... ports) {
+    static_assert(((ch_direction_v<Ports> == ch_direction::in) && ...), "invalid port direction");
+    this->bind_input_stream(file, {&system_accessor::data(ports)...});
+  }
+
+  // append a record of the ports to the binary file at the end of every cycle
+  template <typename... Ports>
+  void stream_outputs(const std::string& file, const Ports&... ports) {
+    this->bind_output_stream(file, {&system_accessor::data(ports)...});
+  }
+
+  // run until the input stream is exhausted, returns the number of cycles
+  ch_tick run_stream();
+
+  ch_coverage coverage() const;
+
+  ch_sim_stats stats() const;
+
+  // checkpoint the simulation state
+  void save(const std::string& file) const;
+
+  // restore a checkpoint into a simulator of the same design
+  void restore(const std::string& file);
+
+  // independent simulator starting from the current state,
+  // forks share the compiled design and keep private copies of the device ports.
+  ch_simulator fork() const;
+
+  template <typename T>
+  void poke(const T& port, const sdata_type& value) {
+    this->poke_port(system_accessor::data(port), value);
+  }
+
+  template <typename T, typename U,
+            CH_REQUIRES(std::is_integral_v<U>)>
+  void poke(const T& port, U value) {
+    this->poke_port(system_accessor::data(port), sdata_type(ch_width_v<T>, value));
+  }
+
+  template <typename T>
+  const sdata_type& peek(const T& port) const {
+    return this->peek_port(system_accessor::data(port));
+  }
+
+  // invoke the callback after each evaluation where the watch condition fires,
+  // the checks are compiled into the simulation code when JIT is enabled.
+  // watches are not inherited by forks.
+  template <typename T>
+  void watch(const T& port, ch_watch kind, const std::function<void(ch_tick)>& callback) {
+    this->add_watch(system_accessor::data(port), kind, sdata_type(ch_width_v<T>, 0), callback);
+  }
+
+  template <typename T>
+  void watch(const T& port, ch_watch kind, const sdata_type& value,
+             const std::function<void(ch_tick)>& callback) {
+    this->add_watch(system_accessor::data(port), kind, value, callback);
+  }
+
+  template <typename T, typename U,
+            CH_REQUIRES(std::is_integral_v<U>)>
+  void watch(const T& port, ch_watch kind, U value, const std::function<void(ch_tick)>& callback) {
+    this->add_watch(system_accessor::data(port), kind, sdata_type(ch_width_v<T>, value), callback);
+  }
+
+  void clear_watches();
+
+  // free-running clock on a clock input port,
+  // period and phase are in simulation time units.
+  template <typename T>
+  void add_clock(const T& port, ch_tick period, ch_tick phase = 0) {
+    static_assert(1 == ch_width_v<T>, "invalid clock port");
+    this->add_clock_port(system_accessor::data(port), period, phase);
+  }
+
+  // advance the simulation time, evaluating the design at clock edges only
+  void advance(ch_tick duration);
+
+  ch_tick time() const;
+
+  // backdoor access to a named memory, the buffer holds items
+  // packed back to back starting at item 'start'.
+  void load_memory(const std::string& name, const void* data, size_t size, uint32_t start = 0);
+
+  void dump_memory(const std::string& name, void* data, size_t size, uint32_t start = 0) const;
+
+  // load a binary image mapped from a file
+  void load_memory_file(const std::string& name, const std::string& file, uint32_t start = 0);
+
+  void dump_memory_file(const std::string& name, const std::string& file) const;
+
 protected:
 
+  void bind_input_stream(const std::string& file, const std::vector<const sdata_type*>& ports);
+
+  void bind_output_stream(const std::string& file, const std::vector<const sdata_type*>& ports);
+
+  void add_clock_port(const sdata_type& port, ch_tick period, ch_tick phase);
+
+  void add_watch(const sdata_type& port, ch_watch kind, const sdata_type& value,
+                 const std::function<void(ch_tick)>& callback);
+
+  void poke_port(const sdata_type& port, const sdata_type& value);
+
+  const sdata_type& peek_port(const sdata_type& port) const;
+
   ch_simulator(simulatorimpl* impl);
 
   simulatorimpl* impl_;
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "core.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "testbench.h requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <queue>
+#include <exception>
+
+namespace ch {
+namespace internal {
+
+// coroutine running inside a ch_testbench, tasks either run concurrently
+// via ch_testbench::spawn() or are awaited from another task.
+class ch_task {
+public:
+
+  struct promise_type {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    ch_task get_return_object() {
+      return ch_task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    auto final_suspend() noexcept {
+      // resume the awaiting task, if any
+      struct awaiter {
+        bool await_ready() noexcept {
+          return false;
+        }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+          auto continuation = h.promise().continuation;
+          return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return awaiter{};
+    }
+
+    void return_void() {}
+
+    void unhandled_exception() {
+      exception = std::current_exception();
+    }
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  ch_task(ch_task&& other) : handle_(other.handle_) {
+    other.handle_ = nullptr;
+  }
+
+  ch_task(const ch_task&) = delete;
+
+  ~ch_task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  ch_task& operator=(const ch_task&) = delete;
+
+  auto operator co_await() && {
+    struct awaiter {
+      handle_type handle;
+      bool await_ready() {
+        return false;
+      }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent) {
+        handle.promise().continuation = parent;
+        return handle;
+      }
+      void await_resume() {
+        if (handle.promise().exception) {
+          std::rethrow_exception(handle.promise().exception);
+        }
+      }
+    };
+    return awaiter{handle_};
+  }
+
+  handle_type release() {
+    auto handle = handle_;
+    handle_ = nullptr;
+    return handle;
+  }
+
+private:
+
+  explicit ch_task(handle_type handle) : handle_(handle) {}
+
+  handle_type handle_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// cycle scheduler for coroutine testbenches, runnable tasks are resumed
+// in batch at each cycle boundary. cycles where no task waits on a
+// condition are simulated in a single step() call.
+class ch_testbench {
+public:
+
+  explicit ch_testbench(ch_simulator& sim, ch_tick cycle_ticks = 2)
+    : sim_(sim)
+    , cycle_ticks_(cycle_ticks)
+    , cycle_(0)
+    , seq_(0)
+  {}
+
+  ~ch_testbench() {
+    // awaited tasks are owned by their parent's frame
+    for (auto task : tasks_) {
+      task.destroy();
+    }
+  }
+
+  ch_testbench(const ch_testbench&) = delete;
+
+  ch_testbench& operator=(const ch_testbench&) = delete;
+
+  // start a concurrent task at the current cycle
+  void spawn(ch_task task) {
+    auto handle = task.release();
+    tasks_.push_back(handle);
+    this->schedule(handle, cycle_);
+  }
+
+  // resume after the given number of cycles
+  auto posedge(uint64_t cycles = 1) {
+    struct awaiter {
+      ch_testbench* tb;
+      uint64_t cycles;
+      bool await_ready() {
+        return (0 == cycles);
+      }
+      void await_suspend(std::coroutine_handle<> handle) {
+        tb->schedule(handle, tb->cycle_ + cycles);
+      }
+      void await_resume() {}
+    };
+    return awaiter{this, cycles};
+  }
+
+  // resume at the first cycle boundary where the predicate holds
+  template <typename Pred>
+  auto until(Pred&& pred) {
+    struct awaiter {
+      ch_testbench* tb;
+      std::function<bool()> pred;
+      bool await_ready() {
+        return pred();
+      }
+      void await_suspend(std::coroutine_handle<> handle) {
+        tb->waiting_.push_back({std::move(pred), handle});
+      }
+      void await_resume() {}
+    };
+    return awaiter{this, std::forward<Pred>(pred)};
+  }
+
+  template <typename T, typename U>
+  auto until(const T& port, const U& value) {
+    return this->until([&port, value]() { return static_cast<bool>(port == value); });
+  }
+
+  // run until all tasks complete or the cycle limit is reached,
+  // returns the number of simulated cycles.
+  ch_tick run(ch_tick max_cycles = std::numeric_limits<ch_tick>::max()) {
+    auto start = cycle_;
+    auto end = (max_cycles > std::numeric_limits<ch_tick>::max() - start) ?
+                std::numeric_limits<ch_tick>::max() : (start + max_cycles);
+    for (;;) {
+      this->resume_ready();
+      if ((timed_.empty() && waiting_.empty()) || cycle_ >= end)
+        break;
+      // skip to the next timed wake-up when no task polls a condition
+      auto next = waiting_.empty() ? std::min(timed_.top().cycle, end) : (cycle_ + 1);
+      sim_.step((next - cycle_) * cycle_ticks_);
+      cycle_ = next;
+    }
+    return cycle_ - start;
+  }
+
+  ch_tick cycle() const {
+    return cycle_;
+  }
+
+private:
+
+  struct timed_t {
+    uint64_t cycle;
+    uint64_t seq;
+    std::coroutine_handle<> handle;
+    bool operator>(const timed_t& other) const {
+      return (cycle != other.cycle) ? (cycle > other.cycle) : (seq > other.seq);
+    }
+  };
+
+  struct waiter_t {
+    std::function<bool()> pred;
+    std::coroutine_handle<> handle;
+  };
+
+  void schedule(std::coroutine_handle<> handle, uint64_t cycle) {
+    timed_.push({cycle, seq_++, handle});
+  }
+
+  void resume_ready() {
+    // resumed tasks can wake up others within the same cycle
+    for (;;) {
+      batch_.clear();
+      while (!timed_.empty() && timed_.top().cycle <= cycle_) {
+        batch_.push_back(timed_.top().handle);
+        timed_.pop();
+      }
+      for (auto it = waiting_.begin(); it != waiting_.end();) {
+        if (it->pred()) {
+          batch_.push_back(it->handle);
+          it = waiting_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      if (batch_.empty())
+        break;
+      for (auto handle : batch_) {
+        handle.resume();
+      }
+      this->release_done();
+    }
+  }
+
+  void release_done() {
+    // spawned tasks are destroyed once complete
+    std::exception_ptr exception;
+    for (auto it = tasks_.begin(); it != tasks_.end();) {
+      auto task = *it;
+      if (task.done()) {
+        if (!exception) {
+          exception = task.promise().exception;
+        }
+        task.destroy();
+        it = tasks_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  ch_simulator& sim_;
+  ch_tick cycle_ticks_;
+  uint64_t cycle_;
+  uint64_t seq_;
+  std::priority_queue<timed_t, std::vector<timed_t>, std::greater<timed_t>> timed_;
+  std::vector<waiter_t> waiting_;
+  std::vector<std::coroutine_handle<>> batch_;
+  std::vector<ch_task::handle_type> tasks_;
+};
+
+}
+
+namespace system {
+  using ch::internal::ch_task;
+  using ch::internal::ch_testbench;
+}
+
+}
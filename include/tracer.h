@@ -41,16 +41,24 @@ public:
     toVCD(out);
   }
 
+  void toTrace(std::ofstream& out);
+
+  void toTrace(const std::string& file) {
+    std::ofstream out(file, std::ios::binary);
+    toTrace(out);
+  }
+
+  // stimulus and expected values are stored in
+  // <dataFilePrefix>_stimulus.hex and <dataFilePrefix>_expected.hex,
+  // the prefix defaults to <moduleFileName without extension>_tb
   void toVerilog(std::ofstream& out,
                  const std::string& moduleFileName,
-                 bool passthru = false);
+                 bool passthru = false,
+                 const std::string& dataFilePrefix = "");
 
   void toVerilog(const std::string& file,
                  const std::string& moduleFileName,
-                 bool passthru = false) {
-    std::ofstream out(file);
-    toVerilog(out, moduleFileName, passthru);
-  }
+                 bool passthru = false);
 
   void toVerilator(std::ofstream& out,
                    const std::string& moduleTypeName);
@@ -79,6 +87,14 @@ protected:
   ch_tracer(simulatorimpl* impl);
 };
 
+// compare two trace files signal-by-signal,
+// reporting the ticks where signals start to differ (limit=0 reports all).
+// traces of different lengths report a final '<length>' divergence
+// holding the tick count of each trace.
+std::vector<ch_divergence> ch_traceDiff(const std::string& lhs_file,
+                                        const std::string& rhs_file,
+                                        uint32_t limit = 1);
+
 }
 }
 
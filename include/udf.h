@@ -42,15 +42,34 @@ public:
 class udf_iface: public refcounted {
 public:
 
+  // evaluation entry point invoked by the simulator without virtual dispatch
+  using eval_fn_t = void (*)(udf_iface*);
+
   udf_iface();
 
   virtual ~udf_iface();
 
+  eval_fn_t eval_fn() const {
+    return eval_fn_;
+  }
+
   virtual void eval() = 0;
 
   virtual void reset() = 0;
 
   virtual bool to_verilog(udf_vostream&, udf_verilog) = 0;
+
+  // simulation checkpoint hooks
+  virtual void save(std::ostream&) const {}
+
+  virtual void restore(std::istream&) {}
+
+  // invoked once the ports are bound to the simulator storage
+  virtual void bind() {}
+
+protected:
+
+  eval_fn_t eval_fn_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -62,6 +81,15 @@ template<typename T>
 using detect_to_verilog_t = decltype(std::declval<T&>().to_verilog(
   std::declval<udf_vostream&>(), std::declval<udf_verilog&>()));
 
+template<typename T>
+using detect_save_t = decltype(std::declval<const T&>().save(std::declval<std::ostream&>()));
+
+template<typename T>
+using detect_restore_t = decltype(std::declval<T&>().restore(std::declval<std::istream&>()));
+
+template<typename T>
+using detect_bind_t = decltype(std::declval<T&>().bind());
+
 ///////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
@@ -69,8 +97,9 @@ class udf_wrapper : public udf_iface {
 public:
   template <typename... Args>
   udf_wrapper(Args&&... args) 
-    : udf_(std::forward<Args>(args)...) 
-  {}
+    : udf_(std::forward<Args>(args)...) {
+    this->eval_fn_ = &udf_wrapper::eval_direct;
+  }
 
   void eval() override {
     udf_.eval();
@@ -91,16 +120,172 @@ public:
     }
   }
 
+  void save(std::ostream& out) const override {
+    if constexpr (is_detected_v<detect_save_t, T>) {
+      udf_.save(out);
+    } else {
+      CH_UNUSED(out);
+    }
+  }
+
+  void restore(std::istream& in) override {
+    if constexpr (is_detected_v<detect_restore_t, T>) {
+      udf_.restore(in);
+    } else {
+      CH_UNUSED(in);
+    }
+  }
+
+  void bind() override {
+    if constexpr (is_detected_v<detect_bind_t, T>) {
+      udf_.bind();
+    }
+  }
+
+  auto& io() const {
+    return udf_.io;
+  }
+
+protected:
+
+  static void eval_direct(udf_iface* self) {
+    static_cast<udf_wrapper*>(self)->udf_.eval();
+  }
+
+  T udf_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class udf_async_state;
+
+// sequential udf evaluated asynchronously on worker threads,
+// outputs computed from the inputs sampled at a clock edge
+// are committed a fixed number of clock edges later.
+class udf_async_base : public udf_iface {
+public:
+
+  udf_async_base(uint32_t latency);
+
+  ~udf_async_base() override;
+
+  uint32_t latency() const;
+
+  void eval() override;
+
+  void reset() override;
+
+  void save(std::ostream& out) const override;
+
+  void restore(std::istream& in) override;
+
+  void add_port(bool is_output, const io_value_t& value, const io_value_t& shadow);
+
+protected:
+
+  // wait for pending evaluations
+  void wait() const;
+
+  // invoked on a worker thread
+  virtual void eval_async() = 0;
+
+  virtual void reset_async() = 0;
+
+  virtual void save_async(std::ostream& out) const = 0;
+
+  virtual void restore_async(std::istream& in) = 0;
+
+  udf_async_state* state_;
+
+  friend class udf_async_state;
+};
+
+template <typename T>
+class udf_async_wrapper : public udf_async_base {
+public:
+  template <typename... Args>
+  udf_async_wrapper(uint32_t latency, Args&&... args)
+    : udf_async_base(latency)
+    , udf_(std::forward<Args>(args)...)
+  {}
+
+  ~udf_async_wrapper() override {
+    this->wait();
+  }
+
+  bool to_verilog(udf_vostream& out, udf_verilog mode) override {
+    if constexpr (is_detected_v<detect_to_verilog_t, T>) {
+      return udf_.to_verilog(out, mode);
+    } else {
+      CH_UNUSED(out, mode);
+      return false;
+    }
+  }
+
+  void bind() override {
+    if constexpr (is_detected_v<detect_bind_t, T>) {
+      udf_.bind();
+    }
+  }
+
   auto& io() const {
     return udf_.io;
   }
 
 protected:
+
+  void eval_async() override {
+    udf_.eval();
+  }
+
+  void reset_async() override {
+    if constexpr (is_detected_v<detect_reset_t, T>) {
+      udf_.reset();
+    }
+  }
+
+  void save_async(std::ostream& out) const override {
+    if constexpr (is_detected_v<detect_save_t, T>) {
+      udf_.save(out);
+    } else {
+      CH_UNUSED(out);
+    }
+  }
+
+  void restore_async(std::istream& in) override {
+    if constexpr (is_detected_v<detect_restore_t, T>) {
+      udf_.restore(in);
+    } else {
+      CH_UNUSED(in);
+    }
+  }
+
   T udf_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// direct pointer into the simulator storage of a udf port,
+// valid from bind() onward; wide ports are accessed as arrays of U.
+// writes must keep the bits above the port width cleared.
+template <typename U, typename T>
+auto ch_udf_ptr(T& port) {
+  static_assert(is_system_type_v<T>, "invalid port type");
+  static_assert(std::is_integral_v<U>, "invalid pointer type");
+  static_assert(ch_width_v<T> <= bitwidth_v<U> || sizeof(U) <= sizeof(block_type),
+                "invalid pointer type");
+  auto& data = system_accessor::data(port);
+  assert(data.size() == ch_width_v<T>);
+  auto words = const_cast<block_type*>(data.words());
+  if constexpr (std::is_const_v<T>) {
+    return reinterpret_cast<const U*>(words);
+  } else {
+    return reinterpret_cast<U*>(words);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 template <typename T>
 class ch_udf_comb {
 public:
@@ -207,4 +392,59 @@ protected:
   ch_udf_seq& operator=(ch_udf_seq&& other) = delete;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T, unsigned Latency>
+class ch_udf_async {
+public:
+  static_assert(Latency > 0, "invalid latency");
+  using traits = udf_traits<T, true>;
+  typename traits::io_type io;
+
+  explicit ch_udf_async(CH_SRC_INFO)
+    : io(create(new udf_async_wrapper<T>(Latency), srcinfo)->io(), srcinfo.sloc())
+  {}
+
+#define CH_UDF_GEN_TMPL(a, i, x) typename Arg##i
+#define CH_UDF_GEN_TYPE(a, i, x) Arg##i
+#define CH_UDF_GEN_DECL(a, i, x) Arg##i&& arg##i
+#define CH_UDF_GEN_ARG(a, i, x)  std::forward<Arg##i>(arg##i)
+#define CH_UDF_GEN_SINFO(a, i, x) !std::is_same_v<std::decay_t<Arg##i>, source_info>
+#define CH_UDF_GEN(...) \
+  template <CH_FOR_EACH(CH_UDF_GEN_TMPL, , CH_SEP_COMMA, __VA_ARGS__), \
+            CH_REQUIRES(CH_FOR_EACH(CH_UDF_GEN_SINFO, , CH_SEP_ANDL, __VA_ARGS__) \
+                     && std::is_constructible_v<T, CH_FOR_EACH(CH_UDF_GEN_TYPE, , CH_SEP_COMMA, __VA_ARGS__)>)> \
+  ch_udf_async(CH_FOR_EACH(CH_UDF_GEN_DECL, , CH_SEP_COMMA, __VA_ARGS__), CH_SRC_INFO) \
+    : io(create(new udf_async_wrapper<T>(Latency, CH_FOR_EACH(CH_UDF_GEN_ARG, , CH_SEP_COMMA, __VA_ARGS__)), srcinfo)->io(), srcinfo.sloc()) \
+  {}
+CH_VA_ARGS_MAP(CH_UDF_GEN)
+#undef CH_UDF_GEN_TMPL
+#undef CH_UDF_GEN_TYPE
+#undef CH_UDF_GEN_DECL
+#undef CH_UDF_GEN_ARG
+#undef CH_UDF_GEN_SINFO
+#undef CH_UDF_GEN
+
+  ch_udf_async(ch_udf_async& other)
+    : io(other.io)
+  {}
+
+  ch_udf_async(ch_udf_async&& other)
+    : io(std::move(other.io))
+  {}
+
+protected:
+
+  static auto create(udf_async_wrapper<T>* obj, const source_info& srcinfo) {
+    createUDFNode(obj, true, srcinfo.name(), srcinfo.sloc());
+    return obj;
+  }
+
+  ch_udf_async(const ch_udf_async& other) = delete;
+
+  ch_udf_async& operator=(const ch_udf_async& other) = delete;
+
+  ch_udf_async& operator=(ch_udf_async&& other) = delete;
+};
+
 }}
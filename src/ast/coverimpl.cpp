@@ -0,0 +1,118 @@
+#include "coverimpl.h"
+#include "cdimpl.h"
+#include "context.h"
+
+using namespace ch::internal;
+
+coverimpl::coverimpl(context* ctx,
+                     const std::string& name,
+                     const std::vector<lnode>& values,
+                     const std::vector<std::vector<ch_bin>>& bins,
+                     const source_location& sloc)
+  : ioimpl(ctx, type_cover, 0, name, sloc)
+  , bins_(bins)
+  , pred_idx_(-1) {
+  this->add_src(ctx->current_cd(sloc));
+  auto pred = ctx_->get_predicate(sloc);
+  if (pred) {
+    pred_idx_ = this->add_src(pred);
+  }
+  this->init(values);
+}
+
+coverimpl::coverimpl(context* ctx,
+                     const std::string& name,
+                     lnodeimpl* cd,
+                     lnodeimpl* pred,
+                     const std::vector<lnode>& values,
+                     const std::vector<std::vector<ch_bin>>& bins,
+                     const source_location& sloc)
+  : ioimpl(ctx, type_cover, 0, name, sloc)
+  , bins_(bins)
+  , pred_idx_(-1) {
+  this->add_src(cd);
+  if (pred) {
+    pred_idx_ = this->add_src(pred);
+  }
+  this->init(values);
+}
+
+void coverimpl::init(const std::vector<lnode>& values) {
+  assert(values.size() == bins_.size());
+  values_idx_ = this->num_srcs();
+  for (auto& value : values) {
+    this->add_src(value.impl());
+  }
+}
+
+uint32_t coverimpl::num_counters() const {
+  uint32_t count = 1;
+  for (auto& bins : bins_) {
+    count *= bins.size();
+  }
+  return count;
+}
+
+std::string coverimpl::counter_name(uint32_t index) const {
+  std::string name;
+  for (uint32_t i = bins_.size(); i--;) {
+    auto& bins = bins_[i];
+    auto& bin_name = bins[index % bins.size()].name;
+    name = name.empty() ? bin_name : (bin_name + "," + name);
+    index /= bins.size();
+  }
+  return name;
+}
+
+lnodeimpl* coverimpl::clone(context* ctx, const clone_map& cloned_nodes) const {
+  auto cd = cloned_nodes.at(this->cd().id());
+  lnodeimpl* pred = nullptr;
+  if (this->has_pred()) {
+    pred = cloned_nodes.at(this->pred().id());
+  }
+  std::vector<lnode> values;
+  for (uint32_t i = 0, n = this->num_points(); i < n; ++i) {
+    values.emplace_back(cloned_nodes.at(this->value(i).id()));
+  }
+  return ctx->create_node<coverimpl>(name_, cd, pred, values, bins_, sloc_);
+}
+
+void coverimpl::print(std::ostream& out) const {
+  out << "#" << id_ << " <- " << this->type();
+  out << "(name=\"" << name_ << "\", cd=#" << this->cd().id();
+  if (this->has_pred()) {
+    out << ", pred=#" << this->pred().id();
+  }
+  for (uint32_t i = 0, n = this->num_points(); i < n; ++i) {
+    out << ", #" << this->value(i).id() << "[" << bins_[i].size() << "]";
+  }
+  out << ")";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ch::internal::createCoverNode(const std::string& name,
+                                   const std::vector<lnode>& values,
+                                   const std::vector<std::vector<ch_bin>>& bins,
+                                   const source_location& sloc) {
+  auto points = bins;
+  for (uint32_t i = 0, n = values.size(); i < n; ++i) {
+    auto size = values[i].size();
+    CH_CHECK(size <= 64, "cover point '%s' value is wider than 64 bits", name.c_str());
+    auto& point = points[i];
+    if (point.empty()) {
+      // one bin per value
+      CH_CHECK(size <= 8, "cover point '%s' needs explicit bins", name.c_str());
+      for (uint64_t v = 0, m = (1ull << size); v < m; ++v) {
+        point.emplace_back(std::to_string(v), v);
+      }
+    }
+    for (auto& bin : point) {
+      CH_CHECK(bin.lo <= bin.hi && bin.to_lo <= bin.to_hi,
+               "cover point '%s' has invalid bin '%s'", name.c_str(), bin.name.c_str());
+      CH_CHECK(!bin.is_transition || 1 == n,
+               "cover point '%s' cannot cross transition bins", name.c_str());
+    }
+  }
+  ctx_curr()->create_node<coverimpl>(name, values, points, sloc);
+}
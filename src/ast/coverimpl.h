@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ioimpl.h"
+#include "debug.h"
+
+namespace ch {
+namespace internal {
+
+class coverimpl : public ioimpl {
+public:
+
+  auto& cd() const {
+    return this->src(0);
+  }
+
+  bool has_pred() const {
+    return (pred_idx_ != -1);
+  }
+
+  auto& pred() const {
+    return this->src(pred_idx_);
+  }
+
+  uint32_t num_points() const {
+    return bins_.size();
+  }
+
+  auto& value(uint32_t index) const {
+    return this->src(values_idx_ + index);
+  }
+
+  auto& bins(uint32_t index) const {
+    return bins_[index];
+  }
+
+  // number of hit counters, cross coverage has one counter per bin combination
+  uint32_t num_counters() const;
+
+  std::string counter_name(uint32_t index) const;
+
+  lnodeimpl* clone(context* ctx, const clone_map& cloned_nodes) const override;
+
+  void print(std::ostream& out) const override;
+
+protected:
+
+  coverimpl(context* ctx,
+            const std::string& name,
+            const std::vector<lnode>& values,
+            const std::vector<std::vector<ch_bin>>& bins,
+            const source_location& sloc);
+
+  coverimpl(context* ctx,
+            const std::string& name,
+            lnodeimpl* cd,
+            lnodeimpl* pred,
+            const std::vector<lnode>& values,
+            const std::vector<std::vector<ch_bin>>& bins,
+            const source_location& sloc);
+
+  void init(const std::vector<lnode>& values);
+
+  std::vector<std::vector<ch_bin>> bins_;
+  int pred_idx_;
+  uint32_t values_idx_;
+
+  friend class context;
+};
+
+}
+}
@@ -4,6 +4,7 @@
 #include "proxyimpl.h"
 #include "cdimpl.h"
 #include "context.h"
+#include "mappedfile.h"
 
 using namespace ch::internal;
 
@@ -96,21 +97,60 @@ sdata_type ch::internal::loadInitData(const std::string& file,
   return out;
 }
 
+static bool is_binary_file(const std::string& file) {
+  auto ext = std::string(".bin");
+  return file.size() > ext.size()
+      && 0 == file.compare(file.size() - ext.size(), ext.size(), ext);
+}
+
+static memimpl::init_data_ptr loadBinaryInitData(const std::string& file,
+                                                 uint32_t data_width,
+                                                 uint32_t num_items) {
+  static constexpr uint32_t WORD_SIZE = bitwidth_v<block_type>;
+  auto mapping = std::make_shared<mapped_file>(file);
+  auto size = data_width * num_items;
+  auto num_bytes = ceildiv(size, WORD_SIZE) * sizeof(block_type);
+  if (0 == (size % WORD_SIZE)
+   && mapping->size() >= num_bytes) {
+    // use the mapped file in place
+    auto data = new sdata_type();
+    data->emplace(reinterpret_cast<block_type*>(const_cast<uint8_t*>(mapping->data())), size);
+    return memimpl::init_data_ptr(data, [mapping](const sdata_type* p) {
+      auto data = const_cast<sdata_type*>(p);
+      data->emplace(nullptr, 0);
+      delete data;
+    });
+  }
+  // short or unaligned images are copied and zero padded
+  auto data = std::make_shared<sdata_type>(size);
+  auto length = std::min<size_t>(mapping->size(), ceildiv(size, 8));
+  memcpy(data->words(), mapping->data(), length);
+  bv_clear_extra_bits(data->words(), size);
+  return data;
+}
+
+// memories past 32 bits are paged and have no flat node size
+static uint32_t mem_node_size(uint32_t data_width, uint32_t num_items) {
+  auto size = uint64_t(data_width) * num_items;
+  return (size <= std::numeric_limits<uint32_t>::max()) ? uint32_t(size) : 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 memimpl::memimpl(context* ctx,
                  uint32_t data_width,
                  uint32_t num_items,
-                 const sdata_type& init_data,
+                 const init_data_ptr& init_data,
                  bool force_logic_ram,
                  const std::string& name, 
                  const source_location& sloc)
-  : ioimpl(ctx, type_mem, data_width * num_items, name, sloc)
+  : ioimpl(ctx, type_mem, mem_node_size(data_width, num_items), name, sloc)
   , init_data_(init_data)
   , data_width_(data_width)
   , num_items_(num_items)
-  , force_logic_ram_(force_logic_ram)
-{}
+  , force_logic_ram_(force_logic_ram) {
+  CH_CHECK(init_data->empty() || init_data->size() == this->bit_size(), "invalid memory initialization data size");
+}
 
 lnodeimpl* memimpl::clone(context* ctx, const clone_map&) const {
   return ctx->create_node<memimpl>(data_width_,
@@ -385,12 +425,30 @@ lnodeimpl* mwportimpl::clone(context* ctx, const clone_map& cloned_nodes) const
 
 memory::memory(uint32_t data_width,
                uint32_t num_items,
-               const sdata_type& init_data,
+               sdata_type init_data,
                bool is_logic_rom,
                const std::string& name,
                const source_location& sloc) {
   CH_CHECK(!ctx_curr()->conditional_enabled(), "memory objects disallowed inside conditional blocks");  
-  impl_ = ctx_curr()->create_node<memimpl>(data_width, num_items, init_data, is_logic_rom, name, sloc);
+  auto data = std::make_shared<sdata_type>(std::move(init_data));
+  impl_ = ctx_curr()->create_node<memimpl>(data_width, num_items, data, is_logic_rom, name, sloc);
+}
+
+memory::memory(uint32_t data_width,
+               uint32_t num_items,
+               const std::string& init_file,
+               bool is_logic_rom,
+               const std::string& name,
+               const source_location& sloc) {
+  CH_CHECK(!ctx_curr()->conditional_enabled(), "memory objects disallowed inside conditional blocks");
+  CH_CHECK(uint64_t(data_width) * num_items <= std::numeric_limits<uint32_t>::max(), "memory too large for initialization data");
+  memimpl::init_data_ptr data;
+  if (is_binary_file(init_file)) {
+    data = loadBinaryInitData(init_file, data_width, num_items);
+  } else {
+    data = std::make_shared<sdata_type>(loadInitData(init_file, data_width, num_items));
+  }
+  impl_ = ctx_curr()->create_node<memimpl>(data_width, num_items, data, is_logic_rom, name, sloc);
 }
 
 lnode memory::aread(const lnode& addr, 
@@ -417,3 +475,7 @@ void memory::write(const lnode& addr,
   auto enable_impl = is_literal_one(enable.impl()) ? nullptr : enable.impl();
   impl_->create_wport(cd, addr.impl(), value.impl(), enable_impl, sloc);
 }
+
+void memory::set_name(const std::string& name) {
+  impl_->set_name(name);
+}
@@ -13,6 +13,9 @@ class mwportimpl;
 class memimpl : public ioimpl {
 public:
 
+  // initialization data is shared by clones and may map a file
+  using init_data_ptr = std::shared_ptr<const sdata_type>;
+
   bool is_logic_rom() const;
 
   uint32_t data_width() const {
@@ -23,12 +26,17 @@ public:
     return num_items_;
   }
 
+  // total size in bits, the node size is zero past 32 bits
+  uint64_t bit_size() const {
+    return uint64_t(data_width_) * num_items_;
+  }
+
   bool has_init_data() const {
-    return !init_data_.empty();
+    return !init_data_->empty();
   }
 
   const sdata_type& init_data() const {
-    return init_data_;
+    return *init_data_;
   }
 
   auto& rdports() const {
@@ -94,14 +102,14 @@ protected:
   memimpl(context* ctx,
           uint32_t data_width,
           uint32_t num_items,
-          const sdata_type& init_data,
+          const init_data_ptr& init_data,
           bool force_logic_ram,
           const std::string& name,
           const source_location& sloc);
   
   std::vector<memportimpl*> rdports_;
   std::vector<mwportimpl*> wrports_;
-  sdata_type init_data_;
+  init_data_ptr init_data_;
   uint32_t data_width_;
   uint32_t num_items_;
   bool force_logic_ram_;
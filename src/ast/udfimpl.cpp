@@ -7,7 +7,9 @@
 
 using namespace ch::internal;
 
-udf_iface::udf_iface() {}
+udf_iface::udf_iface()
+  : eval_fn_([](udf_iface* self) { self->eval(); })
+{}
 
 udf_iface::~udf_iface() {}
 
@@ -137,6 +139,21 @@ void ch::internal::createUDFNode(udf_iface* udf,
   ctx_curr()->create_udf_node(udf, is_seq, name, sloc);
 }
 
+static void bindUDFPort(udfimpl* udf,
+                        system_io_buffer* port,
+                        const io_value_t& value,
+                        bool is_output) {
+  auto async = dynamic_cast<udf_async_base*>(udf->udf());
+  if (async) {
+    // asynchronous udfs run on private port storage
+    auto shadow = smart_ptr<sdata_type>::make(port->size());
+    async->add_port(is_output, value, shadow);
+    port->bind(shadow);
+  } else {
+    port->bind(value);
+  }
+}
+
 lnodeimpl* ch::internal::bindInputNode(system_io_buffer* input, 
                                        const source_location& sloc) {
   auto ctx  = ctx_curr();
@@ -144,7 +161,7 @@ lnodeimpl* ch::internal::bindInputNode(system_io_buffer* input,
   auto value = smart_ptr<sdata_type>::make(input->size());
   auto src  = ctx->create_node<proxyimpl>(input->size(), input->name(), sloc);
   auto node = ctx->create_node<udfportimpl>(input->size(), src, udf, value, input->name(), sloc);
-  input->bind(node->value());  
+  bindUDFPort(udf, input, node->value(), false);
   return src;
 }
 
@@ -154,6 +171,6 @@ lnodeimpl* ch::internal::bindOutputNode(system_io_buffer* output,
   auto udf  = ctx->current_udf();
   auto value = smart_ptr<sdata_type>::make(output->size());
   auto node = ctx->create_node<udfportimpl>(output->size(), udf, value, output->name(), sloc);
-  output->bind(node->value());
+  bindUDFPort(udf, output, node->value(), true);
   return node;
 }
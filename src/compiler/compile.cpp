@@ -146,6 +146,7 @@ void compiler::optimize() {
 
   CH_DBG(2, "compiling %s (#%d) ...\n", ctx_->name().c_str(), ctx_->id());
 
+  stopwatch timer;
   node_tracker tracker(ctx_);
   auto orig_num_nodes = tracker.current();
 
@@ -200,6 +201,16 @@ void compiler::optimize() {
   CH_DBG(2, "*** deleted %lu RPO nodes\n", rpo_total);
   CH_DBG(2, "Before optimization: %lu\n", orig_num_nodes);
   CH_DBG(2, "After optimization: %lu\n", tracker.current());
+
+  auto& stats = ctx_->build_stats();
+  stats.optimize_time += timer.elapsed();
+  stats.add_pass("dce", dce_total);
+  stats.add_pass("pip", pip_total);
+  stats.add_pass("pcx", pcx_total);
+  stats.add_pass("cfo", cfo_total);
+  stats.add_pass("cse", cse_total);
+  stats.add_pass("bro", bro_total);
+  stats.add_pass("rpo", rpo_total);
 }
 
 bool compiler::dead_code_elimination() {
@@ -1649,7 +1660,13 @@ void compiler::create_merged_context(context* ctx, bool verbose_tracing) {
           update_map(output->id(), eval_node);
         }
       } break;
-      case type_mem:
+      case type_mem: {
+        auto eval_node = node->clone(ctx_, map);
+        if (!node->name().empty()) {
+          eval_node->set_name(full_name(eval_node));
+        }
+        update_map(node->id(), eval_node);
+      } break;
       case type_udfc:
       case type_udfs: {
         auto eval_node = node->clone(ctx_, map);
@@ -1662,6 +1679,14 @@ void compiler::create_merged_context(context* ctx, bool verbose_tracing) {
         eval_node->set_name(full_name(eval_node));
         update_map(tap->id(), eval_node);
       } break;
+      case type_cover: {
+        for (uint32_t i = 0; i < node->num_srcs(); ++i) {
+          ensure_placeholder(node, i);
+        }
+        auto eval_node = node->clone(ctx_, map);
+        eval_node->set_name(full_name(eval_node));
+        update_map(node->id(), eval_node);
+      } break;
       case type_bypass: {
         auto bypass = reinterpret_cast<bypassimpl*>(node);
         auto eval_node = bypass_nodes.at(bypass->target()->id());
@@ -1945,6 +1970,7 @@ bool compiler::build_bypass_list(std::unordered_set<uint32_t>& out, context* ctx
       case type_time:
       case type_assert:
       case type_print:
+      case type_cover:
         break;
       default:
         has_data_nodes = true;
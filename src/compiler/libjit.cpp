@@ -428,3 +428,9 @@ int jit_dump_asm(FILE *stream, jit_function_t func, const char *name) {
   jit_dump_function(stream, func, name);
   return 1;
 }
+
+jit_nuint jit_function_get_code_size(jit_function_t func) {
+  // libjit doesn't expose the code buffer bounds
+  CH_UNUSED(func);
+  return 0;
+}
@@ -45,3 +45,6 @@ void jit_insn_set_marker(jit_function_t func, const char* name);
 
 int jit_dump_ast(FILE *stream, jit_function_t func, const char *name);
 int jit_dump_asm(FILE *stream, jit_function_t func, const char *name);
+
+// bytes of machine code generated for the compiled function, 0 if unavailable
+jit_nuint jit_function_get_code_size(jit_function_t func);
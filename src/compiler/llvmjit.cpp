@@ -5,6 +5,8 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 #include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/Object/ObjectFile.h>
 
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Verifier.h>
@@ -197,6 +199,29 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// sums the text sections of the objects emitted by the engine
+class code_size_listener : public llvm::JITEventListener {
+public:
+
+  void notifyObjectLoaded(ObjectKey key,
+                          const llvm::object::ObjectFile& obj,
+                          const llvm::RuntimeDyld::LoadedObjectInfo& info) override {
+    CH_UNUSED(key, info);
+    for (auto& section : obj.sections()) {
+      if (section.isText()) {
+        size_ += section.getSize();
+      }
+    }
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+private:
+  uint64_t size_ = 0;
+};
+
 class _jit_context {
 public:
 
@@ -229,6 +254,7 @@ public:
 
     module_->setDataLayout(engine_->getDataLayout());
     target_ = engine_->getTargetMachine();
+    engine_->RegisterJITEventListener(&code_size_);
     
     return true;
   }
@@ -291,6 +317,10 @@ public:
     return (void*)engine_->getFunctionAddress(name);
   }
 
+  uint64_t code_size() const {
+    return code_size_.size();
+  }
+
   _jit_function* create_function(jit_type_t signature,
                                  const char* name,
                                  void* address = nullptr);
@@ -302,6 +332,7 @@ private:
   llvm::Module* module_;
   llvm::ExecutionEngine* engine_;
   llvm::TargetMachine* target_;
+  code_size_listener code_size_;
   std::unordered_map<std::string, std::unique_ptr<_jit_function>> functions_;
 };
 
@@ -520,6 +551,12 @@ void *jit_function_to_closure(jit_function_t func) {
   return ctx->closure("eval");
 }
 
+jit_nuint jit_function_get_code_size(jit_function_t func) {
+  // the code is emitted when the closure is resolved
+  auto ctx = func->ctx();
+  return ctx->code_size();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 jit_type_t jit_type_create_signature(jit_abi_t abi,
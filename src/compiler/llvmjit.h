@@ -200,3 +200,6 @@ jit_value_t jit_insn_convert(jit_function_t func, jit_value_t value, jit_type_t
 
 int jit_dump_ast(FILE *stream, jit_function_t func, const char *name);
 int jit_dump_asm(FILE *stream, jit_function_t func, const char *name);
+
+// bytes of machine code generated for the compiled function, 0 if unavailable
+jit_nuint jit_function_get_code_size(jit_function_t func);
@@ -11,15 +11,19 @@
 #include "opimpl.h"
 #include "assertimpl.h"
 #include "printimpl.h"
+#include "coverimpl.h"
 #include "timeimpl.h"
 #include "udfimpl.h"
 #include "udf.h"
+#include "simulator.h"
 #if defined(LLVMJIT)
   #include "llvmjit.h"
 #elif defined(LIBJIT)
   #include "libjit.h"
 #endif
 #include "compile.h"
+#include "printlogger.h"
+#include "mempages.h"
 
 namespace ch::internal::simjit {
 
@@ -27,6 +31,7 @@ using alloc_map_t  = std::unordered_map<uint32_t, uint32_t>;
 using var_map_t    = std::unordered_map<uint32_t, jit_value_t>;
 using label_map_t  = std::unordered_map<uint32_t, jit_label_t>;
 using bypass_set_t = std::unordered_set<uint32_t>;
+using guard_map_t  = std::unordered_map<uint32_t, cdimpl*>;
 
 static constexpr uint32_t WORD_SIZE = bitwidth_v<block_type>;
 static constexpr uint32_t WORD_MASK = WORD_SIZE - 1;
@@ -233,6 +238,8 @@ class Compiler;
 
 void init_sdata(const Compiler* cp, sdata_type* data, lnodeimpl* node);
 
+void add_reloc(const Compiler* cp, void* field);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SrcMarker {
@@ -262,10 +269,6 @@ struct udf_data_t {
   }
 };
 
-extern "C" void udf_data_eval(udf_data_t* self) {
-  self->udf->eval();
-}
-
 extern "C" void udf_data_reset(udf_data_t* self) {
   self->udf->reset();
 }
@@ -278,6 +281,8 @@ struct print_data_t {
   char* format;
   enum_string_cb* enum_strings;
   sdata_type* srcs;
+  print_logger* logger;
+  uint32_t format_id;
 
   static uint32_t size(printimpl* node) {
     auto num_srcs = node->num_srcs() + (node->has_pred() ? -1 : 0);
@@ -288,9 +293,12 @@ struct print_data_t {
     return size;
   }
 
-  void init(printimpl* node, const Compiler* cp) {
+  void init(printimpl* node, const Compiler* cp, print_logger* logger) {
     auto buf = reinterpret_cast<uint8_t*>(this) + sizeof(print_data_t);
 
+    this->logger = logger;
+    format_id = logger ? logger->add_format(node) : 0;
+
     auto fmt_len = node->format().size() + 1;
     format = reinterpret_cast<char*>(buf);
     memcpy(format, node->format().c_str(), fmt_len);
@@ -307,10 +315,19 @@ struct print_data_t {
     for (uint32_t i = 0, n = node->num_srcs() - pred; i < n; ++i) {
       init_sdata(cp, &srcs[i], node->src(i + pred).impl());
     }
+
+    add_reloc(cp, &this->format);
+    add_reloc(cp, &this->enum_strings);
+    add_reloc(cp, &this->srcs);
+    add_reloc(cp, &this->logger);
   }
 };
 
 extern "C" void print_data_eval(print_data_t* self) {
+  if (self->logger) {
+    self->logger->log(self->format_id, self->srcs);
+    return;
+  }
   auto str = to_string(self->format, self->srcs, self->enum_strings);
   std::cout << str;
 }
@@ -324,6 +341,7 @@ struct assert_data_t {
   int line;
   int column;
   sdata_type time;
+  print_logger* logger;
 
   static uint32_t size(assertimpl* node) {
     uint32_t size = sizeof(assert_data_t);
@@ -333,8 +351,10 @@ struct assert_data_t {
     return size;
   }
 
-  void init(assertimpl* node, const Compiler* cp) {
-    auto buf = reinterpret_cast<uint8_t*>(this) + sizeof(print_data_t);
+  void init(assertimpl* node, const Compiler* cp, print_logger* logger) {
+    auto buf = reinterpret_cast<uint8_t*>(this) + sizeof(assert_data_t);
+
+    this->logger = logger;
 
     auto msg_len = node->message().size() + 1;
     message = reinterpret_cast<char*>(buf);
@@ -356,10 +376,18 @@ struct assert_data_t {
     column = node->sloc().column();
 
     init_sdata(cp, &time, node->time().impl());
+
+    add_reloc(cp, &this->message);
+    add_reloc(cp, &this->name);
+    add_reloc(cp, &this->file);
+    add_reloc(cp, &this->logger);
   }
 };
 
 extern "C" void assert_data_eval(assert_data_t* self) {
+  if (self->logger) {
+    self->logger->flush();
+  }
   throw std::domain_error(sstreamf() << "assertion failure at tick " 
                                      << static_cast<uint64_t>(self->time) << ", " 
                                      << self->message << "('" 
@@ -398,16 +426,28 @@ struct sim_state_t {
 typedef int (*pfn_entry)(sim_state_t*);
 
 struct sim_ctx_t {
-  sim_ctx_t()
+  sim_ctx_t(bool owns_code = true)
   #ifdef JIT_BACKEND_INTERP
-    : j_func(nullptr) {
+    : j_func(nullptr)
   #else
-    : entry(nullptr) {
+    : entry(nullptr)
   #endif
-    j_ctx = jit_context_create();
+    , j_ctx(nullptr)
+    , logger(nullptr)
+    , vars_size(0)
+    , ports_size(0)
+    , refresh_addr(-1)
+    , code_size(0) {
+    if (owns_code) {
+      j_ctx = jit_context_create();
+    }
   }
 
   ~sim_ctx_t() {
+    delete logger;
+    for (auto addr : page_addrs) {
+      delete *reinterpret_cast<mem_pages**>(state.vars + addr);
+    }
     if (j_ctx) {
       jit_context_destroy(j_ctx);
     }
@@ -419,7 +459,144 @@ struct sim_ctx_t {
 #else
   pfn_entry entry;
 #endif
-  jit_context_t j_ctx;  
+  jit_context_t j_ctx;
+  print_logger* logger;
+  uint32_t vars_size;
+  uint32_t ports_size;
+  int32_t refresh_addr;
+  uint64_t code_size;
+  std::unordered_map<uint32_t, uint32_t> cover_addrs;
+  std::unordered_map<uint32_t, uint32_t> mem_addrs;
+  std::vector<std::pair<uint32_t, uint32_t>> state_regions;
+  // offsets of native pointers and sdata views stored in vars
+  std::vector<uint32_t> ptr_relocs;
+  std::vector<uint32_t> sdata_relocs;
+  // offsets of paged memory tables stored in vars
+  std::vector<uint32_t> page_addrs;
+};
+
+typedef int (*pfn_watch)(watch_driver::watch_t*);
+
+// value watches are compiled into a companion function evaluated
+// after the design, it returns non-zero only when a watch fired.
+struct watch_ctx_t {
+  watch_ctx_t()
+  #ifdef JIT_BACKEND_INTERP
+    : j_func(nullptr)
+  #else
+    : entry(nullptr)
+  #endif
+    , watches(nullptr) {
+    j_ctx = jit_context_create();
+  }
+
+  ~watch_ctx_t() {
+    jit_context_destroy(j_ctx);
+  }
+
+  void build(watch_driver::watch_t* watches, uint32_t count) {
+    using watch_t = watch_driver::watch_t;
+    jit_context_build_start(j_ctx);
+
+    jit_type_t params[1] = {jit_type_ptr};
+    auto j_sig = jit_type_create_signature(jit_abi_cdecl, jit_type_int32, params, 1, 1);
+    auto j_func = jit_function_create(j_ctx, j_sig);
+    jit_type_free(j_sig);
+    auto j_watches = jit_value_get_param(j_func, 0);
+    auto j_word_type = to_value_type(WORD_SIZE);
+    auto j_zero = jit_value_create_int_constant(j_func, 0, j_word_type);
+    auto j_any = jit_value_create_int_constant(j_func, 0, jit_type_int32);
+
+    for (uint32_t i = 0; i < count; ++i) {
+      auto& watch = watches[i];
+      auto base = i * sizeof(watch_t);
+      auto j_value = jit_insn_load_relative(j_func, j_watches, base + offsetof(watch_t, value), jit_type_ptr);
+      auto j_prev = jit_insn_load_relative(j_func, j_watches, base + offsetof(watch_t, prev), jit_type_ptr);
+      jit_value_t j_ref = nullptr;
+      if (ch_watch::equals == watch.kind) {
+        j_ref = jit_insn_load_relative(j_func, j_watches, base + offsetof(watch_t, ref), jit_type_ptr);
+      }
+
+      // accumulate the differences word by word
+      jit_value_t j_diff = nullptr;
+      jit_value_t j_prev_diff = nullptr;
+      auto num_words = ceildiv<uint32_t>(watch.size, WORD_SIZE);
+      auto rem = watch.size % WORD_SIZE;
+      for (uint32_t w = 0; w < num_words; ++w) {
+        auto offset = w * sizeof(block_type);
+        auto j_curr = jit_insn_load_relative(j_func, j_value, offset, j_word_type);
+        if (rem && w + 1 == num_words) {
+          auto j_mask = jit_value_create_int_constant(j_func, (block_type(1) << rem) - 1, j_word_type);
+          j_curr = jit_insn_and(j_func, j_curr, j_mask);
+        }
+        auto j_old = jit_insn_load_relative(j_func, j_prev, offset, j_word_type);
+        jit_value_t j_tmp = nullptr;
+        switch (watch.kind) {
+        case ch_watch::equals: {
+          auto j_word = jit_insn_load_relative(j_func, j_ref, offset, j_word_type);
+          auto j_tmp2 = jit_insn_xor(j_func, j_old, j_word);
+          j_prev_diff = j_prev_diff ? jit_insn_or(j_func, j_prev_diff, j_tmp2) : j_tmp2;
+          j_tmp = jit_insn_xor(j_func, j_curr, j_word);
+        } break;
+        case ch_watch::changes:
+          j_tmp = jit_insn_xor(j_func, j_curr, j_old);
+          break;
+        case ch_watch::rising:
+          j_tmp = jit_insn_and(j_func, j_curr, jit_insn_not(j_func, j_old));
+          break;
+        }
+        j_diff = j_diff ? jit_insn_or(j_func, j_diff, j_tmp) : j_tmp;
+        jit_insn_store_relative(j_func, j_prev, offset, j_curr);
+      }
+
+      jit_value_t j_fired;
+      if (ch_watch::equals == watch.kind) {
+        j_fired = jit_insn_and(j_func, jit_insn_eq(j_func, j_diff, j_zero),
+                                       jit_insn_ne(j_func, j_prev_diff, j_zero));
+      } else {
+        j_fired = jit_insn_ne(j_func, j_diff, j_zero);
+      }
+      j_fired = jit_insn_convert(j_func, j_fired, jit_type_int32, 0);
+      jit_insn_store_relative(j_func, j_watches, base + offsetof(watch_t, fired), j_fired);
+      j_any = jit_insn_or(j_func, j_any, j_fired);
+    }
+
+    jit_insn_return(j_func, j_any);
+
+    if (!jit_function_compile(j_func))
+      exit(1);
+
+    jit_context_build_end(j_ctx);
+
+  #ifdef JIT_BACKEND_INTERP
+    this->j_func = j_func;
+  #else
+    entry = reinterpret_cast<pfn_watch>(jit_function_to_closure(j_func));
+  #endif
+    this->watches = watches;
+  }
+
+  bool eval() {
+    int ret;
+  #ifdef JIT_BACKEND_INTERP
+    void* arg = watches;
+    void* args[1] = {&arg};
+    jit_int j_ret;
+    jit_function_apply(j_func, args, &j_ret);
+    ret = static_cast<int>(j_ret);
+  #else
+    ret = entry(watches);
+  #endif
+    return (ret != 0);
+  }
+
+  jit_context_t j_ctx;
+#ifdef JIT_BACKEND_INTERP
+  jit_function_t j_func;
+#else
+  pfn_watch entry;
+#endif
+  watch_driver::watch_t* watches;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -479,6 +656,13 @@ private:
   jit_label_t     l_bypass_;
   bypass_set_t    bypass_nodes_;
   bool            bypass_enable_;
+  var_map_t       bypass_edges_;
+  guard_map_t     guard_map_;
+  alloc_map_t     spill_map_;
+  cdimpl*         guard_cd_;
+  jit_label_t     l_guard_;
+  jit_value_t     j_refresh_;
+  std::vector<lnodeimpl*> guard_nodes_;
   sblock_t        sblock_;
   jit_type_t      word_type_;
   jit_function_t  j_func_;
@@ -494,6 +678,8 @@ private:
 
   friend void init_sdata(const Compiler* Cp, sdata_type* data, lnodeimpl* node);
 
+  friend void add_reloc(const Compiler* Cp, void* field);
+
   friend class SrcMarker;
 
   void* create_meta_allocation(size_t size) {
@@ -1558,12 +1744,159 @@ private:
       jit_insn_branch_if_not(j_func_, j_changed, &l_skip);
       l_bypass_ = l_skip;
       bypass_enable_ = true;
+      // cover nodes past the bypass region still sample on the edge
+      bypass_edges_[node->id()] = j_changed;
     } else {
       scalar_map_[node->id()] = j_changed;
       bypass_enable_ = false;
     }
   }
 
+  void build_guards(context* ctx, const std::vector<lnodeimpl*>& eval_list) {
+    // combinational nodes that only depend on the registers of a single clock domain
+    // and are evaluated after its last update only change on that domain's edges,
+    // they are grouped into regions skipped when the edge didn't fire.
+    if (ctx->cdomains().size() < 2
+     || 0 != (platform::self().cflags() & ch_flags::disable_cpb))
+      return;
+
+    std::unordered_map<cdimpl*, uint32_t> last_update;
+    for (uint32_t i = 0, n = eval_list.size(); i < n; ++i) {
+      auto node = eval_list[i];
+      if (is_snode_type(node->type())) {
+        last_update[get_snode_cd(node)] = i;
+      }
+    }
+
+    for (uint32_t i = 0, n = eval_list.size(); i < n; ++i) {
+      auto node = eval_list[i];
+      switch (node->type()) {
+      case type_op:
+      case type_sel:
+      case type_proxy:
+        break;
+      default:
+        continue;
+      }
+      cdimpl* cd = nullptr;
+      bool valid = true;
+      for (auto& src : node->srcs()) {
+        auto src_impl = src.impl();
+        cdimpl* src_cd = nullptr;
+        switch (src_impl->type()) {
+        case type_lit:
+          continue;
+        case type_reg:
+        case type_msrport:
+          src_cd = get_snode_cd(src_impl);
+          break;
+        default: {
+          auto it = guard_map_.find(src.id());
+          if (it != guard_map_.end()) {
+            src_cd = it->second;
+          }
+        } break;
+        }
+        if (nullptr == src_cd || (cd && cd != src_cd)) {
+          valid = false;
+          break;
+        }
+        cd = src_cd;
+      }
+      if (valid && cd && i > last_update.at(cd)) {
+        guard_map_[node->id()] = cd;
+      }
+    }
+
+    if (guard_map_.empty())
+      return;
+
+    // scalar values used outside of their region are spilled to memory
+    std::unordered_map<uint32_t, uint32_t> regions;
+    uint32_t region = 0;
+    cdimpl* curr_cd = nullptr;
+    for (auto node : eval_list) {
+      if (type_lit == node->type())
+        continue;
+      auto it = guard_map_.find(node->id());
+      auto cd = (it != guard_map_.end()) ? it->second : nullptr;
+      if (cd != curr_cd) {
+        curr_cd = cd;
+        ++region;
+      }
+      if (cd) {
+        regions[node->id()] = region;
+      }
+    }
+    for (auto node : eval_list) {
+      auto it = regions.find(node->id());
+      auto node_region = (it != regions.end()) ? it->second : 0;
+      for (auto& src : node->srcs()) {
+        auto it_src = regions.find(src.id());
+        if (it_src == regions.end()
+         || it_src->second == node_region
+         || src.size() > WORD_SIZE)
+          continue;
+        spill_map_[src.id()] = 0;
+      }
+    }
+  }
+
+  void resolve_guard(lnodeimpl* node) {
+    if (guard_map_.empty()
+     || (node && type_lit == node->type()))
+      return;
+
+    cdimpl* cd = nullptr;
+    if (node) {
+      auto it = guard_map_.find(node->id());
+      if (it != guard_map_.end()) {
+        cd = it->second;
+      }
+    }
+
+    if (cd == guard_cd_) {
+      if (cd) {
+        guard_nodes_.push_back(node);
+      }
+      return;
+    }
+
+    if (guard_cd_) {
+      // spill values used outside of the region
+      for (auto guard_node : guard_nodes_) {
+        auto it = spill_map_.find(guard_node->id());
+        if (it == spill_map_.end())
+          continue;
+        auto j_xtype = to_native_or_word_type(guard_node->size());
+        auto j_value = this->emit_cast(scalar_map_.at(guard_node->id()), j_xtype);
+        jit_insn_store_relative(j_func_, j_vars_, it->second, j_value);
+      }
+      jit_insn_label(j_func_, &l_guard_);
+      for (auto guard_node : guard_nodes_) {
+        auto it = spill_map_.find(guard_node->id());
+        if (it == spill_map_.end())
+          continue;
+        auto j_ntype = to_native_type(guard_node->size());
+        auto j_xtype = to_native_or_word_type(guard_node->size());
+        auto j_value = jit_insn_load_relative(j_func_, j_vars_, it->second, j_xtype);
+        scalar_map_[guard_node->id()] = this->emit_cast(j_value, j_ntype);
+      }
+      guard_nodes_.clear();
+      l_guard_ = jit_label_undefined;
+    }
+
+    guard_cd_ = cd;
+
+    if (cd) {
+      jit_label_t l_enter(jit_label_undefined);
+      jit_insn_branch_if(j_func_, j_refresh_, &l_enter);
+      jit_insn_branch_if_not(j_func_, scalar_map_.at(cd->id()), &l_guard_);
+      jit_insn_label(j_func_, &l_enter);
+      guard_nodes_.push_back(node);
+    }
+  }
+
   void resolve_branch(lnodeimpl* node) {
     if (sblock_.cd
      && ((0 != (platform::self().cflags() & ch_flags::disable_snc)
@@ -1933,6 +2266,9 @@ private:
   #endif
     auto j_array_ptr = this->emit_pointer_address(node->mem());
     auto array_width = node->mem()->size();
+    if (mem_pages::is_paged(node->mem())) {
+      array_width = this->emit_page_address(node->mem(), false, &j_array_ptr, &j_src_addr);
+    }
 
     if (is_scalar) {
       auto j_src = this->emit_load_array_scalar(j_array_ptr, array_width, j_src_addr, dst_width);
@@ -1961,6 +2297,9 @@ private:
   #endif
     auto j_array_ptr = this->emit_pointer_address(node->mem());
     auto array_width = node->mem()->size();
+    if (mem_pages::is_paged(node->mem())) {
+      array_width = this->emit_page_address(node->mem(), false, &j_array_ptr, &j_src_addr);
+    }
 
     if (is_scalar) {
       auto dst_addr = addr_map_.at(node->id());
@@ -1996,6 +2335,9 @@ private:
   #endif
     auto j_array_ptr = this->emit_pointer_address(node->mem());
     auto array_width = node->mem()->size();
+    if (mem_pages::is_paged(node->mem())) {
+      array_width = this->emit_page_address(node->mem(), true, &j_array_ptr, &j_dst_addr);
+    }
 
     if (is_scalar) {
       auto j_wdata = scalar_map_.at(node->wdata().id());
@@ -2006,6 +2348,59 @@ private:
     }
   }
 
+  uint32_t emit_page_address(memimpl* mem,
+                             bool is_write,
+                             jit_value_t* j_array_ptr,
+                             jit_value_t* j_index) {
+    __source_marker();
+
+    // resolve the page from the table's last accessed entry,
+    // falling back to a lookup call on a miss.
+    auto shift = mem_pages::page_shift(mem->data_width());
+    auto tag_offset = is_write ? mem_pages::write_tag_offset() : mem_pages::read_tag_offset();
+    auto ptr_offset = is_write ? mem_pages::write_ptr_offset() : mem_pages::read_ptr_offset();
+
+    auto j_pages = jit_insn_load_relative(j_func_, *j_array_ptr, 0, jit_type_ptr);
+    auto j_addr = this->emit_cast(*j_index, jit_type_int32);
+    auto j_shift = this->emit_constant(shift, jit_type_int32);
+    auto j_mask = this->emit_constant((1u << shift) - 1, jit_type_int32);
+    auto j_page = jit_insn_ushr(j_func_, j_addr, j_shift);
+    auto j_tag = jit_insn_load_relative(j_func_, j_pages, tag_offset, jit_type_int32);
+
+    jit_label_t l_miss(jit_label_undefined);
+    jit_label_t l_exit(jit_label_undefined);
+    auto j_page_ptr = jit_value_create(j_func_, jit_type_ptr);
+    auto j_hit = jit_insn_eq(j_func_, j_tag, j_page);
+    jit_insn_branch_if_not(j_func_, j_hit, &l_miss);
+    auto j_cached = jit_insn_load_relative(j_func_, j_pages, ptr_offset, jit_type_ptr);
+    jit_insn_store(j_func_, j_page_ptr, j_cached);
+    jit_insn_branch(j_func_, &l_exit);
+    jit_insn_label(j_func_, &l_miss);
+    {
+      jit_type_t params[] = {jit_type_ptr, jit_type_int32};
+      auto j_sig = jit_type_create_signature(jit_abi_cdecl,
+                                             jit_type_ptr,
+                                             params,
+                                             CH_COUNTOF(params),
+                                             1);
+      jit_value_t args[] = {j_pages, j_page};
+      auto ret = jit_insn_call_native(j_func_,
+                                      is_write ? "mem_pages_write" : "mem_pages_read",
+                                      is_write ? (void*)mem_pages_write : (void*)mem_pages_read,
+                                      j_sig,
+                                      args,
+                                      CH_COUNTOF(args),
+                                      JIT_CALL_NOTHROW);
+      jit_type_free(j_sig);
+      jit_insn_store(j_func_, j_page_ptr, ret);
+    }
+    jit_insn_label(j_func_, &l_exit);
+
+    *j_array_ptr = j_page_ptr;
+    *j_index = jit_insn_and(j_func_, j_addr, j_mask);
+    return (1u << shift) * mem->data_width();
+  }
+
   void emit_node(timeimpl* node) {
     __source_marker();
 
@@ -2129,23 +2524,134 @@ private:
     }
   }
 
-  void emit_node(udfimpl* node) {
+  void emit_node(coverimpl* node) {
     __source_marker();
 
+    jit_label_t l_exit(jit_label_undefined);
+
+    auto it_cd = bypass_edges_.find(node->cd().id());
+    auto j_cd = (it_cd != bypass_edges_.end()) ? it_cd->second : scalar_map_.at(node->cd().id());
+    jit_insn_branch_if_not(j_func_, j_cd, &l_exit);
+    if (node->has_pred()) {
+      auto j_pred = scalar_map_.at(node->pred().id());
+      jit_insn_branch_if_not(j_func_, j_pred, &l_exit);
+    }
+
     auto addr = addr_map_.at(node->id());
-    auto j_data_ptr = jit_insn_add_relative(j_func_, j_vars_, addr);
+    auto num_counters = node->num_counters();
+    auto has_prev_addr = addr + num_counters * sizeof(uint64_t);
+    auto prev_addr = has_prev_addr + sizeof(uint64_t);
+    auto j_zero = this->emit_constant(0, jit_type_int64);
+    auto j_one = this->emit_constant(1, jit_type_int64);
+
+    // evaluate bin matches, null for bins out of the value range
+    jit_value_t j_has_prev = nullptr;
+    std::vector<std::vector<jit_value_t>> matches(node->num_points());
+    for (uint32_t i = 0, n = node->num_points(); i < n; ++i) {
+      auto& value = node->value(i);
+      auto it = scalar_map_.find(value.id());
+      jit_value_t j_value;
+      if (it != scalar_map_.end()) {
+        j_value = it->second;
+      } else {
+        // load the value's native width only and zero-extend it
+        auto j_load = this->emit_load_scalar_relative(value.impl(), 0, to_native_type(value.size()));
+        j_value = this->emit_cast(j_load, jit_type_int64);
+      }
+      auto j_type = jit_value_get_type(j_value);
+      uint64_t max = (value.size() < 64) ? ((1ull << value.size()) - 1) : ~0ull;
+
+      auto emit_range = [&](jit_value_t j_src, uint64_t lo, uint64_t hi)->jit_value_t {
+        if (lo > max)
+          return nullptr;
+        hi = std::min(hi, max);
+        if (lo == hi)
+          return jit_insn_eq(j_func_, j_src, this->emit_constant(lo, j_type));
+        auto j_hi = jit_insn_ule(j_func_, j_src, this->emit_constant(hi, j_type));
+        if (0 == lo)
+          return j_hi;
+        auto j_lo = jit_insn_uge(j_func_, j_src, this->emit_constant(lo, j_type));
+        return jit_insn_and(j_func_, j_lo, j_hi);
+      };
 
-    // call native function
+      for (auto& bin : node->bins(i)) {
+        if (bin.is_transition) {
+          if (nullptr == j_has_prev) {
+            auto j_flag = jit_insn_load_relative(j_func_, j_vars_, has_prev_addr, jit_type_int64);
+            j_has_prev = jit_insn_ne(j_func_, j_flag, j_zero);
+          }
+          auto j_prev = jit_insn_load_relative(j_func_, j_vars_, prev_addr + i * sizeof(uint64_t), j_type);
+          auto j_from = emit_range(j_prev, bin.lo, bin.hi);
+          auto j_to = emit_range(j_value, bin.to_lo, bin.to_hi);
+          if (j_from && j_to) {
+            auto j_match = jit_insn_and(j_func_, j_from, j_to);
+            matches[i].push_back(jit_insn_and(j_func_, j_match, j_has_prev));
+          } else {
+            matches[i].push_back(nullptr);
+          }
+        } else {
+          matches[i].push_back(emit_range(j_value, bin.lo, bin.hi));
+        }
+      }
+
+      if (j_has_prev) {
+        jit_insn_store_relative(j_func_, j_vars_, prev_addr + i * sizeof(uint64_t), j_value);
+      }
+    }
+
+    // increment counters
+    for (uint32_t c = 0; c < num_counters; ++c) {
+      jit_value_t j_match = nullptr;
+      bool valid = true;
+      for (uint32_t i = node->num_points(), index = c; valid && i--;) {
+        auto num_bins = node->bins(i).size();
+        auto j_bin = matches[i][index % num_bins];
+        index /= num_bins;
+        if (nullptr == j_bin) {
+          valid = false;
+        } else {
+          j_match = j_match ? jit_insn_and(j_func_, j_match, j_bin) : j_bin;
+        }
+      }
+      if (!valid)
+        continue;
+      auto counter_addr = addr + c * sizeof(uint64_t);
+      auto j_counter = jit_insn_load_relative(j_func_, j_vars_, counter_addr, jit_type_int64);
+      auto j_incr = jit_insn_select(j_func_, j_match, j_one, j_zero);
+      auto j_counter_n = jit_insn_add(j_func_, j_counter, j_incr);
+      jit_insn_store_relative(j_func_, j_vars_, counter_addr, j_counter_n);
+    }
+
+    if (j_has_prev) {
+      jit_insn_store_relative(j_func_, j_vars_, has_prev_addr, j_one);
+    }
+
+    jit_insn_label(j_func_, &l_exit);
+  }
+
+  void emit_node(udfimpl* node) {
+    __source_marker();
+
+    auto addr = addr_map_.at(node->id());
+    auto j_udf = jit_insn_load_relative(j_func_,
+                                        j_vars_,
+                                        addr + offsetof(udf_data_t, udf),
+                                        jit_type_ptr);
+
+    // call the udf's evaluation entry point directly,
+    // native functions are bound by name, so the name is unique per entry point.
+    auto eval_fn = node->udf()->eval_fn();
+    auto fn_name = stringf("udf_eval_%p", (void*)eval_fn);
     jit_type_t params[] = {jit_type_ptr};
     auto j_sig = jit_type_create_signature(jit_abi_cdecl,
                                            jit_type_void,
                                            params,
                                            CH_COUNTOF(params),
                                            1);
-    jit_value_t args[] = {j_data_ptr};
+    jit_value_t args[] = {j_udf};
     jit_insn_call_native(j_func_,
-                         "udf_data_eval",
-                         (void*)udf_data_eval,
+                         fn_name.c_str(),
+                         (void*)eval_fn,
                          j_sig,
                          args,
                          CH_COUNTOF(args),
@@ -2199,6 +2705,7 @@ private:
     for (auto node : ctx->nodes()) {
       auto dst_width = node->size();
       auto type = node->type();
+      auto node_addr = var_addr;
       switch (type) {
       default:
         assert(false);
@@ -2230,6 +2737,16 @@ private:
         }
       } break;
       case type_mem:
+        addr_map_[node->id()] = var_addr;
+        sim_ctx_->mem_addrs[node->id()] = var_addr;
+        if (mem_pages::is_paged(reinterpret_cast<memimpl*>(node))) {
+          // paged memories only store their page table
+          sim_ctx_->page_addrs.push_back(var_addr);
+          var_addr += __align_word_size(sizeof(mem_pages*) * 8);
+        } else {
+          var_addr += __align_word_size(dst_width);
+        }
+        break;
       case type_msrport:
         addr_map_[node->id()] = var_addr;
         var_addr += __align_word_size(dst_width);
@@ -2248,6 +2765,13 @@ private:
         auto p = reinterpret_cast<printimpl*>(node);
         var_addr += __align_word_size(print_data_t::size(p) * 8);
       } break;
+      case type_cover: {
+        // counters, has_prev flag and previous values
+        addr_map_[node->id()] = var_addr;
+        sim_ctx_->cover_addrs[node->id()] = var_addr;
+        auto c = reinterpret_cast<coverimpl*>(node);
+        var_addr += __align_word_size((c->num_counters() + 1 + c->num_points()) * sizeof(uint64_t) * 8);
+      } break;
       case type_udfc:
       case type_udfs: {
         addr_map_[node->id()] = var_addr;
@@ -2266,11 +2790,40 @@ private:
         }
         break;
       }
+
+      // sequential state saved by checkpoints,
+      // assert, print and udf data hold native pointers.
+      switch (type) {
+      case type_mem:
+        if (mem_pages::is_paged(reinterpret_cast<memimpl*>(node)))
+          break;
+        [[fallthrough]];
+      case type_cd:
+      case type_reg:
+      case type_msrport:
+      case type_time:
+      case type_cover:
+        sim_ctx_->state_regions.emplace_back(node_addr, var_addr - node_addr);
+        break;
+      default:
+        break;
+      }
+    }
+
+    // guarded scalar values used outside of their region
+    for (auto& spill : spill_map_) {
+      spill.second = var_addr;
+      var_addr += __align_word_size(WORD_SIZE);
+    }
+    if (!guard_map_.empty()) {
+      sim_ctx_->refresh_addr = var_addr;
+      var_addr += __align_word_size(WORD_SIZE);
     }
 
     auto vars_size = var_addr + consts_size;
     if (vars_size) {
       sim_ctx_->state.vars = new uint8_t[vars_size];
+      sim_ctx_->vars_size = vars_size;
       vars_size_= vars_size;
       if (consts_size) {
         this->init_constants(constants, var_addr, consts_size);
@@ -2279,6 +2832,7 @@ private:
 
     if (port_addr) {
       sim_ctx_->state.ports = new block_type*[port_addr];
+      sim_ctx_->ports_size = port_addr;
       ports_size_ = port_addr;
     }
 
@@ -2287,6 +2841,10 @@ private:
   #endif
 
     this->init_variables(ctx);
+
+    if (sim_ctx_->refresh_addr >= 0) {
+      *reinterpret_cast<int32_t*>(sim_ctx_->state.vars + sim_ctx_->refresh_addr) = 0;
+    }
   }
 
   uint32_t alloc_constant(litimpl* lit, std::vector<const_alloc_t>& constants) {
@@ -2389,6 +2947,11 @@ private:
       case type_mem: {
         auto addr = addr_map_.at(node->id());
         auto mem = reinterpret_cast<memimpl*>(node);
+        if (mem_pages::is_paged(mem)) {
+          *reinterpret_cast<mem_pages**>(sim_ctx_->state.vars + addr) =
+            new mem_pages(mem->data_width(), mem->num_items(), mem->init_data());
+          break;
+        }
         auto buf = reinterpret_cast<block_type*>(sim_ctx_->state.vars + addr);
         if (mem->has_init_data()) {
           bv_copy(buf, mem->init_data().words(), dst_width);
@@ -2420,12 +2983,17 @@ private:
       case type_assert: {
         auto addr = addr_map_.at(node->id());
         auto a = reinterpret_cast<assertimpl*>(node);
-        reinterpret_cast<assert_data_t*>(sim_ctx_->state.vars + addr)->init(a, this);
+        reinterpret_cast<assert_data_t*>(sim_ctx_->state.vars + addr)->init(a, this, sim_ctx_->logger);
       } break;
       case type_print: {
         auto addr = addr_map_.at(node->id());
         auto p = reinterpret_cast<printimpl*>(node);
-        reinterpret_cast<print_data_t*>(sim_ctx_->state.vars + addr)->init(p, this);
+        reinterpret_cast<print_data_t*>(sim_ctx_->state.vars + addr)->init(p, this, sim_ctx_->logger);
+      } break;
+      case type_cover: {
+        auto addr = addr_map_.at(node->id());
+        auto c = reinterpret_cast<coverimpl*>(node);
+        memset(sim_ctx_->state.vars + addr, 0, (c->num_counters() + 1 + c->num_points()) * sizeof(uint64_t));
       } break;
       case type_udfc:
       case type_udfs: {
@@ -3015,6 +3583,7 @@ private:
   memaddr_t get_pointer_address(lnodeimpl* node) {
     switch (node->type()) {
     case type_input:
+    case type_udfout:
       return memaddr_t{input_map_.at(node->id()), 0};
     default:
       return memaddr_t{j_vars_, addr_map_.at(node->id())};
@@ -3157,6 +3726,9 @@ public:
     : sim_ctx_(ctx)
     , l_bypass_(jit_label_undefined)
     , bypass_enable_(false)
+    , guard_cd_(nullptr)
+    , l_guard_(jit_label_undefined)
+    , j_refresh_(nullptr)
     , word_type_(to_value_type(WORD_SIZE))
     , vars_size_(0)
     , ports_size_(0)
@@ -3178,12 +3750,30 @@ public:
     // create JIT function
     this->create_function();
 
+    // setup deferred print logging
+    auto ctx = eval_list.back()->ctx();
+    if ((platform::self().cflags() & ch_flags::deferred_print) != 0
+     && std::any_of(ctx->gtaps().begin(), ctx->gtaps().end(),
+                    [](lnodeimpl* node) { return type_print == node->type(); })) {
+      sim_ctx_->logger = new print_logger();
+    }
+
+    // split combinational logic into clock domain regions
+    this->build_guards(ctx, eval_list);
+
     // allocate objects
-    this->allocate_nodes(eval_list.back()->ctx());
+    this->allocate_nodes(ctx);
+
+    if (sim_ctx_->refresh_addr >= 0) {
+      // all regions are evaluated after initialization or a state restore
+      auto j_flag = jit_insn_load_relative(j_func_, j_vars_, sim_ctx_->refresh_addr, jit_type_int32);
+      j_refresh_ = jit_insn_eq(j_func_, j_flag, this->emit_constant(0, jit_type_int32));
+    }
 
     // lower all nodes
     for (auto node : eval_list) {
       this->resolve_branch(node);
+      this->resolve_guard(node);
       switch (node->type()) {
       default:
         assert(false);
@@ -3232,6 +3822,9 @@ public:
       case type_print:
         this->emit_node(reinterpret_cast<printimpl*>(node));
         break;
+      case type_cover:
+        this->emit_node(reinterpret_cast<coverimpl*>(node));
+        break;
       case type_udfc:
         this->emit_node(reinterpret_cast<udfcimpl*>(node));
         break;
@@ -3243,9 +3836,17 @@ public:
       }
     }
 
+    // close pending guard region
+    this->resolve_guard(nullptr);
+
     // create bypass label
     this->resolve_branch(nullptr);
 
+    if (sim_ctx_->refresh_addr >= 0) {
+      auto j_one = this->emit_constant(1, jit_type_int32);
+      jit_insn_store_relative(j_func_, j_vars_, sim_ctx_->refresh_addr, j_one);
+    }
+
     // return 0
     auto j_zero = this->emit_constant(0, jit_type_int32);
     jit_insn_return(j_func_, j_zero);
@@ -3277,6 +3878,7 @@ public:
     // get closure
     sim_ctx_->entry = reinterpret_cast<pfn_entry>(jit_function_to_closure(j_func_));
   #endif
+    sim_ctx_->code_size = jit_function_get_code_size(j_func_);
   }
 };
 
@@ -3324,16 +3926,32 @@ void init_sdata(const Compiler* Cp, sdata_type* data, lnodeimpl* node) {
     }
   }
   data->emplace(value, node->size());
+  auto offset = reinterpret_cast<uint8_t*>(data) - Cp->sim_ctx_->state.vars;
+  Cp->sim_ctx_->sdata_relocs.push_back(offset);
+}
+
+void add_reloc(const Compiler* Cp, void* field) {
+  auto offset = reinterpret_cast<uint8_t*>(field) - Cp->sim_ctx_->state.vars;
+  Cp->sim_ctx_->ptr_relocs.push_back(offset);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-driver::driver() {
+driver::driver() : watch_ctx_(nullptr), source_(nullptr) {
   sim_ctx_ = new sim_ctx_t();
 }
 
+driver::driver(const driver* source) : watch_ctx_(nullptr), source_(source) {
+  sim_ctx_ = new sim_ctx_t(false);
+  source->acquire();
+}
+
 driver::~driver() {
+  delete watch_ctx_;
   delete sim_ctx_;
+  if (source_) {
+    source_->release();
+  }
 }
 
 void driver::initialize(const std::vector<lnodeimpl*>& eval_list) {
@@ -3341,7 +3959,154 @@ void driver::initialize(const std::vector<lnodeimpl*>& eval_list) {
   compiler.build(eval_list);
 }
 
-void driver::eval() {
+const uint64_t* driver::coverage(lnodeimpl* node) const {
+  auto addr = sim_ctx_->cover_addrs.at(node->id());
+  return reinterpret_cast<const uint64_t*>(sim_ctx_->state.vars + addr);
+}
+
+uint64_t driver::code_size() const {
+  return sim_ctx_->code_size;
+}
+
+uint64_t driver::state_size() const {
+  return sim_ctx_->vars_size + sim_ctx_->ports_size * sizeof(block_type*);
+}
+
+void driver::save(std::ostream& out) const {
+  for (auto& region : sim_ctx_->state_regions) {
+    out.write(reinterpret_cast<const char*>(sim_ctx_->state.vars + region.first), region.second);
+  }
+  for (auto addr : sim_ctx_->page_addrs) {
+    (*reinterpret_cast<mem_pages**>(sim_ctx_->state.vars + addr))->save(out);
+  }
+}
+
+void driver::restore(std::istream& in) {
+  for (auto& region : sim_ctx_->state_regions) {
+    in.read(reinterpret_cast<char*>(sim_ctx_->state.vars + region.first), region.second);
+  }
+  for (auto addr : sim_ctx_->page_addrs) {
+    (*reinterpret_cast<mem_pages**>(sim_ctx_->state.vars + addr))->restore(in);
+  }
+  if (sim_ctx_->refresh_addr >= 0) {
+    *reinterpret_cast<int32_t*>(sim_ctx_->state.vars + sim_ctx_->refresh_addr) = 0;
+  }
+}
+
+void driver::read_mem(memimpl* mem, uint64_t offset, block_type* dst, uint32_t length) const {
+  auto data = sim_ctx_->state.vars + sim_ctx_->mem_addrs.at(mem->id());
+  if (mem_pages::is_paged(mem)) {
+    (*reinterpret_cast<mem_pages**>(data))->read(offset, dst, length);
+  } else {
+    bv_copy(dst, 0, reinterpret_cast<const block_type*>(data), uint32_t(offset), length);
+  }
+}
+
+void driver::write_mem(memimpl* mem, uint64_t offset, const block_type* src, uint32_t length) {
+  auto data = sim_ctx_->state.vars + sim_ctx_->mem_addrs.at(mem->id());
+  if (mem_pages::is_paged(mem)) {
+    (*reinterpret_cast<mem_pages**>(data))->write(offset, src, length);
+  } else {
+    bv_copy(reinterpret_cast<block_type*>(data), uint32_t(offset), src, 0, length);
+  }
+  // guarded regions may read the memory
+  if (sim_ctx_->refresh_addr >= 0) {
+    *reinterpret_cast<int32_t*>(sim_ctx_->state.vars + sim_ctx_->refresh_addr) = 0;
+  }
+}
+
+sim_driver* driver::fork(const port_map_t& ports) const {
+  // the compiled code only addresses state through its argument,
+  // forks share it and get a private copy of ports and variables.
+  auto other = new driver(source_ ? source_ : this);
+  auto src = sim_ctx_;
+  auto dst = other->sim_ctx_;
+#ifdef JIT_BACKEND_INTERP
+  dst->j_func = src->j_func;
+#else
+  dst->entry = src->entry;
+#endif
+  dst->vars_size = src->vars_size;
+  dst->ports_size = src->ports_size;
+  dst->refresh_addr = src->refresh_addr;
+  dst->code_size = src->code_size;
+  dst->cover_addrs = src->cover_addrs;
+  dst->mem_addrs = src->mem_addrs;
+  dst->state_regions = src->state_regions;
+  dst->ptr_relocs = src->ptr_relocs;
+  dst->sdata_relocs = src->sdata_relocs;
+  dst->page_addrs = src->page_addrs;
+
+  if (src->ports_size) {
+    dst->state.ports = new block_type*[src->ports_size];
+    for (uint32_t i = 0; i < src->ports_size; ++i) {
+      dst->state.ports[i] = ports.at(src->state.ports[i]);
+    }
+  }
+
+  auto old_vars = src->state.vars;
+  if (src->vars_size) {
+    dst->state.vars = new uint8_t[src->vars_size];
+    memcpy(dst->state.vars, old_vars, src->vars_size);
+  }
+  auto new_vars = dst->state.vars;
+
+  // paged memories get their own page table
+  for (auto addr : src->page_addrs) {
+    auto field = reinterpret_cast<mem_pages**>(new_vars + addr);
+    *field = new mem_pages(**field);
+  }
+
+#ifndef NDEBUG
+  dst->state.dbg = new char[4096];
+  memcpy(dst->state.dbg, src->state.dbg, 4096);
+#endif
+
+  // forks log deferred prints through their own logger
+  if (src->logger) {
+    dst->logger = new print_logger(*src->logger);
+  }
+
+  // pointers outside of the variables are dropped,
+  // the parent's print logger maps to the fork's.
+  auto relocate = [&](const void* ptr)->uint8_t* {
+    auto p = reinterpret_cast<const uint8_t*>(ptr);
+    if (p >= old_vars && p < old_vars + src->vars_size)
+      return new_vars + (p - old_vars);
+    if (src->logger && ptr == src->logger)
+      return reinterpret_cast<uint8_t*>(dst->logger);
+    return nullptr;
+  };
+
+  for (auto offset : src->ptr_relocs) {
+    auto field = reinterpret_cast<void**>(new_vars + offset);
+    *field = relocate(*field);
+  }
+
+  for (auto offset : src->sdata_relocs) {
+    auto data = reinterpret_cast<sdata_type*>(new_vars + offset);
+    auto it = ports.find(data->words());
+    if (it != ports.end()) {
+      data->emplace(it->second);
+    } else {
+      data->emplace(reinterpret_cast<block_type*>(relocate(data->words())));
+    }
+  }
+
+  return other;
+}
+
+bool driver::bind_watches(watch_driver::watch_t* watches, uint32_t count) {
+  delete watch_ctx_;
+  watch_ctx_ = nullptr;
+  if (count) {
+    watch_ctx_ = new watch_ctx_t();
+    watch_ctx_->build(watches, count);
+  }
+  return true;
+}
+
+bool driver::eval() {
   int ret;
 #ifdef JIT_BACKEND_INTERP
   void* arg = &sim_ctx_->state;
@@ -3355,6 +4120,7 @@ void driver::eval() {
   if (ret) {
     error_handler(ret);
   }
+  return watch_ctx_ && watch_ctx_->eval();
 }
 
 }
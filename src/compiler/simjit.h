@@ -5,6 +5,7 @@
 namespace ch::internal::simjit {
 
 struct sim_ctx_t;
+struct watch_ctx_t;
 
 class driver : public sim_driver {
 public:
@@ -15,11 +16,33 @@ public:
 
   void initialize(const std::vector<lnodeimpl*>& eval_list) override;
 
-  void eval() override;  
+  bool eval() override;
+
+  bool bind_watches(watch_driver::watch_t* watches, uint32_t count) override;
+
+  const uint64_t* coverage(lnodeimpl* node) const override;
+
+  uint64_t code_size() const override;
+
+  uint64_t state_size() const override;
+
+  void save(std::ostream& out) const override;
+
+  void restore(std::istream& in) override;
+
+  void read_mem(memimpl* mem, uint64_t offset, block_type* dst, uint32_t length) const override;
+
+  void write_mem(memimpl* mem, uint64_t offset, const block_type* src, uint32_t length) override;
+
+  sim_driver* fork(const port_map_t& ports) const override;
 
 private:
 
+  driver(const driver* source);
+
   sim_ctx_t* sim_ctx_;
+  watch_ctx_t* watch_ctx_;
+  const driver* source_;
 };
 
 }
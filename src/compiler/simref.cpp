@@ -11,16 +11,31 @@
 #include "opimpl.h"
 #include "assertimpl.h"
 #include "printimpl.h"
+#include "coverimpl.h"
 #include "timeimpl.h"
 #include "udfimpl.h"
 #include "udf.h"
 #include "compile.h"
+#include "printlogger.h"
+#include "mempages.h"
 
 using namespace ch::internal;
 //using namespace ch::internal::simref;
 
 namespace ch::internal::simref {
 
+struct instr_base;
+struct dispatch_t;
+
+using handler_t = void (*)(const dispatch_t*);
+
+// direct-threaded code entry, the handler evaluates the instruction
+// and tail-calls the handler of the next entry.
+struct dispatch_t {
+  handler_t handler;
+  instr_base* instr;
+};
+
 struct instr_base {
 
   instr_base() {}
@@ -30,20 +45,123 @@ struct instr_base {
   virtual void destroy() = 0;
 
   virtual void eval() = 0;
+
+  // specialized handler evaluating this instruction
+  virtual handler_t handler() const = 0;
+
+  // handler evaluating this instruction and the next one, if they fuse
+  virtual handler_t fuse(const instr_base*) const {
+    return nullptr;
+  }
+
+  // checkpoint the sequential state
+  virtual void save(std::ostream&) const {}
+
+  virtual void restore(std::istream&) {}
 };
 
+template <typename T>
+void dispatch_one(const dispatch_t* entry) {
+  static_cast<T*>(entry->instr)->T::eval();
+  ++entry;
+  return entry->handler(entry);
+}
+
+template <typename T0, typename T1>
+void dispatch_two(const dispatch_t* entry) {
+  static_cast<T0*>(entry[0].instr)->T0::eval();
+  static_cast<T1*>(entry[1].instr)->T1::eval();
+  entry += 2;
+  return entry->handler(entry);
+}
+
+inline void dispatch_exit(const dispatch_t*) {}
+
+template <typename T>
+handler_t fuse_with(const instr_base*) {
+  return nullptr;
+}
+
+template <typename T, typename Next, typename... Nexts>
+handler_t fuse_with(const instr_base* next) {
+  if (next->handler() == &dispatch_one<Next>)
+    return &dispatch_two<T, Next>;
+  return fuse_with<T, Nexts...>(next);
+}
+
+template <typename T>
+void save_state(std::ostream& out, const T* data, uint32_t count = 1) {
+  out.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+}
+
+template <typename T>
+void restore_state(std::istream& in, T* data, uint32_t count = 1) {
+  in.read(reinterpret_cast<char*>(data), sizeof(T) * count);
+}
+
+inline void save_bits(std::ostream& out, const block_type* data, uint32_t size) {
+  save_state<block_type>(out, data, ceildiv(size, bitwidth_v<block_type>));
+}
+
+inline void restore_bits(std::istream& in, block_type* data, uint32_t size) {
+  restore_state<block_type>(in, data, ceildiv(size, bitwidth_v<block_type>));
+}
+
 using data_map_t  = std::unordered_map<uint32_t, const block_type*>;
 using instr_map_t = std::unordered_map<uint32_t, instr_base*>;
 using node_map_t  = std::unordered_map<uint32_t, uint32_t>;
 
 #define __aligned_sizeof(...) (4*((sizeof(__VA_ARGS__) + 3)/4))
 
+// bump allocator packing the instructions and their data buffers
+// into contiguous chunks, in creation order.
+class instr_arena {
+public:
+
+  instr_arena() : cur_(nullptr), end_(nullptr) {}
+
+  ~instr_arena() {
+    for (auto chunk : chunks_) {
+      ::operator delete(chunk);
+    }
+  }
+
+  uint8_t* alloc(uint32_t size) {
+    size = (size + alignment - 1) & ~(alignment - 1);
+    if (size > chunk_size / 4) {
+      // large blocks get their own chunk
+      auto buf = reinterpret_cast<uint8_t*>(::operator new(size));
+      chunks_.push_back(buf);
+      std::fill_n(buf, size, 0);
+      return buf;
+    }
+    if (size > uint32_t(end_ - cur_)) {
+      cur_ = reinterpret_cast<uint8_t*>(::operator new(chunk_size));
+      end_ = cur_ + chunk_size;
+      chunks_.push_back(cur_);
+    }
+    auto buf = cur_;
+    cur_ += size;
+    std::fill_n(buf, size, 0);
+    return buf;
+  }
+
+private:
+
+  static constexpr uint32_t alignment  = 16;
+  static constexpr uint32_t chunk_size = 64 * 1024;
+
+  std::vector<uint8_t*> chunks_;
+  uint8_t* cur_;
+  uint8_t* end_;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class instr_proxy_base : public instr_base {
 public:
 
-  static instr_proxy_base* create(proxyimpl* node, data_map_t& map);
+  static instr_proxy_base* create(proxyimpl* node, data_map_t& map, instr_arena& arena);
 
 protected:
 
@@ -69,7 +187,10 @@ public:
 
   void destroy() override {
     this->~instr_slice();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_slice>;
   }
 
   void eval() override {
@@ -103,7 +224,10 @@ public:
 
   void destroy() override {
     this->~instr_proxy();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_proxy>;
   }
 
   void eval() override {
@@ -156,7 +280,7 @@ private:
   friend class instr_proxy_base;
 };
 
-instr_proxy_base* instr_proxy_base::create(proxyimpl* node, data_map_t& map) {
+instr_proxy_base* instr_proxy_base::create(proxyimpl* node, data_map_t& map, instr_arena& arena) {
   uint32_t dst_size = node->size();
   uint32_t dst_nblocks = ceildiv(dst_size, bitwidth_v<block_type>);
   uint32_t dst_bytes = sizeof(block_type) * dst_nblocks;
@@ -164,7 +288,7 @@ instr_proxy_base* instr_proxy_base::create(proxyimpl* node, data_map_t& map) {
 
   if (1 == num_ranges
    && node->range(0).length == dst_size) {
-    auto buf = new uint8_t[__aligned_sizeof(instr_slice<false>) + dst_bytes]();
+    auto buf = arena.alloc(__aligned_sizeof(instr_slice<false>) + dst_bytes);
     auto buf_cur = buf + __aligned_sizeof(instr_slice<false>);
     auto dst = (block_type*)buf_cur;
     map[node->id()] = dst;
@@ -187,7 +311,7 @@ instr_proxy_base* instr_proxy_base::create(proxyimpl* node, data_map_t& map) {
       range_bytes += __aligned_sizeof(instr_proxy_base::range_t);
     }
 
-    auto buf = new uint8_t[__aligned_sizeof(instr_proxy<false>) + dst_bytes + range_bytes]();
+    auto buf = arena.alloc(__aligned_sizeof(instr_proxy<false>) + dst_bytes + range_bytes);
     auto buf_cur = buf + __aligned_sizeof(instr_proxy<false>);
     auto dst = (block_type*)buf_cur;
     map[node->id()] = dst;
@@ -223,7 +347,7 @@ instr_proxy_base* instr_proxy_base::create(proxyimpl* node, data_map_t& map) {
 class instr_output_base : public instr_base {
 public:
 
-  static instr_output_base* create(ioportimpl* node, data_map_t& map);
+  static instr_output_base* create(ioportimpl* node, block_type* dst, data_map_t& map, instr_arena& arena);
 
 protected:
 
@@ -243,7 +367,11 @@ class instr_output : public instr_output_base {
 public:
 
   void destroy() override {
-    delete this;
+    this->~instr_output();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_output>;
   }
 
   void eval() override {
@@ -263,14 +391,14 @@ private:
   friend class instr_output_base;
 };
 
-instr_output_base* instr_output_base::create(ioportimpl* node, data_map_t& map) {
-  auto dst  = node->value()->words();
+instr_output_base* instr_output_base::create(ioportimpl* node, block_type* dst, data_map_t& map, instr_arena& arena) {
   auto src  = map.at(node->src(0).id());
   auto size = node->size();
+  auto buf  = arena.alloc(__aligned_sizeof(instr_output<false>));
   if (size <= bitwidth_v<block_type>) {
-    return new instr_output<true>(dst, src, size);
+    return new (buf) instr_output<true>(dst, src, size);
   } else {
-    return new instr_output<false>(dst, src, size);
+    return new (buf) instr_output<false>(dst, src, size);
   }
 }
 
@@ -279,7 +407,7 @@ instr_output_base* instr_output_base::create(ioportimpl* node, data_map_t& map)
 class instr_op_base : public instr_base {
 public:
 
-  static instr_op_base* create(opimpl* node, data_map_t& map);
+  static instr_op_base* create(opimpl* node, data_map_t& map, instr_arena& arena);
 
 protected:
 
@@ -305,13 +433,27 @@ protected:
   uint32_t src1_size_;
 };
 
+template <bool is_scalar> class instr_select;
+
 template <ch_op op, bool is_signed, bool is_scalar, bool resize_opds>
-class instr_op : instr_op_base {
+class instr_op : public instr_op_base {
 public:
 
   void destroy() override {
     this->~instr_op();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_op>;
+  }
+
+  // scalar ops fuse with the proxy or select that follows
+  handler_t fuse(const instr_base* next) const override {
+    if constexpr (is_scalar) {
+      return fuse_with<instr_op, instr_slice<true>, instr_proxy<true>, instr_select<true>>(next);
+    } else {
+      return nullptr;
+    }
   }
 
   void eval() override {
@@ -524,7 +666,7 @@ private:
   friend class instr_op_base;
 };
 
-instr_op_base* instr_op_base::create(opimpl* node, data_map_t& map) {
+instr_op_base* instr_op_base::create(opimpl* node, data_map_t& map, instr_arena& arena) {
   uint32_t dst_size = node->size();
   bool is_signed = node->is_signed();
 
@@ -554,7 +696,7 @@ instr_op_base* instr_op_base::create(opimpl* node, data_map_t& map) {
 
   uint32_t dst_bytes = sizeof(block_type) * ceildiv(dst_size, bitwidth_v<block_type>);
 
-  auto buf = new uint8_t[__aligned_sizeof(instr_op_base) + dst_bytes]();
+  auto buf = arena.alloc(__aligned_sizeof(instr_op_base) + dst_bytes);
   auto buf_cur = buf + __aligned_sizeof(instr_op_base);
   auto dst = (block_type*)buf_cur;
   map[node->id()] = dst;
@@ -626,10 +768,12 @@ instr_op_base* instr_op_base::create(opimpl* node, data_map_t& map) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+template <bool is_scalar> class instr_case;
+
 class instr_select_base : public instr_base {
 public:
 
-  static instr_select_base* create(selectimpl* node, data_map_t& map);
+  static instr_select_base* create(selectimpl* node, data_map_t& map, instr_arena& arena);
 
 protected:
 
@@ -653,7 +797,19 @@ public:
 
   void destroy() override {
     this->~instr_select();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_select>;
+  }
+
+  // scalar select chains evaluate in one dispatch
+  handler_t fuse(const instr_base* next) const override {
+    if constexpr (is_scalar) {
+      return fuse_with<instr_select, instr_select<true>, instr_case<true>>(next);
+    } else {
+      return nullptr;
+    }
   }
 
   void eval() override {
@@ -687,7 +843,18 @@ public:
 
   void destroy() override {
     this->~instr_case();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_case>;
+  }
+
+  handler_t fuse(const instr_base* next) const override {
+    if constexpr (is_scalar) {
+      return fuse_with<instr_case, instr_select<true>, instr_case<true>>(next);
+    } else {
+      return nullptr;
+    }
   }
 
   void eval() override {
@@ -726,7 +893,7 @@ private:
   friend class instr_select_base;
 };
 
-instr_select_base* instr_select_base::create(selectimpl* node, data_map_t& map) {
+instr_select_base* instr_select_base::create(selectimpl* node, data_map_t& map, instr_arena& arena) {
   uint32_t dst_size = node->size();
   uint32_t dst_nblocks = ceildiv(dst_size, bitwidth_v<block_type>);
   uint32_t dst_bytes = sizeof(block_type) * dst_nblocks;
@@ -739,7 +906,7 @@ instr_select_base* instr_select_base::create(selectimpl* node, data_map_t& map)
     uint32_t key_size = node->src(0).size();
     is_scalar &= key_size <= bitwidth_v<block_type>;
 
-    auto buf = new uint8_t[__aligned_sizeof(instr_case<false>) + dst_bytes + src_bytes]();
+    auto buf = arena.alloc(__aligned_sizeof(instr_case<false>) + dst_bytes + src_bytes);
     auto buf_cur = buf + __aligned_sizeof(instr_case<false>);
     auto dst = (block_type*)buf_cur;
     map[node->id()] = dst;
@@ -757,7 +924,7 @@ instr_select_base* instr_select_base::create(selectimpl* node, data_map_t& map)
       return new (buf) instr_case<false>(dst, dst_size, srcs, num_srcs, key_size);
     }
   } else {
-    auto buf = new uint8_t[__aligned_sizeof(instr_select<false>) + dst_bytes + src_bytes]();
+    auto buf = arena.alloc(__aligned_sizeof(instr_select<false>) + dst_bytes + src_bytes);
     auto buf_cur = buf + __aligned_sizeof(instr_select<false>);
     auto dst = (block_type*)buf_cur;
     map[node->id()] = dst;
@@ -782,12 +949,16 @@ instr_select_base* instr_select_base::create(selectimpl* node, data_map_t& map)
 class instr_cd : public instr_base {
 public:
 
-  static instr_cd* create(cdimpl* node, data_map_t& map) {
-    return new instr_cd(node, map);
+  static instr_cd* create(cdimpl* node, data_map_t& map, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_cd))) instr_cd(node, map);
   }
 
   void destroy() override {
-    delete this;
+    this->~instr_cd();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_cd>;
   }
 
   void eval() override {
@@ -796,6 +967,14 @@ public:
     prev_clk_ = clk;
   }
 
+  void save(std::ostream& out) const override {
+    save_state(out, &prev_clk_);
+  }
+
+  void restore(std::istream& in) override {
+    restore_state(in, &prev_clk_);
+  }
+
 private:
 
   instr_cd(cdimpl* node, data_map_t& map)
@@ -817,7 +996,7 @@ private:
 class instr_reg_base : public instr_base {
 public:
 
-  static instr_reg_base* create(regimpl* node, data_map_t& map);
+  static instr_reg_base* create(regimpl* node, data_map_t& map, instr_arena& arena);
 
   void init(regimpl* node, data_map_t& map) {
     cd_       = map.at(node->cd().id());
@@ -827,6 +1006,14 @@ public:
     next_     = map.at(node->next().id());
   }
 
+  void save(std::ostream& out) const override {
+    save_bits(out, dst_, size_);
+  }
+
+  void restore(std::istream& in) override {
+    restore_bits(in, dst_, size_);
+  }
+
 protected:
 
   instr_reg_base(block_type* dst, uint32_t size)
@@ -854,7 +1041,10 @@ public:
 
   void destroy() override {
     this->~instr_reg();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_reg>;
   }
 
   void eval() override {
@@ -907,7 +1097,10 @@ public:
 
   void destroy() override {
     this->~instr_pipe();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_pipe>;
   }
 
   void eval() override {
@@ -955,6 +1148,18 @@ public:
     }
   }
 
+  void save(std::ostream& out) const override {
+    instr_reg_base::save(out);
+    save_bits(out, pipe_, pipe_size_);
+    save_state(out, &idx_);
+  }
+
+  void restore(std::istream& in) override {
+    instr_reg_base::restore(in);
+    restore_bits(in, pipe_, pipe_size_);
+    restore_state(in, &idx_);
+  }
+
 protected:
 
   instr_pipe(block_type* dst, uint32_t size, block_type* pipe, uint32_t pipe_size)
@@ -971,7 +1176,7 @@ protected:
   friend class instr_reg_base;
 };
 
-instr_reg_base* instr_reg_base::create(regimpl* node, data_map_t& map) {
+instr_reg_base* instr_reg_base::create(regimpl* node, data_map_t& map, instr_arena& arena) {
   uint32_t dst_size  = node->size();
   uint32_t nblocks   = ceildiv(dst_size, bitwidth_v<block_type>);
   uint32_t dst_bytes = sizeof(block_type) * nblocks;
@@ -984,10 +1189,10 @@ instr_reg_base* instr_reg_base::create(regimpl* node, data_map_t& map) {
     is_scalar &= (pipe_size <= bitwidth_v<block_type>);
 
     uint32_t pipe_bytes = sizeof(block_type) * ceildiv(pipe_size, bitwidth_v<block_type>);
-    buf = new uint8_t[__aligned_sizeof(instr_pipe<false, false, false>) + dst_bytes + pipe_bytes]();
+    buf = arena.alloc(__aligned_sizeof(instr_pipe<false, false, false>) + dst_bytes + pipe_bytes);
     buf_cur = buf + __aligned_sizeof(instr_pipe<false, false, false>);
   } else {
-    buf = new uint8_t[__aligned_sizeof(instr_reg<false, false, false>) + dst_bytes]();
+    buf = arena.alloc(__aligned_sizeof(instr_reg<false, false, false>) + dst_bytes);
     buf_cur = buf + __aligned_sizeof(instr_reg<false, false, false>);
   }
 
@@ -1069,15 +1274,40 @@ public:
 
   ~instr_mport_base() {
     if (own_store_) {
+      delete pages_;
       delete [] store_;
     }
   }
 
+  void save(std::ostream& out) const override {
+    if (own_store_) {
+      if (pages_) {
+        pages_->save(out);
+      } else {
+        save_bits(out, store_, store_size_);
+      }
+    }
+  }
+
+  void restore(std::istream& in) override {
+    if (own_store_) {
+      if (pages_) {
+        pages_->restore(in);
+      } else {
+        restore_bits(in, store_, store_size_);
+      }
+    }
+  }
+
 protected:
 
   instr_mport_base(uint32_t data_size)
     : own_store_(false)
     , store_(nullptr)
+    , store_size_(0)
+    , pages_(nullptr)
+    , page_shift_(0)
+    , page_mask_(0)
     , addr_(nullptr)
     , addr_size_(0)
     , data_size_(data_size)
@@ -1086,7 +1316,18 @@ protected:
   void init(memportimpl* node, data_map_t& map) {
     auto mem = node->mem();
     auto it = map.find(mem->id());
-    if (it != map.end()) {
+    if (mem_pages::is_paged(mem)) {
+      // paged memories map to their page table
+      if (it != map.end()) {
+        pages_ = reinterpret_cast<mem_pages*>(const_cast<block_type*>(it->second));
+      } else {
+        pages_ = new mem_pages(mem->data_width(), mem->num_items(), mem->init_data());
+        map[mem->id()] = reinterpret_cast<const block_type*>(pages_);
+        own_store_ = true;
+      }
+      page_shift_ = mem_pages::page_shift(mem->data_width());
+      page_mask_ = (1u << page_shift_) - 1;
+    } else if (it != map.end()) {
       store_ = const_cast<block_type*>(it->second);
     } else {
       uint32_t nblocks = ceildiv(mem->size(), bitwidth_v<block_type>);
@@ -1097,6 +1338,7 @@ protected:
         bv_init(store_, mem->size());
       }
       map[mem->id()] = store_;
+      store_size_ = mem->size();
       own_store_ = true;
     }    
     addr_ = map.at(node->addr().id());
@@ -1105,6 +1347,10 @@ protected:
 
   bool own_store_;
   block_type* store_;  
+  uint32_t store_size_;
+  mem_pages* pages_;
+  uint32_t page_shift_;
+  uint32_t page_mask_;
   const block_type* addr_;
   uint32_t addr_size_;
   uint32_t data_size_;
@@ -1115,7 +1361,7 @@ protected:
 class instr_marport_base : public instr_mport_base {
 public:
 
-  static instr_marport_base* create(marportimpl* node, data_map_t& map) ;
+  static instr_marport_base* create(marportimpl* node, data_map_t& map, instr_arena& arena) ;
 
 protected:
 
@@ -1127,24 +1373,34 @@ protected:
   block_type* dst_;
 };
 
-template <bool is_scalar>
+template <bool is_scalar, bool is_paged>
 class instr_marport : public instr_marport_base {
 public:
 
   void destroy() override {
     this->~instr_marport();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_marport>;
   }
 
   void eval() override {
     auto addr = bv_cast<uint32_t>(addr_, addr_size_);
+    const block_type* store;
+    if constexpr (is_paged) {
+      store = pages_->read_page(addr >> page_shift_);
+      addr &= page_mask_;
+    } else {
+      store = store_;
+    }
     auto src_offset = addr * data_size_;
     auto src_idx = src_offset / bitwidth_v<block_type>;
     auto src_lsb = src_offset % bitwidth_v<block_type>;
     if constexpr (is_scalar) {
-      bv_slice_vector_small(dst_, data_size_, store_ + src_idx, src_lsb);
+      bv_slice_vector_small(dst_, data_size_, store + src_idx, src_lsb);
     } else {
-      bv_slice_vector(dst_, data_size_, store_ + src_idx, src_lsb);
+      bv_slice_vector(dst_, data_size_, store + src_idx, src_lsb);
     }
   }
 
@@ -1157,12 +1413,12 @@ private:
   friend class instr_marport_base;
 };
 
-instr_marport_base* instr_marport_base::create(marportimpl* node, data_map_t& map) {
+instr_marport_base* instr_marport_base::create(marportimpl* node, data_map_t& map, instr_arena& arena) {
   uint32_t dst_size  = node->size();
   uint32_t nblocks   = ceildiv(dst_size, bitwidth_v<block_type>);
   uint32_t dst_bytes = sizeof(block_type) * nblocks;
 
-  auto buf = new uint8_t[__aligned_sizeof(instr_marport_base) + dst_bytes]();
+  auto buf = arena.alloc(__aligned_sizeof(instr_marport_base) + dst_bytes);
   auto buf_cur = buf + __aligned_sizeof(instr_marport_base);
   auto dst = (block_type*)buf_cur;
   map[node->id()] = dst;
@@ -1170,10 +1426,19 @@ instr_marport_base* instr_marport_base::create(marportimpl* node, data_map_t& ma
 
   instr_marport_base* instr;
   bool is_scalar = (dst_size <= bitwidth_v<block_type>);
+  bool is_paged = mem_pages::is_paged(node->mem());
   if (is_scalar) {
-    instr = new (buf) instr_marport<true>(dst, dst_size);
+    if (is_paged) {
+      instr = new (buf) instr_marport<true, true>(dst, dst_size);
+    } else {
+      instr = new (buf) instr_marport<true, false>(dst, dst_size);
+    }
   } else {
-    instr = new (buf) instr_marport<false>(dst, dst_size);
+    if (is_paged) {
+      instr = new (buf) instr_marport<false, true>(dst, dst_size);
+    } else {
+      instr = new (buf) instr_marport<false, false>(dst, dst_size);
+    }
   }
   instr->init(node, map);
   return instr;
@@ -1184,7 +1449,7 @@ instr_marport_base* instr_marport_base::create(marportimpl* node, data_map_t& ma
 class instr_msrport_base : public instr_mport_base {
 public:
 
-  static instr_msrport_base* create(msrportimpl* node, data_map_t& map) ;
+  static instr_msrport_base* create(msrportimpl* node, data_map_t& map, instr_arena& arena) ;
 
   void init(msrportimpl* node, data_map_t& map) {
     instr_mport_base::init(node, map);
@@ -1194,6 +1459,16 @@ public:
     }
   }
 
+  void save(std::ostream& out) const override {
+    instr_mport_base::save(out);
+    save_bits(out, dst_, data_size_);
+  }
+
+  void restore(std::istream& in) override {
+    instr_mport_base::restore(in);
+    restore_bits(in, dst_, data_size_);
+  }
+
 protected:
 
   instr_msrport_base(block_type* dst, uint32_t dst_size)
@@ -1208,13 +1483,16 @@ protected:
   const block_type* enable_;
 };
 
-template <bool is_scalar>
+template <bool is_scalar, bool is_paged>
 class instr_msrport : public instr_msrport_base {
 public:
 
   void destroy() override {
     this->~instr_msrport();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_msrport>;
   }
 
   void eval() override {
@@ -1222,13 +1500,20 @@ public:
      || (enable_ && !static_cast<bool>(enable_[0])))
       return;
     auto addr = bv_cast<uint32_t>(addr_, addr_size_);
+    const block_type* store;
+    if constexpr (is_paged) {
+      store = pages_->read_page(addr >> page_shift_);
+      addr &= page_mask_;
+    } else {
+      store = store_;
+    }
     auto src_offset = addr * data_size_;
     auto src_idx = src_offset / bitwidth_v<block_type>;
     auto src_lsb = src_offset % bitwidth_v<block_type>;
     if constexpr (is_scalar) {
-      bv_slice_vector_small(dst_, data_size_, store_ + src_idx, src_lsb);
+      bv_slice_vector_small(dst_, data_size_, store + src_idx, src_lsb);
     } else {
-      bv_slice_vector(dst_, data_size_, store_ + src_idx, src_lsb);
+      bv_slice_vector(dst_, data_size_, store + src_idx, src_lsb);
     }
   }
 
@@ -1241,22 +1526,31 @@ private:
   friend class instr_msrport_base;
 };
 
-instr_msrport_base* instr_msrport_base::create(msrportimpl* node, data_map_t& map) {
+instr_msrport_base* instr_msrport_base::create(msrportimpl* node, data_map_t& map, instr_arena& arena) {
   uint32_t dst_size  = node->size();
   uint32_t nblocks   = ceildiv(dst_size, bitwidth_v<block_type>);
   uint32_t dst_bytes = sizeof(block_type) * nblocks;
 
-  auto buf = new uint8_t[__aligned_sizeof(instr_msrport_base) + dst_bytes]();
+  auto buf = arena.alloc(__aligned_sizeof(instr_msrport_base) + dst_bytes);
   auto buf_cur = buf + __aligned_sizeof(instr_msrport_base);
   auto dst = (block_type*)buf_cur;
   map[node->id()] = dst;
   bv_init(dst, dst_size);
 
   bool is_scalar = (dst_size <= bitwidth_v<block_type>);
+  bool is_paged = mem_pages::is_paged(node->mem());
   if (is_scalar) {
-    return new (buf) instr_msrport<true>(dst, dst_size);
+    if (is_paged) {
+      return new (buf) instr_msrport<true, true>(dst, dst_size);
+    } else {
+      return new (buf) instr_msrport<true, false>(dst, dst_size);
+    }
   } else {
-    return new (buf) instr_msrport<false>(dst, dst_size);
+    if (is_paged) {
+      return new (buf) instr_msrport<false, true>(dst, dst_size);
+    } else {
+      return new (buf) instr_msrport<false, false>(dst, dst_size);
+    }
   }
 }
 
@@ -1265,7 +1559,7 @@ instr_msrport_base* instr_msrport_base::create(msrportimpl* node, data_map_t& ma
 class instr_mwport_base : public instr_mport_base {
 public:
 
-  static instr_mwport_base* create(mwportimpl* node, data_map_t& map) ;
+  static instr_mwport_base* create(mwportimpl* node, data_map_t& map, instr_arena& arena) ;
 
 protected:
 
@@ -1292,13 +1586,16 @@ protected:
   uint32_t enable_size_;
 };
 
-template <bool is_scalar>
+template <bool is_scalar, bool is_paged>
 class instr_mwport : public instr_mwport_base {
 public:
 
   void destroy() override {
     this->~instr_mwport();
-    ::operator delete [](this);
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_mwport>;
   }
 
   void eval() override {
@@ -1306,6 +1603,13 @@ public:
      || (enable_ && bv_is_zero(enable_, enable_size_)))
       return;
     auto addr = bv_cast<uint32_t>(addr_, addr_size_);
+    block_type* store;
+    if constexpr (is_paged) {
+      store = pages_->write_page(addr >> page_shift_);
+      addr &= page_mask_;
+    } else {
+      store = store_;
+    }
     auto dst_offset = addr * data_size_;
     auto dst_idx = dst_offset / bitwidth_v<block_type>;
     auto dst_lsb = dst_offset % bitwidth_v<block_type>;
@@ -1335,9 +1639,9 @@ public:
       }
 
       if constexpr (is_scalar) {
-        bv_slice_vector_small(rdata, data_size_, store_ + dst_idx, dst_lsb);
+        bv_slice_vector_small(rdata, data_size_, store + dst_idx, dst_lsb);
       } else {
-        bv_slice_vector(rdata, data_size_, store_ + dst_idx, dst_lsb);
+        bv_slice_vector(rdata, data_size_, store + dst_idx, dst_lsb);
       }
 
       bv_blend<false, block_type, ClearBitAccessor<block_type>>(
@@ -1345,9 +1649,9 @@ public:
     }
 
     if constexpr (is_scalar) {
-      bv_copy_vector_small(store_ + dst_idx, dst_lsb, wdata, 0, data_size_);
+      bv_copy_vector_small(store + dst_idx, dst_lsb, wdata, 0, data_size_);
     } else {
-      bv_copy_vector(store_ + dst_idx, dst_lsb, wdata, 0, data_size_);
+      bv_copy_vector(store + dst_idx, dst_lsb, wdata, 0, data_size_);
     }
   }
 
@@ -1358,15 +1662,24 @@ private:
   friend class instr_mwport_base;
 };
 
-instr_mwport_base* instr_mwport_base::create(mwportimpl* node, data_map_t& map) {
-  auto buf = new uint8_t[__aligned_sizeof(instr_mwport_base)]();
+instr_mwport_base* instr_mwport_base::create(mwportimpl* node, data_map_t& map, instr_arena& arena) {
+  auto buf = arena.alloc(__aligned_sizeof(instr_mwport_base));
   auto data_size = node->mem()->data_width();
   auto is_scalar = (data_size <= bitwidth_v<block_type>);
+  auto is_paged = mem_pages::is_paged(node->mem());
   instr_mwport_base* instr;
   if (is_scalar) {
-    instr = new (buf) instr_mwport<true>(data_size);
+    if (is_paged) {
+      instr = new (buf) instr_mwport<true, true>(data_size);
+    } else {
+      instr = new (buf) instr_mwport<true, false>(data_size);
+    }
   } else {
-    instr = new (buf) instr_mwport<false>(data_size);
+    if (is_paged) {
+      instr = new (buf) instr_mwport<false, true>(data_size);
+    } else {
+      instr = new (buf) instr_mwport<false, false>(data_size);
+    }
   }
   instr->init(node, map);
   return instr;
@@ -1377,18 +1690,31 @@ instr_mwport_base* instr_mwport_base::create(mwportimpl* node, data_map_t& map)
 class instr_time : public instr_base {
 public:
 
-  static instr_time* create(timeimpl* node, data_map_t& map) {
-    return new instr_time(node, map);
+  static instr_time* create(timeimpl* node, data_map_t& map, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_time))) instr_time(node, map);
   }
 
   void destroy() override {
-    delete this;
+    this->~instr_time();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_time>;
   }
 
   void eval() override {
     dst_ = ++tick_;
   }
 
+  void save(std::ostream& out) const override {
+    save_state(out, &tick_);
+  }
+
+  void restore(std::istream& in) override {
+    restore_state(in, &tick_);
+    dst_ = tick_;
+  }
+
 private:
 
   ch_tick tick_;
@@ -1406,12 +1732,16 @@ private:
 class instr_assert : public instr_base {
 public:
 
-  static instr_assert* create(assertimpl* node, data_map_t& map) {
-    return new instr_assert(node, map);
+  static instr_assert* create(assertimpl* node, data_map_t& map, print_logger* logger, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_assert))) instr_assert(node, map, logger);
   }
 
   void destroy() override {
-    delete this;
+    this->~instr_assert();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_assert>;
   }
 
   void eval() override {
@@ -1419,6 +1749,9 @@ public:
       || static_cast<bool>(cond_[0]))
       return;
     auto tick = bv_cast<uint64_t>(time_, 64);
+    if (logger_) {
+      logger_->flush();
+    }
     throw std::domain_error(sstreamf() << "assertion failure at tick " 
                                        << tick << ", " 
                                        << message_ << "(" 
@@ -1427,12 +1760,13 @@ public:
 
 private:
 
-  instr_assert(assertimpl* node, data_map_t& map)
+  instr_assert(assertimpl* node, data_map_t& map, print_logger* logger)
     : cond_(map.at(node->cond().id()))
     , time_(map.at(node->time().id()))
     , pred_(node->has_pred() ? map.at(node->pred().id()) : nullptr)
     , message_(node->message())
     , sloc_(node->sloc())
+    , logger_(logger)
   {}
 
   const block_type* cond_;
@@ -1440,6 +1774,7 @@ private:
   const block_type* pred_;
   std::string message_;
   source_info sloc_;
+  print_logger* logger_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1447,27 +1782,37 @@ private:
 class instr_print : public instr_base {
 public:
 
-  static instr_print* create(printimpl* node, data_map_t& map) {
-    return new instr_print(node, map);
+  static instr_print* create(printimpl* node, data_map_t& map, print_logger* logger, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_print))) instr_print(node, map, logger);
   }
 
   void destroy() override {
-    delete this;
+    this->~instr_print();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_print>;
   }
 
   void eval() override {
     if (pred_ && !static_cast<bool>(pred_[0]))
       return;
+    if (logger_) {
+      logger_->log(format_id_, srcs_.data());
+      return;
+    }
     auto str = to_string(format_.c_str(), srcs_.data(), enum_strings_.data());
     std::cout << str;
   }
 
 private:
 
-  instr_print(printimpl* node, data_map_t& map)
+  instr_print(printimpl* node, data_map_t& map, print_logger* logger)
     : enum_strings_(node->enum_strings())
     , pred_(node->has_pred() ? map.at(node->pred().id()) : nullptr)
-    , format_(node->format()) {
+    , format_(node->format())
+    , logger_(logger)
+    , format_id_(logger ? logger->add_format(node) : 0) {
     srcs_.resize(node->enum_strings().size());
     for (uint32_t i = (pred_ ? 1 : 0), j = 0, n = node->num_srcs(); i < n; ++i, ++j) {
       auto src = node->src(i).impl();
@@ -1485,6 +1830,8 @@ private:
   std::vector<sdata_type> srcs_;
   const block_type* pred_;
   std::string format_;
+  print_logger* logger_;
+  uint32_t format_id_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1492,27 +1839,33 @@ private:
 class instr_udfc : public instr_base {
 public:
 
-  static instr_udfc* create(udfcimpl* node) {
-    return new instr_udfc(node);
+  static instr_udfc* create(udfcimpl* node, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_udfc))) instr_udfc(node);
   }
 
   void destroy() override {
-    delete this;
+    this->~instr_udfc();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_udfc>;
   }
 
   void eval() override {
-    udf_->eval();
+    eval_fn_(udf_);
   }
 
 private:
 
   instr_udfc(udfcimpl* node)
     : udf_(node->udf())
+    , eval_fn_(udf_->eval_fn())
   {}
 
   ~instr_udfc() {}
 
   udf_iface* udf_;
+  udf_iface::eval_fn_t eval_fn_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1520,8 +1873,8 @@ private:
 class instr_udfs : public instr_base {
 public:
 
-  static instr_udfs* create(udfsimpl* node) {
-    return new instr_udfs(node);
+  static instr_udfs* create(udfsimpl* node, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_udfs))) instr_udfs(node);
   }
 
   void init(udfsimpl* node, data_map_t& map) {
@@ -1530,7 +1883,11 @@ public:
   }
 
   void destroy() override {
-    delete this;
+    this->~instr_udfs();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_udfs>;
   }
 
   void eval() override {
@@ -1539,7 +1896,7 @@ public:
     if (static_cast<bool>(reset_[0])) {
       udf_->reset();
     } else {
-      udf_->eval();
+      eval_fn_(udf_);
     }
   }
 
@@ -1549,6 +1906,7 @@ private:
     : cd_(nullptr)
     , reset_(nullptr)
     , udf_(node->udf())
+    , eval_fn_(udf_->eval_fn())
   {}
 
   ~instr_udfs() {}
@@ -1556,6 +1914,7 @@ private:
   const block_type* cd_;
   const block_type* reset_;
   udf_iface* udf_;
+  udf_iface::eval_fn_t eval_fn_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1563,7 +1922,7 @@ private:
 class instr_udfin_base : public instr_base {
 public:
 
-  static instr_udfin_base* create(udfportimpl* node, data_map_t& map);
+  static instr_udfin_base* create(udfportimpl* node, block_type* dst, data_map_t& map, instr_arena& arena);
 
 protected:
 
@@ -1583,7 +1942,11 @@ class instr_udfin : public instr_udfin_base {
 public:
 
   void destroy() override {
-    delete this;
+    this->~instr_udfin();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_udfin>;
   }
 
   void eval() override {
@@ -1603,23 +1966,279 @@ private:
   friend class instr_udfin_base;
 };
 
-instr_udfin_base* instr_udfin_base::create(udfportimpl* node, data_map_t& map) {
-  auto dst  = node->value()->words();
+instr_udfin_base* instr_udfin_base::create(udfportimpl* node, block_type* dst, data_map_t& map, instr_arena& arena) {
   auto src  = map.at(node->src(0).id());
   auto size = node->size();
+  auto buf  = arena.alloc(__aligned_sizeof(instr_udfin<false>));
   if (size <= bitwidth_v<block_type>) {
-    return new instr_udfin<true>(dst, src, size);
+    return new (buf) instr_udfin<true>(dst, src, size);
   } else {
-    return new instr_udfin<false>(dst, src, size);
+    return new (buf) instr_udfin<false>(dst, src, size);
   }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+class instr_cover : public instr_base {
+public:
+
+  static instr_cover* create(coverimpl* node, data_map_t& map, instr_arena& arena) {
+    return new (arena.alloc(__aligned_sizeof(instr_cover))) instr_cover(node, map);
+  }
+
+  void destroy() override {
+    this->~instr_cover();
+  }
+
+  handler_t handler() const override {
+    return &dispatch_one<instr_cover>;
+  }
+
+  void eval() override {
+    if (!static_cast<bool>(cd_[0])
+     || (pred_ && !static_cast<bool>(pred_[0])))
+      return;
+
+    // collect the matching bins of each point
+    for (auto& point : points_) {
+      auto value = bv_cast<uint64_t>(point.src, point.size);
+      point.matches.clear();
+      for (uint32_t i = 0, n = point.bins.size(); i < n; ++i) {
+        auto& bin = point.bins[i];
+        bool match;
+        if (bin.is_transition) {
+          match = has_prev_
+               && point.prev >= bin.lo && point.prev <= bin.hi
+               && value >= bin.to_lo && value <= bin.to_hi;
+        } else {
+          match = (value >= bin.lo && value <= bin.hi);
+        }
+        if (match) {
+          point.matches.push_back(i);
+        }
+      }
+      point.prev = value;
+    }
+    has_prev_ = true;
+
+    this->count(0, 0);
+  }
+
+  const uint64_t* counters() const {
+    return counters_.data();
+  }
+
+  void save(std::ostream& out) const override {
+    save_state(out, counters_.data(), counters_.size());
+    save_state(out, &has_prev_);
+    for (auto& point : points_) {
+      save_state(out, &point.prev);
+    }
+  }
+
+  void restore(std::istream& in) override {
+    restore_state(in, counters_.data(), counters_.size());
+    restore_state(in, &has_prev_);
+    for (auto& point : points_) {
+      restore_state(in, &point.prev);
+    }
+  }
+
+private:
+
+  struct point_t {
+    const block_type* src;
+    uint32_t size;
+    std::vector<ch_bin> bins;
+    std::vector<uint32_t> matches;
+    uint64_t prev;
+  };
+
+  instr_cover(coverimpl* node, data_map_t& map)
+    : cd_(map.at(node->cd().id()))
+    , pred_(node->has_pred() ? map.at(node->pred().id()) : nullptr)
+    , counters_(node->num_counters(), 0)
+    , has_prev_(false) {
+    for (uint32_t i = 0, n = node->num_points(); i < n; ++i) {
+      auto& value = node->value(i);
+      points_.push_back({map.at(value.id()), value.size(), node->bins(i), {}, 0});
+    }
+  }
+
+  void count(uint32_t point_idx, uint32_t index) {
+    if (point_idx == points_.size()) {
+      ++counters_[index];
+      return;
+    }
+    auto& point = points_[point_idx];
+    for (auto i : point.matches) {
+      this->count(point_idx + 1, index * point.bins.size() + i);
+    }
+  }
+
+  const block_type* cd_;
+  const block_type* pred_;
+  std::vector<point_t> points_;
+  std::vector<uint64_t> counters_;
+  bool has_prev_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// activity-driven evaluation: instructions are only evaluated when one of
+// their sources changed since their last evaluation, sequential and side-effect
+// instructions are always evaluated.
+class activity_t {
+public:
+
+  // fall back to full evaluation for a window when more than
+  // threshold percent of the combinational instructions are active.
+  static constexpr uint32_t window    = 64;
+  static constexpr uint32_t threshold = 50;
+
+  activity_t(uint32_t num_dynamic)
+    : num_dynamic_(num_dynamic)
+    , window_evals_(0)
+    , window_active_(0)
+    , full_evals_(0)
+    , resync_(true)
+  {}
+
+  uint32_t add_signal(const block_type* data, uint32_t size) {
+    signal_t signal;
+    signal.data   = data;
+    signal.shadow = shadows_.size();
+    signal.words  = ceildiv(size, bitwidth_v<block_type>);
+    signal.fanout_begin = 0;
+    signal.fanout_end   = 0;
+    shadows_.resize(shadows_.size() + signal.words);
+    signals_.push_back(signal);
+    return signals_.size() - 1;
+  }
+
+  void add_input(uint32_t signal) {
+    inputs_.push_back(signal);
+  }
+
+  void add_instr(int32_t signal, bool always) {
+    instrs_.push_back({signal, always});
+  }
+
+  void set_fanouts(const std::vector<std::vector<uint32_t>>& fanouts) {
+    for (uint32_t i = 0, n = signals_.size(); i < n; ++i) {
+      auto& signal = signals_[i];
+      signal.fanout_begin = fanouts_.size();
+      fanouts_.insert(fanouts_.end(), fanouts[i].begin(), fanouts[i].end());
+      signal.fanout_end = fanouts_.size();
+    }
+    dirty_.resize(instrs_.size(), 0);
+  }
+
+  void invalidate() {
+    full_evals_ = 0;
+    resync_ = true;
+  }
+
+  void eval(const std::vector<instr_base*>& instrs) {
+    if (full_evals_) {
+      for (auto instr : instrs) {
+        instr->eval();
+      }
+      if (0 == --full_evals_) {
+        resync_ = true;
+      }
+      return;
+    }
+
+    bool force = resync_;
+    if (force) {
+      // shadows may be stale, evaluate everything against the current values
+      for (auto& signal : signals_) {
+        std::copy_n(signal.data, signal.words, shadows_.data() + signal.shadow);
+      }
+      resync_ = false;
+    } else {
+      for (auto input : inputs_) {
+        this->update(signals_[input]);
+      }
+    }
+
+    uint32_t active = 0;
+    for (uint32_t i = 0, n = instrs.size(); i < n; ++i) {
+      auto& instr = instrs_[i];
+      if (!force && !instr.always && !dirty_[i])
+        continue;
+      dirty_[i] = 0;
+      instrs[i]->eval();
+      active += !instr.always;
+      if (instr.signal >= 0) {
+        this->update(signals_[instr.signal]);
+      }
+    }
+
+    window_active_ += active;
+    if (++window_evals_ == window) {
+      if (window_active_ * 100 > uint64_t(threshold) * window * num_dynamic_) {
+        full_evals_ = window;
+      }
+      window_evals_ = 0;
+      window_active_ = 0;
+    }
+  }
+
+private:
+
+  struct signal_t {
+    const block_type* data;
+    uint32_t shadow;
+    uint32_t words;
+    uint32_t fanout_begin;
+    uint32_t fanout_end;
+  };
+
+  struct instr_t {
+    int32_t signal;
+    bool always;
+  };
+
+  // propagate a new signal value to its readers
+  void update(const signal_t& signal) {
+    auto shadow = shadows_.data() + signal.shadow;
+    if (1 == signal.words) {
+      if (shadow[0] == signal.data[0])
+        return;
+      shadow[0] = signal.data[0];
+    } else {
+      if (std::equal(signal.data, signal.data + signal.words, shadow))
+        return;
+      std::copy_n(signal.data, signal.words, shadow);
+    }
+    for (auto i = signal.fanout_begin; i < signal.fanout_end; ++i) {
+      dirty_[fanouts_[i]] = 1;
+    }
+  }
+
+  std::vector<signal_t> signals_;
+  std::vector<uint32_t> inputs_;
+  std::vector<instr_t>  instrs_;
+  std::vector<uint32_t> fanouts_;
+  std::vector<uint8_t>  dirty_;
+  std::vector<block_type> shadows_;
+  uint32_t num_dynamic_;
+  uint32_t window_evals_;
+  uint64_t window_active_;
+  uint32_t full_evals_;
+  bool resync_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 struct sim_ctx_t {
-  sim_ctx_t() {}
+  sim_ctx_t() : logger(nullptr), activity(nullptr) {}
 
   ~sim_ctx_t() {
+    delete activity;
+    delete logger;
     for (auto instr : instrs) {
       instr->destroy();
     }
@@ -1629,14 +2248,27 @@ struct sim_ctx_t {
   }
 
   std::vector<std::pair<block_type*, uint32_t>> constants;
+  instr_arena arena;
   std::vector<instr_base*> instrs;
+  // threaded code split into blocks ending with an exit entry,
+  // bounding the handler call depth in unoptimized builds.
+  std::vector<dispatch_t> stream;
+  std::vector<uint32_t> blocks;
+  std::unordered_map<uint32_t, instr_cover*> covers;
+  // memory stores, paged memories map to their page table
+  std::unordered_map<uint32_t, std::pair<block_type*, mem_pages*>> mems;
+  print_logger* logger;
+  activity_t* activity;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class Compiler {
 public:
-  Compiler(sim_ctx_t* ctx) : sim_ctx_(ctx) {}
+  Compiler(sim_ctx_t* ctx, const port_map_t& ports)
+    : sim_ctx_(ctx)
+    , ports_(ports)
+  {}
 
   ~Compiler() {}
 
@@ -1650,25 +2282,32 @@ public:
 
     auto ctx = eval_list.back()->ctx();
 
+    // setup deferred print logging
+    if ((platform::self().cflags() & ch_flags::deferred_print) != 0
+     && std::any_of(ctx->gtaps().begin(), ctx->gtaps().end(),
+                    [](lnodeimpl* node) { return type_print == node->type(); })) {
+      sim_ctx_->logger = new print_logger();
+    }
+
     // setup constants
     this->setup_constants(ctx, data_map);
 
     auto sys_time = ctx->sys_time();
     if (sys_time) {
-      instr_map[sys_time->id()] = instr_time::create(reinterpret_cast<timeimpl*>(sys_time), data_map);
+      instr_map[sys_time->id()] = instr_time::create(reinterpret_cast<timeimpl*>(sys_time), data_map, sim_ctx_->arena);
     }
 
     // lower synchronous nodes
     for (auto node : ctx->snodes()) {
       switch (node->type()) {
       case type_reg:
-        instr_map[node->id()] = instr_reg_base::create(reinterpret_cast<regimpl*>(node), data_map);
+        instr_map[node->id()] = instr_reg_base::create(reinterpret_cast<regimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_msrport:
-        instr_map[node->id()] = instr_msrport_base::create(reinterpret_cast<msrportimpl*>(node), data_map);
+        instr_map[node->id()] = instr_msrport_base::create(reinterpret_cast<msrportimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_udfs:
-        instr_map[node->id()] = instr_udfs::create(reinterpret_cast<udfsimpl*>(node));
+        instr_map[node->id()] = instr_udfs::create(reinterpret_cast<udfsimpl*>(node), sim_ctx_->arena);
         break;
       default:
         break;
@@ -1682,54 +2321,60 @@ public:
       default:
         assert(false);
       case type_proxy:
-        instr = instr_proxy_base::create(reinterpret_cast<proxyimpl*>(node), data_map);
+        instr = instr_proxy_base::create(reinterpret_cast<proxyimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_input: {
         auto input = reinterpret_cast<inputimpl*>(node);
-        data_map[node->id()] = input->value()->words();
+        data_map[node->id()] = this->port_data(input);
       } break;
       case type_output: {
         auto output = reinterpret_cast<outputimpl*>(node);
         data_map[node->id()] = data_map.at(output->src(0).id());
-        instr = instr_output_base::create(output, data_map);
+        instr = instr_output_base::create(output, this->port_data(output), data_map, sim_ctx_->arena);
       } break;
       case type_op:
-        instr = instr_op_base::create(reinterpret_cast<opimpl*>(node), data_map);
+        instr = instr_op_base::create(reinterpret_cast<opimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_sel:
-        instr = instr_select_base::create(reinterpret_cast<selectimpl*>(node), data_map);
+        instr = instr_select_base::create(reinterpret_cast<selectimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_cd:
-        instr = instr_cd::create(reinterpret_cast<cdimpl*>(node), data_map);
+        instr = instr_cd::create(reinterpret_cast<cdimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_reg:
         instr = instr_map.at(node->id());
         reinterpret_cast<instr_reg_base*>(instr)->init(reinterpret_cast<regimpl*>(node), data_map);
         break;
       case type_marport:
-        instr = instr_marport_base::create(reinterpret_cast<marportimpl*>(node), data_map);
+        instr = instr_marport_base::create(reinterpret_cast<marportimpl*>(node), data_map, sim_ctx_->arena);
         break;
       case type_msrport:
         instr = instr_map.at(node->id());
         reinterpret_cast<instr_msrport_base*>(instr)->init(reinterpret_cast<msrportimpl*>(node), data_map);
         break;        
       case type_mwport:
-        instr = instr_mwport_base::create(reinterpret_cast<mwportimpl*>(node), data_map);
-        break;
-      case type_tap:
-        instr = instr_output_base::create(reinterpret_cast<tapimpl*>(node), data_map);
+        instr = instr_mwport_base::create(reinterpret_cast<mwportimpl*>(node), data_map, sim_ctx_->arena);
         break;
+      case type_tap: {
+        auto tap = reinterpret_cast<tapimpl*>(node);
+        instr = instr_output_base::create(tap, this->port_data(tap), data_map, sim_ctx_->arena);
+      } break;
       case type_time:
         instr = instr_map.at(node->id());
         break;
       case type_assert:
-        instr = instr_assert::create(reinterpret_cast<assertimpl*>(node), data_map);
+        instr = instr_assert::create(reinterpret_cast<assertimpl*>(node), data_map, sim_ctx_->logger, sim_ctx_->arena);
         break;
       case type_print:
-        instr = instr_print::create(reinterpret_cast<printimpl*>(node), data_map);
+        instr = instr_print::create(reinterpret_cast<printimpl*>(node), data_map, sim_ctx_->logger, sim_ctx_->arena);
         break;
+      case type_cover: {
+        auto cover = instr_cover::create(reinterpret_cast<coverimpl*>(node), data_map, sim_ctx_->arena);
+        sim_ctx_->covers[node->id()] = cover;
+        instr = cover;
+      } break;
       case type_udfc:
-        instr = instr_udfc::create(reinterpret_cast<udfcimpl*>(node));
+        instr = instr_udfc::create(reinterpret_cast<udfcimpl*>(node), sim_ctx_->arena);
         break;
       case type_udfs:
         instr = instr_map.at(node->id());
@@ -1738,11 +2383,11 @@ public:
       case type_udfin: {
         auto udfin = reinterpret_cast<udfportimpl*>(node);
         data_map[node->id()] = data_map.at(udfin->src(0).id());
-        instr = instr_udfin_base::create(udfin, data_map);
+        instr = instr_udfin_base::create(udfin, this->port_data(udfin), data_map, sim_ctx_->arena);
       } break;
       case type_udfout: {
         auto udfout = reinterpret_cast<udfportimpl*>(node);
-        data_map[node->id()] = udfout->value()->words();
+        data_map[node->id()] = this->port_data(udfout);
       } break;
       case type_lit:
       case type_mem:
@@ -1755,10 +2400,171 @@ public:
         sim_ctx_->instrs.emplace_back(instr);
       }
     }
+
+    // lower into threaded code
+    this->build_stream();
+
+    // register memory stores for backdoor accesses
+    for (auto node : eval_list) {
+      if (type_mem != node->type())
+        continue;
+      auto it = data_map.find(node->id());
+      if (it == data_map.end())
+        continue;
+      auto data = const_cast<block_type*>(it->second);
+      if (mem_pages::is_paged(reinterpret_cast<memimpl*>(node))) {
+        sim_ctx_->mems[node->id()] = {nullptr, reinterpret_cast<mem_pages*>(data)};
+      } else {
+        sim_ctx_->mems[node->id()] = {data, nullptr};
+      }
+    }
+
+    // setup activity-driven evaluation
+    if ((platform::self().cflags() & ch_flags::activity_sim) != 0
+     && ctx->udfs().empty()) {
+      this->setup_activity(eval_list, node_map, data_map);
+    }
   }
 
 private:
 
+  static constexpr uint32_t max_block_size = 256;
+
+  void build_stream() {
+    auto& instrs = sim_ctx_->instrs;
+    auto& stream = sim_ctx_->stream;
+    auto& blocks = sim_ctx_->blocks;
+    stream.reserve(instrs.size() + instrs.size() / max_block_size + 1);
+    blocks.push_back(0);
+    uint32_t block_size = 0;
+    for (uint32_t i = 0, n = instrs.size(); i < n;) {
+      if (block_size + 1 >= max_block_size) {
+        stream.push_back({&dispatch_exit, nullptr});
+        blocks.push_back(stream.size());
+        block_size = 0;
+      }
+      auto instr = instrs[i];
+      auto fused = (i + 1 < n) ? instr->fuse(instrs[i + 1]) : nullptr;
+      if (fused) {
+        // the second entry is skipped by the fused handler
+        stream.push_back({fused, instr});
+        stream.push_back({instrs[i + 1]->handler(), instrs[i + 1]});
+        block_size += 2;
+        i += 2;
+      } else {
+        stream.push_back({instr->handler(), instr});
+        block_size += 1;
+        i += 1;
+      }
+    }
+    stream.push_back({&dispatch_exit, nullptr});
+  }
+
+  void setup_activity(const std::vector<lnodeimpl*>& eval_list,
+                      const node_map_t& node_map,
+                      const data_map_t& data_map) {
+    auto is_dynamic = [](lnodeimpl* node) {
+      switch (node->type()) {
+      case type_op:
+      case type_sel:
+      case type_proxy:
+      case type_output:
+      case type_tap:
+        return true;
+      default:
+        return false;
+      }
+    };
+
+    auto is_observed = [](lnodeimpl* node) {
+      switch (node->type()) {
+      case type_op:
+      case type_sel:
+      case type_proxy:
+      case type_cd:
+      case type_reg:
+      case type_marport:
+      case type_msrport:
+      case type_time:
+        return true;
+      default:
+        return false;
+      }
+    };
+
+    // the eval list may contain the same node more than once
+    std::unordered_map<uint32_t, lnodeimpl*> nodes;
+    for (auto node : eval_list) {
+      nodes[node->id()] = node;
+    }
+
+    uint32_t num_instrs = sim_ctx_->instrs.size();
+    uint32_t num_dynamic = 0;
+    for (uint32_t i = 0; i < num_instrs; ++i) {
+      num_dynamic += is_dynamic(nodes.at(node_map.at(i)));
+    }
+    if (0 == num_dynamic)
+      return;
+
+    auto activity = new activity_t(num_dynamic);
+
+    // create signals for inputs and observed instruction outputs
+    node_map_t signals;
+    for (auto node : eval_list) {
+      if (type_input == node->type()
+       && 0 == signals.count(node->id())) {
+        auto signal = activity->add_signal(data_map.at(node->id()), node->size());
+        signals[node->id()] = signal;
+        activity->add_input(signal);
+      }
+    }
+    for (uint32_t i = 0; i < num_instrs; ++i) {
+      auto node = nodes.at(node_map.at(i));
+      int32_t signal = -1;
+      if (is_observed(node)) {
+        auto it = signals.find(node->id());
+        if (it != signals.end()) {
+          signal = it->second;
+        } else {
+          signal = activity->add_signal(data_map.at(node->id()), node->size());
+          signals[node->id()] = signal;
+        }
+      }
+      activity->add_instr(signal, !is_dynamic(node));
+    }
+
+    // register combinational instructions as readers of their sources
+    std::vector<std::vector<uint32_t>> fanouts(signals.size());
+    for (uint32_t i = 0; i < num_instrs; ++i) {
+      auto node = nodes.at(node_map.at(i));
+      if (!is_dynamic(node))
+        continue;
+      for (auto& src : node->srcs()) {
+        auto impl = src.impl();
+        while (type_output == impl->type()
+            || type_udfin == impl->type()) {
+          impl = impl->src(0).impl();
+        }
+        auto it = signals.find(impl->id());
+        if (it == signals.end())
+          continue;
+        auto& readers = fanouts[it->second];
+        if (readers.empty() || readers.back() != i) {
+          readers.push_back(i);
+        }
+      }
+    }
+
+    activity->set_fanouts(fanouts);
+    sim_ctx_->activity = activity;
+  }
+
+  block_type* port_data(ioportimpl* node) const {
+    auto words = node->value()->words();
+    auto it = ports_.find(words);
+    return (it != ports_.end()) ? it->second : words;
+  }
+
   void setup_constants(context* ctx, data_map_t& data_map) {
     for (auto node : ctx->literals())  {
       auto lit = reinterpret_cast<litimpl*>(node);
@@ -1799,6 +2605,7 @@ private:
   }
 
   sim_ctx_t* sim_ctx_;
+  const port_map_t& ports_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1812,14 +2619,89 @@ driver::~driver() {
 }
 
 void driver::initialize(const std::vector<lnodeimpl*>& eval_list) {
-  Compiler compiler(sim_ctx_);
+  eval_list_ = eval_list;
+  Compiler compiler(sim_ctx_, ports_);
   compiler.build(eval_list);
 }
 
-void driver::eval() {
+bool driver::eval() {
+  if (sim_ctx_->activity) {
+    sim_ctx_->activity->eval(sim_ctx_->instrs);
+    return false;
+  }
+  auto stream = sim_ctx_->stream.data();
+  for (auto block : sim_ctx_->blocks) {
+    auto entry = stream + block;
+    entry->handler(entry);
+  }
+  return false;
+}
+
+const uint64_t* driver::coverage(lnodeimpl* node) const {
+  return sim_ctx_->covers.at(node->id())->counters();
+}
+
+uint64_t driver::state_size() const {
+  // approximated by the value buffers of the scheduled nodes
+  uint64_t size = 0;
+  for (auto node : eval_list_) {
+    size += ceildiv<uint64_t>(node->size(), bitwidth_v<block_type>) * sizeof(block_type);
+  }
+  return size;
+}
+
+void driver::save(std::ostream& out) const {
+  for (auto instr : sim_ctx_->instrs) {
+    instr->save(out);
+  }
+}
+
+void driver::restore(std::istream& in) {
   for (auto instr : sim_ctx_->instrs) {
-    instr->eval();
+    instr->restore(in);
+  }
+  if (sim_ctx_->activity) {
+    sim_ctx_->activity->invalidate();
+  }
+}
+
+void driver::read_mem(memimpl* mem, uint64_t offset, block_type* dst, uint32_t length) const {
+  auto& store = sim_ctx_->mems.at(mem->id());
+  if (store.second) {
+    store.second->read(offset, dst, length);
+  } else {
+    bv_copy(dst, 0, store.first, uint32_t(offset), length);
   }
 }
 
+void driver::write_mem(memimpl* mem, uint64_t offset, const block_type* src, uint32_t length) {
+  auto& store = sim_ctx_->mems.at(mem->id());
+  if (store.second) {
+    store.second->write(offset, src, length);
+  } else {
+    bv_copy(store.first, uint32_t(offset), src, 0, length);
+  }
+  if (sim_ctx_->activity) {
+    sim_ctx_->activity->invalidate();
+  }
+}
+
+sim_driver* driver::fork(const port_map_t& ports) const {
+  // instructions bind buffers directly, lower the design again
+  // against the fork's ports and transfer the sequential state.
+  auto other = new driver();
+  for (auto& port : ports_) {
+    other->ports_[port.first] = ports.at(port.second);
+  }
+  if (ports_.empty()) {
+    other->ports_ = ports;
+  }
+  other->initialize(eval_list_);
+
+  std::stringstream state;
+  this->save(state);
+  other->restore(state);
+  return other;
+}
+
 }
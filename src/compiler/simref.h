@@ -15,11 +15,27 @@ public:
 
   void initialize(const std::vector<lnodeimpl*>& eval_list) override;
 
-  void eval() override;
+  bool eval() override;
+
+  const uint64_t* coverage(lnodeimpl* node) const override;
+
+  uint64_t state_size() const override;
+
+  void save(std::ostream& out) const override;
+
+  void restore(std::istream& in) override;
+
+  void read_mem(memimpl* mem, uint64_t offset, block_type* dst, uint32_t length) const override;
+
+  void write_mem(memimpl* mem, uint64_t offset, const block_type* src, uint32_t length) override;
+
+  sim_driver* fork(const port_map_t& ports) const override;
 
 private:  
 
   sim_ctx_t* sim_ctx_;
+  std::vector<lnodeimpl*> eval_list_;
+  port_map_t ports_;
 };
 
 }
@@ -225,6 +225,7 @@ void context::add_node(lnodeimpl* node) {
     break;
   case type_assert:
   case type_print:
+  case type_cover:
   case type_time:
     gtaps_.push_back(node);
     break;
@@ -311,6 +312,7 @@ void context::delete_node(lnodeimpl* node) {
   case type_time:
   case type_assert:
   case type_print:
+  case type_cover:
     gtaps_.remove(node);
     break;
   case type_udfc:
@@ -657,7 +659,7 @@ void context::dump_stats(std::ostream& out) {
         ++num_registers;
         break;
       case type_mem:
-        memories_bits += node->size();
+        memories_bits += reinterpret_cast<memimpl*>(node)->bit_size();
         ++num_memories;
         break;
       case type_lit:
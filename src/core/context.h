@@ -43,6 +43,27 @@ typedef std::unordered_map<uint32_t, enum_string_cb> enum_strings_t;
 
 typedef std::stack<std::pair<cdimpl*, lnodeimpl*>> cd_stack_t;
 
+// build phase statistics, times are in seconds
+struct build_stats_t {
+  double elaboration_time = 0;
+  double optimize_time = 0;
+  double eval_list_time = 0;
+  double compile_time = 0;
+  uint64_t eval_nodes = 0;
+  // nodes deleted by each optimization pass
+  std::vector<std::pair<const char*, uint64_t>> passes;
+
+  void add_pass(const char* name, uint64_t deleted) {
+    for (auto& pass : passes) {
+      if (0 == strcmp(pass.first, name)) {
+        pass.second += deleted;
+        return;
+      }
+    }
+    passes.emplace_back(name, deleted);
+  }
+};
+
 class context : public refcounted {
 public:
 
@@ -138,6 +159,14 @@ public:
     return modules_;
   }
 
+  auto& build_stats() const {
+    return build_stats_;
+  }
+
+  auto& build_stats() {
+    return build_stats_;
+  }
+
   auto& cdomains() const {
     return cdomains_;
   }
@@ -315,6 +344,7 @@ protected:
   enum_strings_t enum_strings_;
   cd_stack_t     cd_stack_;  
   std::list<lnodeimpl*> ext_nodes_;
+  build_stats_t  build_stats_;
 };
 
 std::pair<context*, bool> ctx_create(const std::type_index& signature,
@@ -40,11 +40,14 @@ bool deviceimpl::begin() {
 
 void deviceimpl::begin_build() {
   ctx_->set_initialized();
+  build_timer_ = stopwatch();
 }
 
 void deviceimpl::end_build() {
  compiler compiler(ctx_);
  compiler.optimize();
+ // includes the optimization passes
+ ctx_->build_stats().elaboration_time = build_timer_.elapsed();
 }
 
 void deviceimpl::end(const std::string& name, const source_location& sloc) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.h"
+#include "platform.h"
 
 namespace ch {
 namespace internal {
@@ -37,6 +38,7 @@ protected:
   context* old_ctx_;
   bool is_opened_;
   uint32_t instance_;
+  stopwatch build_timer_;
 };
 
 }
@@ -27,6 +27,7 @@
   m(time) \
   m(assert) \
   m(print) \
+  m(cover) \
   m(udfc) \
   m(udfs) \
   m(udfin) \
@@ -0,0 +1,28 @@
+#include "mappedfile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ch::internal;
+
+mapped_file::mapped_file(const std::string& file, bool writable) {
+  auto fd = ::open(file.c_str(), writable ? O_RDWR : O_RDONLY);
+  CH_CHECK(fd >= 0, "couldn't open file '%s'", file.c_str());
+  struct stat st;
+  bool valid = (0 == ::fstat(fd, &st) && st.st_size != 0);
+  if (!valid) {
+    ::close(fd);
+  }
+  CH_CHECK(valid, "couldn't read file '%s'", file.c_str());
+  size_ = static_cast<size_t>(st.st_size);
+  auto data = writable ? ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                       : ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  CH_CHECK(data != MAP_FAILED, "couldn't map file '%s'", file.c_str());
+  data_ = reinterpret_cast<uint8_t*>(data);
+}
+
+mapped_file::~mapped_file() {
+  ::munmap(data_, size_);
+}
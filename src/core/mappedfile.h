@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common.h"
+
+namespace ch {
+namespace internal {
+
+// memory mapping of a whole file, writable mappings are shared with the file
+class mapped_file {
+public:
+
+  explicit mapped_file(const std::string& file, bool writable = false);
+
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  const uint8_t* data() const {
+    return data_;
+  }
+
+  uint8_t* data() {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+private:
+
+  uint8_t* data_;
+  size_t size_;
+};
+
+}
+}
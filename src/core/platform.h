@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cflags.h"
+#include <chrono>
 
 namespace ch {
 namespace internal {
@@ -27,5 +28,20 @@ protected:
   Impl* impl_;
 };
 
+// wall-clock timer for the build and simulation statistics
+class stopwatch {
+public:
+
+  stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+  // seconds since construction
+  double elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+protected:
+  std::chrono::steady_clock::time_point start_;
+};
+
 }
 }
@@ -158,6 +158,7 @@ std::string system_buffer_impl::to_verilog() const {
 ///////////////////////////////////////////////////////////////////////////////
 
 sdata_type ch::internal::sdata_from_fill(uint64_t value, uint32_t size, uint32_t count) {
+  CH_CHECK(uint64_t(size) * count <= std::numeric_limits<uint32_t>::max(), "fill data too large");
   sdata_type src(size, value);
   sdata_type out(size * count);
   for (uint32_t i = 0; i < count; ++i) {
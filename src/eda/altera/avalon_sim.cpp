@@ -1,4 +1,5 @@
 #include "eda/altera/avalon_sim.h"
+#include "mappedfile.h"
 
 using namespace eda::altera::avalon;
 
@@ -6,6 +7,178 @@ namespace eda {
 namespace altera {
 namespace avalon {
 
+// fixed capacity FIFO
+template <typename T>
+class ring_buffer {
+public:
+
+  ring_buffer(uint32_t capacity)
+    : buffer_(1u << log2ceil(capacity))
+    , mask_(buffer_.size() - 1)
+    , head_(0)
+    , tail_(0)
+  {}
+
+  bool empty() const {
+    return (head_ == tail_);
+  }
+
+  uint32_t size() const {
+    return (tail_ - head_);
+  }
+
+  T& front() {
+    assert(!this->empty());
+    return buffer_[head_ & mask_];
+  }
+
+  T& back() {
+    assert(!this->empty());
+    return buffer_[(tail_ - 1) & mask_];
+  }
+
+  void push_back(const T& value) {
+    assert(this->size() < buffer_.size());
+    buffer_[tail_++ & mask_] = value;
+  }
+
+  void pop_front() {
+    assert(!this->empty());
+    ++head_;
+  }
+
+private:
+
+  std::vector<T> buffer_;
+  uint32_t mask_;
+  uint32_t head_;
+  uint32_t tail_;
+};
+
+// fixed capacity FIFO of fixed size data blocks
+class block_buffer {
+public:
+
+  block_buffer(uint32_t capacity, uint32_t block_size)
+    : buffer_((1u << log2ceil(capacity)) * block_size)
+    , block_size_(block_size)
+    , mask_((1u << log2ceil(capacity)) - 1)
+    , head_(0)
+    , tail_(0)
+  {}
+
+  bool empty() const {
+    return (head_ == tail_);
+  }
+
+  const uint8_t* front() const {
+    assert(!this->empty());
+    return buffer_.data() + (head_ & mask_) * block_size_;
+  }
+
+  void push_back(const uint8_t* data) {
+    assert((tail_ - head_) <= mask_);
+    std::memcpy(buffer_.data() + (tail_++ & mask_) * block_size_, data, block_size_);
+  }
+
+  void pop_front() {
+    assert(!this->empty());
+    ++head_;
+  }
+
+private:
+
+  std::vector<uint8_t> buffer_;
+  uint32_t block_size_;
+  uint32_t mask_;
+  uint32_t head_;
+  uint32_t tail_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// open-row DRAM timing model, requests are scheduled in order
+// and bank accesses overlap until the data bus is saturated.
+class dram_model {
+public:
+
+  dram_model(const avm_dram_config& config, uint32_t data_size, avm_stats& stats)
+    : config_(config)
+    , banks_(config.num_banks)
+    , beat_cycles_(config.bus_width ? ceildiv(data_size, config.bus_width) : 0)
+    , bus_time_(0)
+    , next_refresh_(config.tREFI)
+    , refresh_end_(0)
+    , stats_(stats) {
+    CH_CHECK(config.num_banks != 0 && config.row_size != 0, "invalid DRAM configuration");
+  }
+
+  // returns the completion time of an access
+  uint64_t access(uint64_t address, uint64_t curr_time) {
+    this->refresh(curr_time);
+
+    auto row_index = address / config_.row_size;
+    auto& bank = banks_[row_index % config_.num_banks];
+    auto row = row_index / config_.num_banks;
+
+    auto start = std::max({curr_time, bank.ready_time, refresh_end_});
+    uint64_t delay = config_.tCAS;
+    if (bank.is_open && bank.row == row) {
+      ++stats_.row_hits;
+    } else {
+      if (bank.is_open) {
+        delay += config_.tRP;
+        ++stats_.row_conflicts;
+      } else {
+        ++stats_.row_misses;
+      }
+      delay += config_.tRCD;
+      bank.row = row;
+      bank.is_open = true;
+    }
+    bank.ready_time = start + delay - config_.tCAS;
+
+    auto done = start + delay;
+    if (beat_cycles_) {
+      done = std::max(done, bus_time_) + beat_cycles_;
+      bus_time_ = done;
+    }
+    return done;
+  }
+
+private:
+
+  struct bank_t {
+    uint64_t row = 0;
+    uint64_t ready_time = 0;
+    bool is_open = false;
+  };
+
+  void refresh(uint64_t curr_time) {
+    if (0 == config_.tREFI)
+      return;
+    // refresh closes all rows and stalls the banks
+    while (curr_time >= next_refresh_) {
+      for (auto& bank : banks_) {
+        bank.is_open = false;
+      }
+      refresh_end_ = next_refresh_ + config_.tRFC;
+      next_refresh_ += config_.tREFI;
+      ++stats_.refreshes;
+    }
+  }
+
+  avm_dram_config config_;
+  std::vector<bank_t> banks_;
+  uint32_t beat_cycles_;
+  uint64_t bus_time_;
+  uint64_t next_refresh_;
+  uint64_t refresh_end_;
+  avm_stats& stats_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class avm_slave_driver_impl {
 protected:
 
@@ -14,6 +187,7 @@ protected:
     bool is_write;
     uint64_t address;
     uint64_t byteenable;
+    uint64_t req_time;
     uint64_t rsp_time;
   };
 
@@ -23,13 +197,13 @@ protected:
     uint32_t address;
   };
 
-  using rd_rsp_t = std::pair<uint32_t, sdata_type>;
-  using wr_rsp_t = uint32_t;
-
   avm_slave_driver_base* instance_;
-  std::vector<std::pair<uint8_t*, uint32_t>> buffers_;
-  std::list<req_t> reqs_;
-  std::list<sdata_type> wr_data_;  
+  std::vector<std::pair<uint8_t*, uint64_t>> buffers_;
+  std::vector<std::unique_ptr<ch::internal::mapped_file>> files_;
+  ring_buffer<req_t> reqs_;
+  block_buffer wr_data_;
+  std::optional<dram_model> dram_;
+  avm_stats stats_;
   uint32_t data_size_;
   uint32_t max_burst_size_;
   uint32_t reqs_queue_size_;
@@ -55,19 +229,30 @@ protected:
     return arbiter_idx_++;
   }
 
+  void push_request(uint32_t channel, bool is_write, uint64_t address, uint64_t byteenable) {
+    auto rsp_time = curr_time_ + latency_;
+    if (dram_) {
+      rsp_time = dram_->access(address, curr_time_) + latency_;
+      // responses are returned in order
+      if (!reqs_.empty()) {
+        rsp_time = std::max(rsp_time, reqs_.back().rsp_time);
+      }
+    }
+    reqs_.push_back({channel, is_write, address, byteenable, curr_time_, rsp_time});
+  }
+
   void process_request(uint32_t channel) {
     auto req = instance_->get_request_info(channel);
     assert(req.burstcount >= 1);
     assert(req.burstcount <= max_burst_size_);
-    auto rsp_time = curr_time_ + latency_;
     if (req.write) {
       if (wr_burst_.counter != 0) {
         assert(wr_burst_.channel == channel);        
-        reqs_.push_back({channel, true, wr_burst_.address, req.byteenable, rsp_time});
+        this->push_request(channel, true, wr_burst_.address, req.byteenable);
         wr_burst_.address += data_size_;
         --wr_burst_.counter;
       } else {
-        reqs_.push_back({channel, true, req.address, req.byteenable, rsp_time});
+        this->push_request(channel, true, req.address, req.byteenable);
         if (req.burstcount > 1) {
           wr_burst_.counter = req.burstcount - 1;
           wr_burst_.channel  = channel;
@@ -77,7 +262,7 @@ protected:
       wr_data_.push_back(req.wdata);
     } else {
       for (uint32_t i = 0; i < req.burstcount; ++i) {
-        reqs_.push_back({channel, false, req.address + i * data_size_, req.byteenable, rsp_time});
+        this->push_request(channel, false, req.address + i * data_size_, req.byteenable);
       }
     }
   }
@@ -85,35 +270,39 @@ protected:
   std::pair<uint32_t, const uint8_t*> process_responses() {
     uint32_t rsp_channel = -1;
     uint8_t* wdata = nullptr;
+    auto& req = reqs_.front();
+    if (req.rsp_time > curr_time_)
+      return std::make_pair(rsp_channel, wdata);
     auto full_writemask = (1ull << data_size_) - 1;
-    for (auto it = reqs_.begin(), end = reqs_.end(); it != end; ++it) {
-      auto& req = *it;
-      if (req.rsp_time > curr_time_)
-        continue;
-      rsp_channel = req.channel;
-      assert(rsp_channel < buffers_.size());
-      auto& buffer = buffers_[rsp_channel];
-      if (req.is_write) {
-        auto& data = wr_data_.front();
-        if (full_writemask == (req.byteenable & full_writemask)) {
-          CH_CHECK(req.address + data_size_ <= buffer.second, "out of bound access");
-          data.read(0, buffer.first + req.address, 0, data_size_ * 8);
-        } else {
-          for (uint32_t i = 0; i < data_size_; ++i) {
-            if (0 == ((req.byteenable >> i) & 0x1))
-              continue;
-            CH_CHECK(req.address + i + 1 <= buffer.second, "out of bound access");
-            data.read(i * 8, buffer.first + req.address + i, 0, 8);
-          }
-        }
-        wr_data_.pop_front();
-      } else {
+    rsp_channel = req.channel;
+    assert(rsp_channel < buffers_.size());
+    auto& buffer = buffers_[rsp_channel];
+    if (req.is_write) {
+      auto data = wr_data_.front();
+      if (full_writemask == (req.byteenable & full_writemask)) {
         CH_CHECK(req.address + data_size_ <= buffer.second, "out of bound access");
-        wdata = buffer.first + req.address;
+        std::memcpy(buffer.first + req.address, data, data_size_);
+      } else {
+        for (uint32_t i = 0; i < data_size_; ++i) {
+          if (0 == ((req.byteenable >> i) & 0x1))
+            continue;
+          CH_CHECK(req.address + i + 1 <= buffer.second, "out of bound access");
+          buffer.first[req.address + i] = data[i];
+        }
       }
-      reqs_.erase(it);
-      break;
+      wr_data_.pop_front();
+      ++stats_.writes;
+      stats_.bytes_written += data_size_;
+    } else {
+      CH_CHECK(req.address + data_size_ <= buffer.second, "out of bound access");
+      wdata = buffer.first + req.address;
+      ++stats_.reads;
+      stats_.bytes_read += data_size_;
     }
+    auto latency = curr_time_ - req.req_time;
+    stats_.total_latency += latency;
+    stats_.max_latency = std::max(stats_.max_latency, latency);
+    reqs_.pop_front();
     return std::make_pair(rsp_channel, wdata);
   }
 
@@ -124,9 +313,13 @@ public:
                         uint32_t data_size,
                         uint32_t max_burst_size,
                         uint32_t reqs_queue_size,
-                        uint32_t latency)
+                        uint32_t latency,
+                        const std::optional<avm_dram_config>& dram)
     : instance_(instance)
     , buffers_(num_ports)
+    , files_(num_ports)
+    , reqs_(reqs_queue_size)
+    , wr_data_(reqs_queue_size, data_size)
     , data_size_(data_size)
     , max_burst_size_(max_burst_size)
     , reqs_queue_size_(reqs_queue_size)
@@ -135,11 +328,22 @@ public:
     , arbiter_idx_(0)
     , wr_burst_({}) {
     assert(reqs_queue_size >= 2 * max_burst_size);
+    if (dram) {
+      dram_.emplace(*dram, data_size, stats_);
+    }
   }
 
-  void bind(uint32_t channel, const void* buffer, uint32_t size) {
+  void bind(uint32_t channel, const void* buffer, uint64_t size) {
     assert(channel < buffers_.size());
     buffers_[channel] = std::pair((uint8_t*)buffer, size);
+    files_[channel].reset();
+  }
+
+  void bind(uint32_t channel, const std::string& file) {
+    assert(channel < buffers_.size());
+    auto mapping = std::make_unique<ch::internal::mapped_file>(file, true);
+    buffers_[channel] = std::pair(mapping->data(), mapping->size());
+    files_[channel] = std::move(mapping);
   }
 
   auto tick(uint32_t reqs_mask) {
@@ -170,6 +374,7 @@ public:
 
     // advance current time
     ++curr_time_;
+    stats_.cycles = curr_time_;
 
     // return status
     return avm_slave_driver_base::status_t{wait_mask, rsp_channel, rsp_wdata};
@@ -178,12 +383,15 @@ public:
   void flush() {
     // commit pending responses
     while (!reqs_.empty()) {
-      curr_time_ = reqs_.front().rsp_time;
+      curr_time_ = std::max(curr_time_, reqs_.front().rsp_time);
       process_responses();
     }
   }
-};
 
+  const avm_stats& stats() const {
+    return stats_;
+  }
+};
 }
 }
 }
@@ -194,19 +402,24 @@ avm_slave_driver_base::avm_slave_driver_base(uint32_t num_ports,
                                              uint32_t data_size,
                                              uint32_t max_burst_size,
                                              uint32_t reqs_queue_size,
-                                             uint32_t latency) {
+                                             uint32_t latency,
+                                             const std::optional<avm_dram_config>& dram) {
   impl_ = new avm_slave_driver_impl(
-        this, num_ports, data_size, max_burst_size, reqs_queue_size, latency);
+        this, num_ports, data_size, max_burst_size, reqs_queue_size, latency, dram);
 }
 
 avm_slave_driver_base::~avm_slave_driver_base() {
   delete impl_;
 }
 
-void avm_slave_driver_base::bind(uint32_t channel, const void* buffer, uint32_t size) {
+void avm_slave_driver_base::bind(uint32_t channel, const void* buffer, uint64_t size) {
   impl_->bind(channel, buffer, size);
 }
 
+void avm_slave_driver_base::bind(uint32_t channel, const std::string& file) {
+  impl_->bind(channel, file);
+}
+
 avm_slave_driver_base::status_t avm_slave_driver_base::tick(uint32_t reqs_mask) {
   return impl_->tick(reqs_mask);
 }
@@ -214,3 +427,23 @@ avm_slave_driver_base::status_t avm_slave_driver_base::tick(uint32_t reqs_mask)
 void avm_slave_driver_base::flush() {
   impl_->flush();
 }
+
+const avm_stats& avm_slave_driver_base::stats() const {
+  return impl_->stats();
+}
+
+std::ostream& eda::altera::avalon::operator<<(std::ostream& out, const avm_stats& stats) {
+  auto row_accesses = stats.row_hits + stats.row_misses + stats.row_conflicts;
+  out << "cycles: " << stats.cycles << std::endl;
+  out << "reads: " << stats.reads << " (" << stats.bytes_read << " bytes)" << std::endl;
+  out << "writes: " << stats.writes << " (" << stats.bytes_written << " bytes)" << std::endl;
+  out << "bandwidth: " << stats.bandwidth() << " bytes/cycle" << std::endl;
+  out << "latency: avg=" << stats.avg_latency() << ", max=" << stats.max_latency << std::endl;
+  if (row_accesses) {
+    out << "row buffer: hits=" << stats.row_hits
+        << ", misses=" << stats.row_misses
+        << ", conflicts=" << stats.row_conflicts
+        << ", refreshes=" << stats.refreshes << std::endl;
+  }
+  return out;
+}
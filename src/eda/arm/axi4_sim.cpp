@@ -0,0 +1,312 @@
+#include "eda/arm/axi4_sim.h"
+#include "mappedfile.h"
+#include <random>
+
+using namespace eda::arm::axi4;
+
+namespace eda {
+namespace arm {
+namespace axi4 {
+
+class axi4_slave_driver_impl {
+protected:
+
+  struct txn_t {
+    uint32_t id;
+    uint64_t addr;
+    uint32_t len;
+    uint32_t size;
+    uint32_t burst;
+    uint32_t beat;
+    uint64_t req_time;
+    uint64_t rsp_time;
+  };
+
+  struct port_t {
+    uint8_t* buffer = nullptr;
+    uint64_t size = 0;
+    std::unique_ptr<ch::internal::mapped_file> file;
+    std::vector<txn_t> reads;   // pending read data
+    std::vector<txn_t> writes;  // pending write data, in order
+    std::vector<txn_t> wrsps;   // pending write responses
+    int32_t rd_active = -1;     // read burst being returned
+    int32_t wr_active = -1;     // write response being returned
+  };
+
+  std::vector<port_t> ports_;
+  axi4_config config_;
+  axi4_stats stats_;
+  uint32_t data_size_;
+  uint64_t curr_time_;
+  int64_t bus_credits_;
+  std::mt19937 rand_gen_;
+
+  bool has_bus_credits() const {
+    return (0 == config_.bus_width) || (bus_credits_ >= int64_t(data_size_));
+  }
+
+  void use_bus_credits() {
+    if (config_.bus_width) {
+      bus_credits_ -= data_size_;
+    }
+  }
+
+  txn_t make_txn(const axi4_slave_driver_base::addr_t& req) {
+    auto len  = req.len + 1;
+    auto size = 1u << req.size;
+    CH_CHECK(size <= data_size_, "invalid AXI transfer size");
+    CH_CHECK(req.burst <= uint32_t(axi4_burst::wrap), "invalid AXI burst type");
+    if (req.burst == uint32_t(axi4_burst::wrap)) {
+      CH_CHECK((2 == len || 4 == len || 8 == len || 16 == len) && 0 == (req.addr & (size - 1)),
+               "invalid AXI wrapping burst");
+    }
+    return txn_t{req.id, req.addr, len, size, req.burst, 0, curr_time_, 0};
+  }
+
+  // bus-aligned address of the current beat
+  uint64_t beat_address(const txn_t& txn) const {
+    uint64_t addr = txn.addr;
+    switch (axi4_burst(txn.burst)) {
+    case axi4_burst::fixed:
+      break;
+    case axi4_burst::incr:
+      if (txn.beat) {
+        addr = (txn.addr & ~uint64_t(txn.size - 1)) + uint64_t(txn.beat) * txn.size;
+      }
+      break;
+    case axi4_burst::wrap: {
+      uint64_t total = uint64_t(txn.len) * txn.size;
+      auto base = txn.addr & ~(total - 1);
+      addr = base + ((txn.addr - base + uint64_t(txn.beat) * txn.size) & (total - 1));
+    } break;
+    }
+    return addr & ~uint64_t(data_size_ - 1);
+  }
+
+  // oldest transaction ready for a response, transactions with the same id
+  // complete in order; with reordering enabled a random candidate is picked.
+  int32_t select(const std::vector<txn_t>& txns) {
+    int32_t candidates[64];
+    uint32_t num_candidates = 0;
+    for (uint32_t i = 0, n = txns.size(); i < n && num_candidates < 64; ++i) {
+      auto& txn = txns[i];
+      if (txn.rsp_time > curr_time_)
+        continue;
+      bool blocked = false;
+      for (uint32_t j = 0; j < i; ++j) {
+        if (txns[j].id == txn.id) {
+          blocked = true;
+          break;
+        }
+      }
+      if (blocked)
+        continue;
+      candidates[num_candidates++] = i;
+      if (!config_.reorder)
+        break;
+    }
+    if (0 == num_candidates)
+      return -1;
+    if (1 == num_candidates)
+      return candidates[0];
+    return candidates[rand_gen_() % num_candidates];
+  }
+
+  // transfers complete when valid and ready were both asserted
+  // during the cycle, slave signals are then updated for the next one.
+  void process_writes(port_t& port,
+                      const axi4_slave_driver_base::master_t& master,
+                      axi4_slave_driver_base::slave_t& slave) {
+    // write address
+    if (master.awvalid && slave.awready) {
+      port.writes.push_back(this->make_txn(master.aw));
+    }
+
+    // write data
+    if (master.wvalid && slave.wready) {
+      auto& txn = port.writes.front();
+      auto addr = this->beat_address(txn);
+      CH_CHECK(addr + data_size_ <= port.size, "out of bound access");
+      auto wstrb = master.wstrb;
+      for (uint32_t i = 0; i < data_size_; ++i) {
+        if ((wstrb >> i) & 0x1) {
+          port.buffer[addr + i] = master.wdata[i];
+        }
+      }
+      this->use_bus_credits();
+      ++stats_.write_beats;
+      stats_.bytes_written += __builtin_popcountll(wstrb);
+      bool last = (++txn.beat == txn.len);
+      CH_CHECK(last == master.wlast, "invalid AXI write burst length");
+      if (last) {
+        txn.rsp_time = curr_time_ + config_.latency;
+        port.wrsps.push_back(txn);
+        port.writes.erase(port.writes.begin());
+      }
+    }
+
+    // write response
+    if (slave.bvalid && master.bready) {
+      auto& txn = port.wrsps[port.wr_active];
+      auto latency = curr_time_ - txn.req_time;
+      ++stats_.writes;
+      stats_.write_latency += latency;
+      stats_.max_write_latency = std::max(stats_.max_write_latency, latency);
+      port.wrsps.erase(port.wrsps.begin() + port.wr_active);
+      port.wr_active = -1;
+    }
+
+    slave.awready = (port.writes.size() + port.wrsps.size()) < config_.max_outstanding;
+    slave.wready = !port.writes.empty() && this->has_bus_credits();
+    if (port.wr_active < 0) {
+      port.wr_active = this->select(port.wrsps);
+    }
+    slave.bvalid = (port.wr_active >= 0);
+    if (slave.bvalid) {
+      slave.bid   = port.wrsps[port.wr_active].id;
+      slave.bresp = uint32_t(axi4_resp::okay);
+    }
+  }
+
+  void process_reads(port_t& port,
+                     const axi4_slave_driver_base::master_t& master,
+                     axi4_slave_driver_base::slave_t& slave) {
+    // read address
+    if (master.arvalid && slave.arready) {
+      auto txn = this->make_txn(master.ar);
+      txn.rsp_time = curr_time_ + config_.latency;
+      port.reads.push_back(txn);
+    }
+
+    // read data
+    if (slave.rvalid && master.rready) {
+      auto& txn = port.reads[port.rd_active];
+      this->use_bus_credits();
+      ++stats_.read_beats;
+      stats_.bytes_read += txn.size;
+      if (++txn.beat == txn.len) {
+        auto latency = curr_time_ - txn.req_time;
+        ++stats_.reads;
+        stats_.read_latency += latency;
+        stats_.max_read_latency = std::max(stats_.max_read_latency, latency);
+        port.reads.erase(port.reads.begin() + port.rd_active);
+        port.rd_active = -1;
+      }
+    }
+
+    slave.arready = port.reads.size() < config_.max_outstanding;
+    // bursts are returned without interleaving
+    if (port.rd_active < 0) {
+      port.rd_active = this->select(port.reads);
+    }
+    slave.rvalid = (port.rd_active >= 0) && this->has_bus_credits();
+    slave.rlast = false;
+    if (slave.rvalid) {
+      auto& txn = port.reads[port.rd_active];
+      auto addr = this->beat_address(txn);
+      CH_CHECK(addr + data_size_ <= port.size, "out of bound access");
+      slave.rid   = txn.id;
+      slave.rresp = uint32_t(axi4_resp::okay);
+      slave.rlast = (txn.beat + 1 == txn.len);
+      slave.rdata = port.buffer + addr;
+    }
+  }
+
+public:
+
+  axi4_slave_driver_impl(uint32_t num_ports,
+                         uint32_t data_size,
+                         const axi4_config& config)
+    : ports_(num_ports)
+    , config_(config)
+    , data_size_(data_size)
+    , curr_time_(0)
+    , bus_credits_(0)
+    , rand_gen_(0) {
+    CH_CHECK(config.max_outstanding != 0, "invalid AXI configuration");
+  }
+
+  void bind(uint32_t channel, const void* buffer, uint64_t size) {
+    assert(channel < ports_.size());
+    ports_[channel].buffer = (uint8_t*)buffer;
+    ports_[channel].size = size;
+    ports_[channel].file.reset();
+  }
+
+  void bind(uint32_t channel, const std::string& file) {
+    assert(channel < ports_.size());
+    auto mapping = std::make_unique<ch::internal::mapped_file>(file, true);
+    ports_[channel].buffer = mapping->data();
+    ports_[channel].size = mapping->size();
+    ports_[channel].file = std::move(mapping);
+  }
+
+  void tick(const axi4_slave_driver_base::master_t* masters,
+            axi4_slave_driver_base::slave_t* slaves) {
+    // replenish the data bus bandwidth, a beat granted on the previous
+    // cycle is only charged on this one so the balance may hold both.
+    if (config_.bus_width) {
+      bus_credits_ = std::min<int64_t>(bus_credits_ + config_.bus_width,
+                                       data_size_ + config_.bus_width);
+    }
+
+    for (uint32_t i = 0, n = ports_.size(); i < n; ++i) {
+      this->process_writes(ports_[i], masters[i], slaves[i]);
+      this->process_reads(ports_[i], masters[i], slaves[i]);
+    }
+
+    // advance current time
+    ++curr_time_;
+    stats_.cycles = curr_time_;
+  }
+
+  const axi4_stats& stats() const {
+    return stats_;
+  }
+};
+
+}
+}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+axi4_slave_driver_base::axi4_slave_driver_base(uint32_t num_ports,
+                                               uint32_t data_size,
+                                               const axi4_config& config) {
+  impl_ = new axi4_slave_driver_impl(num_ports, data_size, config);
+}
+
+axi4_slave_driver_base::~axi4_slave_driver_base() {
+  delete impl_;
+}
+
+void axi4_slave_driver_base::bind(uint32_t channel, const void* buffer, uint64_t size) {
+  impl_->bind(channel, buffer, size);
+}
+
+void axi4_slave_driver_base::bind(uint32_t channel, const std::string& file) {
+  impl_->bind(channel, file);
+}
+
+void axi4_slave_driver_base::tick(const master_t* masters, slave_t* slaves) {
+  impl_->tick(masters, slaves);
+}
+
+const axi4_stats& axi4_slave_driver_base::stats() const {
+  return impl_->stats();
+}
+
+std::ostream& eda::arm::axi4::operator<<(std::ostream& out, const axi4_stats& stats) {
+  out << "cycles: " << stats.cycles << std::endl;
+  out << "reads: " << stats.reads << " bursts, " << stats.read_beats << " beats ("
+      << stats.bytes_read << " bytes)" << std::endl;
+  out << "writes: " << stats.writes << " bursts, " << stats.write_beats << " beats ("
+      << stats.bytes_written << " bytes)" << std::endl;
+  out << "bandwidth: " << stats.bandwidth() << " bytes/cycle" << std::endl;
+  out << "read latency: avg=" << stats.avg_read_latency()
+      << ", max=" << stats.max_read_latency << std::endl;
+  out << "write latency: avg=" << stats.avg_write_latency()
+      << ", max=" << stats.max_write_latency << std::endl;
+  return out;
+}
@@ -216,6 +216,7 @@ bool firrtlwriter::print_decl(std::ostream& out,
   case type_tap:
   case type_assert:
   case type_print:
+  case type_cover:
   case type_time:
     break;
   default:
@@ -255,6 +256,7 @@ bool firrtlwriter::print_logic(std::ostream& out, lnodeimpl* node) {
   case type_tap:
   case type_assert:
   case type_print:
+  case type_cover:
   case type_time:
     return false;
   }
@@ -299,7 +299,7 @@ bool verilogwriter::print_decl(std::ostream& out,
       if (mem->is_logic_rom()
        && mem->force_logic_ram()) {
         out << " /* synthesis";
-        if (mem->size() >= 20*1024) {
+        if (mem->bit_size() >= 20*1024) {
           out << " ramstyle = \"M20K\"";
         } else {
           out << " ramstyle = \"MLAB\"";
@@ -363,6 +363,7 @@ bool verilogwriter::print_decl(std::ostream& out,
   case type_udfin:
   case type_assert:
   case type_print:
+  case type_cover:
   case type_time:
     visited.insert(node->id());
     break;
@@ -410,6 +411,7 @@ bool verilogwriter::print_logic(std::ostream& out, lnodeimpl* node) {
   case type_udfout:
   case type_assert:
   case type_print:
+  case type_cover:
   case type_time:
     return false;
   }  
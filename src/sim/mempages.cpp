@@ -0,0 +1,194 @@
+#include "mempages.h"
+
+using namespace ch::internal;
+
+static constexpr uint32_t page_target_width = 32768;
+static constexpr uint32_t invalid_page = 0xffffffff;
+
+uint32_t mem_pages::page_shift(uint32_t data_width) {
+  return (data_width < page_target_width) ? log2floor(page_target_width / data_width) : 0;
+}
+
+mem_pages::mem_pages(uint32_t data_width, uint32_t num_items, const sdata_type& init_data)
+  : read_tag_(invalid_page)
+  , read_ptr_(nullptr)
+  , write_tag_(invalid_page)
+  , write_ptr_(nullptr)
+  , data_width_(data_width)
+  , num_items_(num_items)
+  , page_items_(1u << page_shift(data_width))
+  , page_words_(ceildiv(page_items_ * data_width, bitwidth_v<block_type>))
+  , num_pages_(ceildiv(num_items, page_items_))
+  , discard_page_(nullptr) {
+  pages_ = new block_type*[num_pages_]();
+  zero_page_ = this->alloc_page();
+  if (!init_data.empty()) {
+    // only pages holding non-zero data are allocated
+    auto width = this->page_width();
+    for (uint32_t i = 0; i < num_pages_; ++i) {
+      auto offset = i * width;
+      auto length = std::min(width, init_data.size() - offset);
+      auto page = this->alloc_page();
+      bv_copy_vector(page, 0, init_data.words(), offset, length);
+      if (bv_is_zero(page, length)) {
+        this->free_page(page);
+      } else {
+        pages_[i] = page;
+      }
+    }
+  }
+}
+
+mem_pages::mem_pages(const mem_pages& other)
+  : read_tag_(invalid_page)
+  , read_ptr_(nullptr)
+  , write_tag_(invalid_page)
+  , write_ptr_(nullptr)
+  , data_width_(other.data_width_)
+  , num_items_(other.num_items_)
+  , page_items_(other.page_items_)
+  , page_words_(other.page_words_)
+  , num_pages_(other.num_pages_)
+  , discard_page_(nullptr) {
+  pages_ = new block_type*[num_pages_]();
+  zero_page_ = this->alloc_page();
+  for (uint32_t i = 0; i < num_pages_; ++i) {
+    if (other.pages_[i]) {
+      pages_[i] = this->alloc_page();
+      std::copy_n(other.pages_[i], page_words_, pages_[i]);
+    }
+  }
+}
+
+mem_pages::~mem_pages() {
+  this->clear();
+  this->free_page(zero_page_);
+  if (discard_page_) {
+    this->free_page(discard_page_);
+  }
+  delete [] pages_;
+}
+
+uint32_t mem_pages::num_allocated() const {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < num_pages_; ++i) {
+    count += (pages_[i] != nullptr);
+  }
+  return count;
+}
+
+const block_type* mem_pages::lookup_read(uint32_t page) {
+  // addresses past the last page read zeros
+  if (page >= num_pages_)
+    return zero_page_;
+  auto ptr = pages_[page];
+  read_tag_ = page;
+  read_ptr_ = ptr ? ptr : zero_page_;
+  return read_ptr_;
+}
+
+block_type* mem_pages::lookup_write(uint32_t page) {
+  // writes past the last page go to a scratch page that is never read
+  if (page >= num_pages_) {
+    if (nullptr == discard_page_) {
+      discard_page_ = this->alloc_page();
+    }
+    return discard_page_;
+  }
+  auto ptr = pages_[page];
+  if (nullptr == ptr) {
+    ptr = this->alloc_page();
+    pages_[page] = ptr;
+    if (read_tag_ == page) {
+      read_ptr_ = ptr;
+    }
+  }
+  write_tag_ = page;
+  write_ptr_ = ptr;
+  return ptr;
+}
+
+block_type* mem_pages::alloc_page() const {
+  // pad both ends with a guard word for unaligned accesses
+  auto buf = new block_type[page_words_ + 2]();
+  return buf + 1;
+}
+
+void mem_pages::free_page(block_type* page) const {
+  delete [] (page - 1);
+}
+
+void mem_pages::clear() {
+  for (uint32_t i = 0; i < num_pages_; ++i) {
+    if (pages_[i]) {
+      this->free_page(pages_[i]);
+      pages_[i] = nullptr;
+    }
+  }
+  read_tag_  = invalid_page;
+  write_tag_ = invalid_page;
+}
+
+void mem_pages::read(uint64_t offset, block_type* dst, uint32_t length) const {
+  auto width = this->page_width();
+  uint32_t dst_offset = 0;
+  while (length) {
+    auto page = uint32_t(offset / width);
+    auto page_offset = uint32_t(offset % width);
+    auto len = std::min(width - page_offset, length);
+    auto ptr = (page < num_pages_) ? pages_[page] : nullptr;
+    bv_copy(dst, dst_offset, ptr ? ptr : zero_page_, page_offset, len);
+    offset += len;
+    dst_offset += len;
+    length -= len;
+  }
+}
+
+void mem_pages::write(uint64_t offset, const block_type* src, uint32_t length) {
+  auto width = this->page_width();
+  uint32_t src_offset = 0;
+  while (length) {
+    auto page = uint32_t(offset / width);
+    auto page_offset = uint32_t(offset % width);
+    auto len = std::min(width - page_offset, length);
+    bv_copy(this->write_page(page), page_offset, src, src_offset, len);
+    offset += len;
+    src_offset += len;
+    length -= len;
+  }
+}
+
+void mem_pages::save(std::ostream& out) const {
+  auto count = this->num_allocated();
+  out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (uint32_t i = 0; i < num_pages_; ++i) {
+    if (pages_[i]) {
+      out.write(reinterpret_cast<const char*>(&i), sizeof(i));
+      out.write(reinterpret_cast<const char*>(pages_[i]), page_words_ * sizeof(block_type));
+    }
+  }
+}
+
+void mem_pages::restore(std::istream& in) {
+  this->clear();
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char*>(&count), sizeof(count));
+  for (uint32_t n = 0; n < count && in; ++n) {
+    uint32_t i = 0;
+    in.read(reinterpret_cast<char*>(&i), sizeof(i));
+    CH_CHECK(i < num_pages_, "invalid memory page in checkpoint");
+    auto page = this->alloc_page();
+    in.read(reinterpret_cast<char*>(page), page_words_ * sizeof(block_type));
+    pages_[i] = page;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const block_type* mem_pages_read(mem_pages* self, uint32_t page) {
+  return self->read_page(page);
+}
+
+block_type* mem_pages_write(mem_pages* self, uint32_t page) {
+  return self->write_page(page);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "memimpl.h"
+
+namespace ch {
+namespace internal {
+
+// sparse storage for large memories: items are grouped into fixed-size pages
+// allocated on first write, reads from unallocated pages return a shared zero page.
+// accesses past the last page read zeros and drop writes.
+// the last pages accessed for reading and writing are cached.
+class mem_pages {
+public:
+
+  // memories larger than this many bits use paged storage
+  static constexpr uint32_t threshold = (1 << 24);
+
+  static bool is_paged(memimpl* mem) {
+    return mem->bit_size() > threshold;
+  }
+
+  // log2 of the number of items per page
+  static uint32_t page_shift(uint32_t data_width);
+
+  mem_pages(uint32_t data_width, uint32_t num_items, const sdata_type& init_data);
+
+  mem_pages(const mem_pages& other);
+
+  ~mem_pages();
+
+  uint32_t data_width() const {
+    return data_width_;
+  }
+
+  uint32_t num_items() const {
+    return num_items_;
+  }
+
+  uint32_t page_items() const {
+    return page_items_;
+  }
+
+  // size of a page in bits
+  uint32_t page_width() const {
+    return page_items_ * data_width_;
+  }
+
+  uint32_t num_allocated() const;
+
+  const block_type* read_page(uint32_t page) {
+    if (page == read_tag_)
+      return read_ptr_;
+    return this->lookup_read(page);
+  }
+
+  block_type* write_page(uint32_t page) {
+    if (page == write_tag_)
+      return write_ptr_;
+    return this->lookup_write(page);
+  }
+
+  // bit range copies across pages, offsets are 64-bit past 2^32 bits
+  void read(uint64_t offset, block_type* dst, uint32_t length) const;
+
+  void write(uint64_t offset, const block_type* src, uint32_t length);
+
+  void save(std::ostream& out) const;
+
+  void restore(std::istream& in);
+
+  // cache fields accessed by the JIT compiler
+  static constexpr uint32_t read_tag_offset() {
+    return offsetof(mem_pages, read_tag_);
+  }
+
+  static constexpr uint32_t read_ptr_offset() {
+    return offsetof(mem_pages, read_ptr_);
+  }
+
+  static constexpr uint32_t write_tag_offset() {
+    return offsetof(mem_pages, write_tag_);
+  }
+
+  static constexpr uint32_t write_ptr_offset() {
+    return offsetof(mem_pages, write_ptr_);
+  }
+
+private:
+
+  const block_type* lookup_read(uint32_t page);
+
+  block_type* lookup_write(uint32_t page);
+
+  block_type* alloc_page() const;
+
+  void free_page(block_type* page) const;
+
+  void clear();
+
+  // plain members only, the cache offsets require a standard layout
+  uint32_t read_tag_;
+  const block_type* read_ptr_;
+  uint32_t write_tag_;
+  block_type* write_ptr_;
+  uint32_t data_width_;
+  uint32_t num_items_;
+  uint32_t page_items_;
+  uint32_t page_words_;
+  uint32_t num_pages_;
+  block_type** pages_;
+  block_type* zero_page_;
+  block_type* discard_page_;
+};
+
+}
+}
+
+extern "C" const ch::internal::block_type* mem_pages_read(ch::internal::mem_pages* self, uint32_t page);
+
+extern "C" ch::internal::block_type* mem_pages_write(ch::internal::mem_pages* self, uint32_t page);
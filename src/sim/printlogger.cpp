@@ -0,0 +1,93 @@
+#include "printlogger.h"
+
+using namespace ch::internal;
+
+print_logger::print_logger(std::ostream& out, uint32_t capacity)
+  : buffer_(1ull << ceil2(capacity - 1))
+  , capacity_(buffer_.size())
+  , mask_(buffer_.size() - 1)
+  , head_(0)
+  , tail_(0)
+  , running_(true)
+  , out_(out) {
+  thread_ = std::thread(&print_logger::consume, this);
+}
+
+print_logger::print_logger(const print_logger& other)
+  : formats_(other.formats_)
+  , buffer_(other.buffer_.size())
+  , capacity_(other.capacity_)
+  , mask_(other.mask_)
+  , head_(0)
+  , tail_(0)
+  , running_(true)
+  , out_(other.out_) {
+  thread_ = std::thread(&print_logger::consume, this);
+}
+
+print_logger::~print_logger() {
+  running_.store(false, std::memory_order_release);
+  thread_.join();
+  out_.flush();
+}
+
+uint32_t print_logger::add_format(printimpl* node) {
+  auto& format = formats_.emplace_back();
+  format.format = node->format();
+  format.enum_strings = node->enum_strings();
+  format.length = id_slots;
+  for (uint32_t i = (node->has_pred() ? 1 : 0), n = node->num_srcs(); i < n; ++i) {
+    auto size = node->src(i).size();
+    format.src_sizes.push_back(size);
+    format.length += ceildiv(size, bitwidth_v<block_type>);
+  }
+  CH_CHECK(format.length <= capacity_, "print arguments too large for logger");
+  return formats_.size() - 1;
+}
+
+void print_logger::flush() {
+  while (tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed)) {
+    std::this_thread::yield();
+  }
+  out_.flush();
+}
+
+void print_logger::consume() {
+  std::vector<std::vector<sdata_type>> srcs;
+  for (;;) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto head = head_.load(std::memory_order_acquire);
+    if (tail == head) {
+      if (!running_.load(std::memory_order_acquire)
+       && head == head_.load(std::memory_order_acquire))
+        break;
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+
+    while (tail != head) {
+      uint32_t format_id = 0;
+      for (uint32_t k = 0; k < id_slots; ++k) {
+        format_id |= uint32_t(buffer_[tail++ & mask_]) << (k * bitwidth_v<block_type>);
+      }
+      auto& format = formats_[format_id];
+      if (srcs.size() <= format_id) {
+        srcs.resize(format_id + 1);
+      }
+      auto& values = srcs[format_id];
+      if (values.empty()) {
+        for (auto size : format.src_sizes) {
+          values.emplace_back(size);
+        }
+      }
+      for (auto& value : values) {
+        auto words = value.words();
+        for (uint32_t j = 0, m = ceildiv(value.size(), bitwidth_v<block_type>); j < m; ++j) {
+          words[j] = buffer_[tail++ & mask_];
+        }
+      }
+      out_ << to_string(format.format.c_str(), values.data(), format.enum_strings.data());
+      tail_.store(tail, std::memory_order_release);
+    }
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "printimpl.h"
+#include <thread>
+
+namespace ch {
+namespace internal {
+
+// deferred ch_print logging: the simulation thread copies the raw argument
+// bits into a single-producer/single-consumer ring buffer and a background
+// thread formats them in order.
+class print_logger {
+public:
+
+  print_logger(std::ostream& out = std::cout, uint32_t capacity = (1 << 20));
+
+  // empty logger with the same output and formats, used by forks
+  print_logger(const print_logger& other);
+
+  ~print_logger();
+
+  uint32_t add_format(printimpl* node);
+
+  void log(uint32_t format_id, const sdata_type* srcs) {
+    auto& format = formats_[format_id];
+    auto length = format.length;
+    auto head = head_.load(std::memory_order_relaxed);
+    while ((head - tail_.load(std::memory_order_acquire)) + length > capacity_) {
+      std::this_thread::yield();
+    }
+    for (uint32_t k = 0; k < id_slots; ++k) {
+      buffer_[head++ & mask_] = block_type(format_id >> (k * bitwidth_v<block_type>));
+    }
+    for (uint32_t i = 0, n = format.src_sizes.size(); i < n; ++i) {
+      auto words = srcs[i].words();
+      for (uint32_t j = 0, m = ceildiv(format.src_sizes[i], bitwidth_v<block_type>); j < m; ++j) {
+        buffer_[head++ & mask_] = words[j];
+      }
+    }
+    head_.store(head, std::memory_order_release);
+  }
+
+  // wait for all pending messages to be written out
+  void flush();
+
+protected:
+
+  // ring slots holding a format id
+  static constexpr uint32_t id_slots = ceildiv<uint32_t>(sizeof(uint32_t), sizeof(block_type));
+  static_assert(id_slots * bitwidth_v<block_type> >= 32, "format id doesn't fit in the ring");
+
+  struct format_t {
+    std::string format;
+    std::vector<enum_string_cb> enum_strings;
+    std::vector<uint32_t> src_sizes;
+    uint32_t length;
+  };
+
+  void consume();
+
+  std::vector<format_t> formats_;
+  std::vector<block_type> buffer_;
+  uint64_t capacity_;
+  uint64_t mask_;
+  std::atomic<uint64_t> head_;
+  std::atomic<uint64_t> tail_;
+  std::atomic<bool> running_;
+  std::ostream& out_;
+  std::thread thread_;
+};
+
+}
+}
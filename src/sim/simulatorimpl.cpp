@@ -3,16 +3,34 @@
 #include "compile.h"
 #include "deviceimpl.h"
 #include "litimpl.h"
+#include "opimpl.h"
+#include "proxyimpl.h"
 #include "ioimpl.h"
 #include "cdimpl.h"
+#include "coverimpl.h"
+#include "udfimpl.h"
+#include "memimpl.h"
+#include "mappedfile.h"
+#include "udf.h"
 #include "simref.h"
 #include "simjit.h"
+#include "tracefile.h"
+#include "moduleimpl.h"
+#include <mutex>
+#include <future>
 
 using namespace ch::internal;
 
-void clock_driver::add_signal(inputimpl* node) {
-  *node->value() = value_;
-  nodes_.push_back(node->value());
+void clock_driver::add_signal(const io_value_t& value) {
+  *value = value_;
+  nodes_.push_back(value);
+}
+
+void clock_driver::set_value(bool value) {
+  value_ = value;
+  for (auto node : nodes_) {
+    *node = value_;
+  }
 }
 
 void clock_driver::eval() {
@@ -24,12 +42,287 @@ void clock_driver::eval() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void clock_scheduler::add_clock(const sdata_type* port,
+                                const io_value_t& value,
+                                ch_tick period,
+                                ch_tick phase) {
+  CH_CHECK(1 == value->size(), "invalid clock port");
+  CH_CHECK(period >= 2, "invalid clock period %lu", period);
+  for (auto& clock : clocks_) {
+    CH_CHECK(clock.port != port, "duplicate clock port");
+  }
+  *value = false;
+  auto high = period / 2;
+  clocks_.push_back({port, value, high, period - high, time_ + phase, false});
+}
+
+void clock_scheduler::bind(const std::unordered_map<const sdata_type*, io_value_t>& ports) {
+  for (auto& clock : clocks_) {
+    clock.value = ports.at(clock.port);
+  }
+}
+
+bool clock_scheduler::advance(ch_tick end) {
+  auto time = end + 1;
+  for (auto& clock : clocks_) {
+    time = std::min(time, clock.next_edge);
+  }
+  if (time > end) {
+    time_ = end;
+    return false;
+  }
+  // toggle all clocks with an edge at this time
+  for (auto& clock : clocks_) {
+    if (clock.next_edge != time)
+      continue;
+    clock.level = !clock.level;
+    *clock.value = clock.level;
+    clock.next_edge += clock.level ? clock.high : clock.low;
+  }
+  time_ = time;
+  return true;
+}
+
+void clock_scheduler::save(std::ostream& out) const {
+  uint32_t count = clocks_.size();
+  out.write(reinterpret_cast<const char*>(&time_), sizeof(time_));
+  out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (auto& clock : clocks_) {
+    uint8_t level = clock.level;
+    out.write(reinterpret_cast<const char*>(&clock.high), sizeof(clock.high));
+    out.write(reinterpret_cast<const char*>(&clock.low), sizeof(clock.low));
+    out.write(reinterpret_cast<const char*>(&clock.next_edge), sizeof(clock.next_edge));
+    out.write(reinterpret_cast<const char*>(&level), sizeof(level));
+  }
+}
+
+void clock_scheduler::restore(std::istream& in) {
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char*>(&time_), sizeof(time_));
+  in.read(reinterpret_cast<char*>(&count), sizeof(count));
+  CH_CHECK(in.good() && count == clocks_.size(), "checkpoint clocks don't match the simulator clocks");
+  for (auto& clock : clocks_) {
+    ch_tick high = 0, low = 0;
+    uint8_t level = 0;
+    in.read(reinterpret_cast<char*>(&high), sizeof(high));
+    in.read(reinterpret_cast<char*>(&low), sizeof(low));
+    in.read(reinterpret_cast<char*>(&clock.next_edge), sizeof(clock.next_edge));
+    in.read(reinterpret_cast<char*>(&level), sizeof(level));
+    CH_CHECK(high == clock.high && low == clock.low, "checkpoint clocks don't match the simulator clocks");
+    clock.level = (0 != level);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static constexpr uint32_t STREAM_BUFFER_SIZE = 1 << 20;
+
+stream_driver::stream_driver()
+  : input_size_(0)
+  , num_records_(0)
+  , next_record_(0)
+  , output_size_(0)
+  , output_pos_(0)
+  , tick_(0)
+{}
+
+stream_driver::~stream_driver() {
+  this->flush();
+}
+
+void stream_driver::bind_inputs(const std::string& file,
+                                const std::vector<sdata_type*>& ports) {
+  CH_CHECK(!ports.empty(), "invalid stream ports");
+  inputs_.clear();
+  input_size_ = 0;
+  for (auto port : ports) {
+    inputs_.push_back({port, input_size_});
+    input_size_ += ceildiv<uint32_t>(port->size(), 8);
+  }
+  input_file_ = std::make_unique<mapped_file>(file);
+  CH_CHECK(0 == (input_file_->size() % input_size_),
+           "invalid stimulus file '%s' size", file.c_str());
+  num_records_ = input_file_->size() / input_size_;
+  next_record_ = 0;
+  tick_ = 0;
+}
+
+void stream_driver::bind_outputs(const std::string& file,
+                                 const std::vector<const sdata_type*>& ports) {
+  CH_CHECK(!ports.empty(), "invalid stream ports");
+  this->flush();
+  output_file_.close();
+  outputs_.clear();
+  output_size_ = 0;
+  for (auto port : ports) {
+    outputs_.push_back({port, output_size_});
+    output_size_ += ceildiv<uint32_t>(port->size(), 8);
+  }
+  output_file_.open(file, std::ios::binary);
+  CH_CHECK(output_file_.is_open(), "couldn't create file '%s'", file.c_str());
+  output_buf_.resize(std::max(output_size_, STREAM_BUFFER_SIZE - (STREAM_BUFFER_SIZE % output_size_)));
+  output_pos_ = 0;
+  tick_ = 0;
+}
+
+void stream_driver::apply() {
+  // inputs keep their last values once the stream is exhausted
+  if (next_record_ == num_records_)
+    return;
+  auto record = input_file_->data() + next_record_ * input_size_;
+  for (auto& input : inputs_) {
+    input.value->write(0, record + input.offset, 1, 0, input.value->size());
+  }
+  ++next_record_;
+}
+
+void stream_driver::capture() {
+  if (outputs_.empty())
+    return;
+  auto record = output_buf_.data() + output_pos_;
+  std::fill(record, record + output_size_, 0);
+  for (auto& output : outputs_) {
+    output.value->read(0, record + output.offset, 1, 0, output.value->size());
+  }
+  output_pos_ += output_size_;
+  if (output_pos_ + output_size_ > output_buf_.size()) {
+    this->flush();
+  }
+}
+
+void stream_driver::flush() {
+  if (0 == output_pos_)
+    return;
+  output_file_.write(reinterpret_cast<const char*>(output_buf_.data()), output_pos_);
+  output_file_.flush();
+  CH_CHECK(output_file_.good(), "couldn't write the capture file");
+  output_pos_ = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void watch_driver::add(const sdata_type* value,
+                       ch_watch kind,
+                       const sdata_type& ref,
+                       const std::function<void(ch_tick)>& callback) {
+  auto size = value->size();
+  auto num_words = ceildiv<uint32_t>(size, bitwidth_v<block_type>);
+  // previous value followed by the reference value
+  auto buffer = std::make_unique<block_type[]>(2 * num_words);
+  std::copy_n(value->words(), num_words, buffer.get());
+  std::copy_n(ref.words(), num_words, buffer.get() + num_words);
+  watches_.push_back({value->words(), buffer.get(), buffer.get() + num_words, size, kind, 0});
+  buffers_.emplace_back(std::move(buffer));
+  callbacks_.push_back(callback);
+}
+
+void watch_driver::clear() {
+  watches_.clear();
+  buffers_.clear();
+  callbacks_.clear();
+}
+
+bool watch_driver::check() {
+  bool any = false;
+  for (auto& watch : watches_) {
+    auto num_words = ceildiv<uint32_t>(watch.size, bitwidth_v<block_type>);
+    auto rem = watch.size % bitwidth_v<block_type>;
+    auto rising = watch.value[0] & ~watch.prev[0] & 0x1;
+    bool changed = false;
+    bool curr_eq = true;
+    bool prev_eq = true;
+    for (uint32_t i = 0; i < num_words; ++i) {
+      auto curr = watch.value[i];
+      if (rem && i + 1 == num_words) {
+        curr &= (block_type(1) << rem) - 1;
+      }
+      changed |= (curr != watch.prev[i]);
+      curr_eq &= (curr == watch.ref[i]);
+      prev_eq &= (watch.prev[i] == watch.ref[i]);
+      watch.prev[i] = curr;
+    }
+    bool fired = false;
+    switch (watch.kind) {
+    case ch_watch::equals:
+      fired = curr_eq && !prev_eq;
+      break;
+    case ch_watch::changes:
+      fired = changed;
+      break;
+    case ch_watch::rising:
+      fired = (rising != 0);
+      break;
+    }
+    watch.fired = fired;
+    any |= fired;
+  }
+  return any;
+}
+
+void watch_driver::notify(ch_tick tick) {
+  // callbacks may add or clear watches
+  for (uint32_t i = 0; i < watches_.size(); ++i) {
+    if (0 == watches_[i].fired)
+      continue;
+    watches_[i].fired = 0;
+    auto callback = callbacks_[i];
+    callback(tick);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct sim_cache {
+  struct entry_t {
+    context* eval_ctx;
+    sim_driver* driver;
+    uint32_t users;
+    // resolves once the first instance has built the design,
+    // false if it could not be shared.
+    std::shared_future<bool> built;
+  };
+
+  static sim_cache& instance() {
+    static sim_cache inst;
+    return inst;
+  }
+
+  std::mutex mutex;
+  std::map<std::vector<uint64_t>, entry_t> entries;
+};
+
+}
+
+// accumulates the wall time of the outermost simulation call
+class ch::internal::run_timer {
+public:
+
+  run_timer(simulatorimpl* sim) : sim_(sim) {
+    ++sim_->run_depth_;
+  }
+
+  ~run_timer() {
+    if (0 == --sim_->run_depth_) {
+      sim_->run_time_ += timer_.elapsed();
+    }
+  }
+
+private:
+  simulatorimpl* sim_;
+  stopwatch timer_;
+};
+
 simulatorimpl::simulatorimpl(const std::vector<device_base>& devices)
   : eval_ctx_(nullptr)
   , clk_driver_(false)
   , reset_driver_(false)
+  , compiled_watches_(false)
   , sim_driver_(nullptr)
   , ticks_(0)
+  , run_time_(0)
+  , run_depth_(0)
   , verbose_tracing_(false) {
   // enqueue all contexts
   for (auto dev : devices) {
@@ -48,7 +341,59 @@ simulatorimpl::simulatorimpl(const std::vector<device_base>& devices)
   }
 }
 
+simulatorimpl::simulatorimpl(const simulatorimpl& parent)
+  : contexts_(parent.contexts_)
+  , eval_ctx_(parent.eval_ctx_)
+  , clk_driver_(parent.clk_driver_.value())
+  , reset_driver_(parent.reset_driver_.value())
+  , scheduler_(parent.scheduler_)
+  , compiled_watches_(false)
+  , sim_driver_(nullptr)
+  , ticks_(parent.ticks_)
+  , run_time_(0)
+  , run_depth_(0)
+  , verbose_tracing_(parent.verbose_tracing_) {
+  // private copies of the io buffers
+  port_map_t port_map;
+  std::vector<ioportimpl*> ports;
+  parent.get_state_ports(ports);
+  for (auto port : ports) {
+    auto key = port->value().get();
+    if (fork_ports_.count(key))
+      continue;
+    auto src = parent.port_value(key);
+    io_value_t value(new sdata_type(*src));
+    port_map[src->words()] = value->words();
+    fork_ports_[key] = value;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sim_cache::instance().mutex);
+    for (auto ctx : contexts_) {
+      ctx->acquire();
+    }
+    eval_ctx_->acquire();
+    sim_driver_ = parent.sim_driver_->fork(port_map);
+    sim_driver_->acquire();
+  }
+
+  // bind system signals
+  auto clk = eval_ctx_->sys_clk();
+  if (clk) {
+    clk_driver_.add_signal(fork_ports_.at(clk->value().get()));
+  }
+  auto reset = eval_ctx_->sys_reset();
+  if (reset) {
+    reset_driver_.add_signal(fork_ports_.at(reset->value().get()));
+  }
+  scheduler_.bind(fork_ports_);
+}
+
 simulatorimpl::~simulatorimpl() {
+  // shared objects are released under the cache lock,
+  // instances may be destroyed on different threads.
+  this->drop_cache_entry();
+  std::lock_guard<std::mutex> lock(sim_cache::instance().mutex);
   if (sim_driver_) {
     sim_driver_->release();
   }
@@ -61,71 +406,183 @@ simulatorimpl::~simulatorimpl() {
 }
 
 void simulatorimpl::initialize() {
+  // simulators of the same contexts share the evaluation context
+  // and the compiled design, only the simulation state is per instance.
+  cache_key_.push_back(static_cast<uint64_t>(platform::self().cflags()));
+  cache_key_.push_back(verbose_tracing_);
+  for (auto ctx : contexts_) {
+    cache_key_.push_back(ctx->id());
+  }
+
+  // the first instance registers a placeholder and compiles outside the lock,
+  // later instances wait for it, builds of other designs proceed concurrently.
+  auto& cache = sim_cache::instance();
+  std::shared_ptr<std::promise<bool>> builder;
+  std::shared_future<bool> built;
   {
-    if (1 == contexts_.size()
-     && 0 == contexts_[0]->modules().size()) {
-      eval_ctx_ = contexts_[0];
-      eval_ctx_->acquire();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.entries.find(cache_key_);
+    if (it != cache.entries.end()) {
+      ++it->second.users;
+      built = it->second.built;
     } else {
-      eval_ctx_ = new context("eval");
-      eval_ctx_->acquire();
-
-      // build evaluation context
-      {
-        compiler compiler(eval_ctx_);
-        for (auto ctx : contexts_) {
-          compiler.create_merged_context(ctx, verbose_tracing_);
-        }
-        compiler.optimize();
-      }
+      builder = std::make_shared<std::promise<bool>>();
+      auto& entry = cache.entries[cache_key_];
+      entry.users = 1;
+      entry.eval_ctx = nullptr;
+      entry.driver = nullptr;
+      entry.built = builder->get_future().share();
     }
+  }
 
-    // build evaluation list
-    std::vector<lnodeimpl*> eval_list;
-    {
-      compiler compiler(eval_ctx_);
-      compiler.build_eval_list(eval_list);
+  if (builder) {
+    try {
+      this->build_driver();
+    } catch (...) {
+      this->drop_cache_entry();
+      builder->set_value(false);
+      throw;
     }
-
-    // initialize driver
-  #if defined(LIBJIT) || defined(LLVMJIT)
-    if (0 == (platform::self().cflags() & ch_flags::disable_jit)) {
-      sim_driver_ = new simjit::driver();
+    if (eval_ctx_->udfs().empty()) {
+      // keep a pristine copy of the initial state for new instances
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      auto& entry = cache.entries.at(cache_key_);
+      entry.eval_ctx = eval_ctx_;
+      entry.eval_ctx->acquire();
+      entry.driver = sim_driver_->fork(this->get_port_map());
+      entry.driver->acquire();
     } else {
-      sim_driver_ = new simref::driver();
+      // user-defined functions state lives in the design nodes,
+      // it cannot be shared across instances.
+      this->drop_cache_entry();
     }
-  #else
-    sim_driver_ = new simref::driver();
-  #endif
+    builder->set_value(!cache_key_.empty());
+  } else if (built.get()) {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto& entry = cache.entries.at(cache_key_);
+    eval_ctx_ = entry.eval_ctx;
+    eval_ctx_->acquire();
+    sim_driver_ = entry.driver->fork(this->get_port_map());
     sim_driver_->acquire();
-    sim_driver_->initialize(eval_list);
+  } else {
+    // the design could not be shared, it is compiled per instance
+    this->drop_cache_entry();
+    this->build_driver();
   }
 
   // bind system signals
   auto clk = eval_ctx_->sys_clk();
   if (clk) {
-    clk_driver_.add_signal(clk);
+    clk_driver_.add_signal(clk->value());
   }
   auto reset = eval_ctx_->sys_reset();
   if (reset) {
-    reset_driver_.add_signal(reset);
+    reset_driver_.add_signal(reset->value());
+  }
+}
+
+void simulatorimpl::drop_cache_entry() {
+  if (cache_key_.empty())
+    return;
+  auto& cache = sim_cache::instance();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto it = cache.entries.find(cache_key_);
+  if (it != cache.entries.end() && 0 == --it->second.users) {
+    if (it->second.driver) {
+      it->second.driver->release();
+      it->second.eval_ctx->release();
+    }
+    cache.entries.erase(it);
+  }
+  cache_key_.clear();
+}
+
+void simulatorimpl::build_driver() {
+  if (1 == contexts_.size()
+   && 0 == contexts_[0]->modules().size()) {
+    // the context may be acquired by concurrent builds
+    std::lock_guard<std::mutex> lock(sim_cache::instance().mutex);
+    eval_ctx_ = contexts_[0];
+    eval_ctx_->acquire();
+  } else {
+    eval_ctx_ = new context("eval");
+    eval_ctx_->acquire();
+
+    // build evaluation context
+    {
+      compiler compiler(eval_ctx_);
+      for (auto ctx : contexts_) {
+        compiler.create_merged_context(ctx, verbose_tracing_);
+      }
+      compiler.optimize();
+    }
+  }
+
+  auto& stats = eval_ctx_->build_stats();
+
+  // build evaluation list
+  std::vector<lnodeimpl*> eval_list;
+  {
+    stopwatch timer;
+    compiler compiler(eval_ctx_);
+    compiler.build_eval_list(eval_list);
+    stats.eval_list_time = timer.elapsed();
+    stats.eval_nodes = eval_list.size();
+  }
+
+  // initialize driver
+#if defined(LIBJIT) || defined(LLVMJIT)
+  if (0 == (platform::self().cflags() & ch_flags::disable_jit)) {
+    sim_driver_ = new simjit::driver();
+  } else {
+    sim_driver_ = new simref::driver();
+  }
+#else
+  sim_driver_ = new simref::driver();
+#endif
+  sim_driver_->acquire();
+  {
+    stopwatch timer;
+    sim_driver_->initialize(eval_list);
+    stats.compile_time = timer.elapsed();
+  }
+
+  // the port storage is final, let user-defined functions cache it
+  for (auto node : eval_ctx_->udfs()) {
+    reinterpret_cast<udfimpl*>(node)->udf()->bind();
+  }
+}
+
+port_map_t simulatorimpl::get_port_map() const {
+  port_map_t port_map;
+  std::vector<ioportimpl*> ports;
+  this->get_state_ports(ports);
+  for (auto port : ports) {
+    auto words = this->port_value(port->value().get())->words();
+    port_map[words] = words;
   }
+  return port_map;
 }
 
 void simulatorimpl::eval() {
-  sim_driver_->eval();
+  if (sim_driver_->eval()
+   || (!compiled_watches_ && !watches_.empty() && watches_.check())) {
+    watches_.notify(ticks_);
+  }
   ++ticks_;
 }
 
 void simulatorimpl::reset() {
+  // streams are not advanced during reset
   if (!reset_driver_.empty()) {
+    run_timer timer(this);
     reset_driver_.eval();
-    this->step(2);
+    this->eval_ticks(2);
     reset_driver_.eval();
   }
 }
 
-void simulatorimpl::step(ch_tick ticks) {  
+void simulatorimpl::eval_ticks(ch_tick ticks) {
   if (clk_driver_.empty()) {
     while (ticks--) {
       this->eval();
@@ -138,8 +595,71 @@ void simulatorimpl::step(ch_tick ticks) {
   }   
 }
 
+void simulatorimpl::step(ch_tick ticks) {  
+  run_timer timer(this);
+  if (streams_.empty()) {
+    this->eval_ticks(ticks);
+  } else {
+    auto cycle_ticks = this->cycle_ticks();
+    while (ticks--) {
+      streams_.pre_eval();
+      this->eval_ticks(1);
+      streams_.post_eval(cycle_ticks);
+    }
+  }
+}
+
+void simulatorimpl::bind_input_stream(const std::string& file,
+                                      const std::vector<const sdata_type*>& ports) {
+  std::vector<sdata_type*> values;
+  for (auto port : ports) {
+    values.push_back(this->port_value(port));
+  }
+  streams_.bind_inputs(file, values);
+}
+
+void simulatorimpl::bind_output_stream(const std::string& file,
+                                       const std::vector<const sdata_type*>& ports) {
+  std::vector<const sdata_type*> values;
+  for (auto port : ports) {
+    values.push_back(this->port_value(port));
+  }
+  streams_.bind_outputs(file, values);
+}
+
+ch_tick simulatorimpl::run_stream() {
+  CH_CHECK(streams_.has_inputs(), "no input stream was bound to the simulator");
+  run_timer timer(this);
+  this->reset();
+  auto cycle_ticks = this->cycle_ticks();
+  ch_tick cycles = 0;
+  while (streams_.remaining()) {
+    this->step(cycle_ticks);
+    ++cycles;
+  }
+  streams_.flush();
+  return cycles;
+}
+
+void simulatorimpl::add_watch(const sdata_type* port,
+                              ch_watch kind,
+                              const sdata_type& value,
+                              const std::function<void(ch_tick)>& callback) {
+  auto data = this->port_value(port);
+  CH_CHECK(ch_watch::rising != kind || 1 == data->size(), "rising edge watches require a single-bit port");
+  CH_CHECK(value.size() == data->size(), "invalid watch value size");
+  watches_.add(data, kind, value, callback);
+  compiled_watches_ = sim_driver_->bind_watches(watches_.data(), watches_.size());
+}
+
+void simulatorimpl::clear_watches() {
+  watches_.clear();
+  compiled_watches_ = sim_driver_->bind_watches(nullptr, 0);
+}
+
 ch_tick simulatorimpl::run(const std::function<bool(ch_tick)>& callback,
                            ch_tick steps) {
+  run_timer timer(this);
   this->reset();
   auto start = ticks_;
   for (; callback(ticks_ - start); ) {
@@ -149,12 +669,592 @@ ch_tick simulatorimpl::run(const std::function<bool(ch_tick)>& callback,
 }
 
 void simulatorimpl::run(ch_tick ticks) {
+  run_timer timer(this);
   this->reset();
   if (ticks > ticks_) {
     this->step(ticks - ticks_);
   }
 }
 
+void simulatorimpl::get_signals(std::vector<ioportimpl*>& signals) const {
+  auto clk = eval_ctx_->sys_clk();
+  if (clk) {
+    signals.emplace_back(clk);
+  }
+
+  auto reset = eval_ctx_->sys_reset();
+  if (reset) {
+    signals.emplace_back(reset);
+  }
+
+  for (auto node : eval_ctx_->inputs()) {
+    auto signal = reinterpret_cast<ioportimpl*>(node);
+    if (signal == clk || signal == reset)
+      continue;
+    signals.emplace_back(signal);
+  }
+
+  for (auto node : eval_ctx_->outputs()) {
+    signals.emplace_back(reinterpret_cast<ioportimpl*>(node));
+  }
+
+  for (auto node : eval_ctx_->taps()) {
+    signals.emplace_back(reinterpret_cast<ioportimpl*>(node));
+  }
+}
+
+bool simulatorimpl::replay(const std::string& file, ch_divergence* divergence) {
+  trace_reader reader(file);
+  auto& trace_signals = reader.signals();
+
+  std::vector<ioportimpl*> signals;
+  this->get_signals(signals);
+
+  // bind trace signals to ports by name,
+  // falling back to the tracer's port order when context ids differ.
+  std::vector<ioportimpl*> ports(trace_signals.size(), nullptr);
+  {
+    std::unordered_map<std::string, ioportimpl*> names;
+    for (auto signal : signals) {
+      names[signal->name()] = signal;
+    }
+    bool by_name = true;
+    for (uint32_t i = 0, n = trace_signals.size(); i < n; ++i) {
+      auto it = names.find(trace_signals[i].name);
+      if (it != names.end()) {
+        ports[i] = it->second;
+      } else if (type_input == trace_signals[i].type) {
+        by_name = false;
+        break;
+      }
+    }
+    if (!by_name) {
+      CH_CHECK(signals.size() == trace_signals.size(),
+               "trace file '%s' doesn't match the design ports", file.c_str());
+      for (uint32_t i = 0, n = trace_signals.size(); i < n; ++i) {
+        ports[i] = signals[i];
+      }
+    }
+    for (uint32_t i = 0, n = trace_signals.size(); i < n; ++i) {
+      auto port = ports[i];
+      if (nullptr == port)
+        continue;
+      CH_CHECK(port->type() == trace_signals[i].type
+            && port->size() == trace_signals[i].size,
+               "trace signal '%s' doesn't match the design port '%s'",
+               trace_signals[i].name.c_str(), port->name().c_str());
+    }
+  }
+
+  std::vector<std::pair<uint32_t, sdata_type*>> inputs, outputs;
+  for (uint32_t i = 0, n = ports.size(); i < n; ++i) {
+    auto port = ports[i];
+    if (nullptr == port)
+      continue;
+    auto value = this->port_value(port->value().get());
+    if (type_input == port->type()) {
+      inputs.emplace_back(i, value);
+    } else {
+      outputs.emplace_back(i, value);
+    }
+  }
+
+  auto values = reader.value_words();
+  while (reader.next_record()) {
+    // apply stimulus
+    for (auto& input : inputs) {
+      if (!reader.changed(input.first))
+        continue;
+      auto dst = input.second;
+      bv_copy(dst->words(), 0, values, reader.value_offset(input.first), dst->size());
+    }
+
+    this->eval();
+
+    // check outputs
+    for (auto& output : outputs) {
+      auto src = output.second;
+      if (0 == bv_cmp(src->words(), 0, values, reader.value_offset(output.first), src->size()))
+        continue;
+      if (divergence) {
+        divergence->tick     = reader.tick();
+        divergence->signal   = trace_signals[output.first].name;
+        divergence->expected = reader.value(output.first);
+        divergence->actual   = *src;
+      }
+      return false;
+    }
+  }
+
+  return true;
+}
+
+ch_coverage simulatorimpl::coverage() const {
+  ch_coverage coverage;
+  for (auto node : eval_ctx_->gtaps()) {
+    if (type_cover != node->type())
+      continue;
+    auto cover = reinterpret_cast<coverimpl*>(node);
+    auto counters = sim_driver_->coverage(cover);
+    auto& point = coverage.points.emplace_back();
+    point.name = cover->name();
+    for (uint32_t i = 0, n = cover->num_counters(); i < n; ++i) {
+      point.bins.push_back({cover->counter_name(i), counters[i]});
+    }
+  }
+  return coverage;
+}
+
+ch_sim_stats simulatorimpl::stats() const {
+  ch_sim_stats stats;
+
+  // every device and module context is optimized on construction,
+  // the merged evaluation context once more.
+  std::unordered_set<uint32_t> visited;
+  std::function<void(context*)> add_optimize = [&](context* ctx) {
+    if (!visited.insert(ctx->id()).second)
+      return;
+    auto& build_stats = ctx->build_stats();
+    stats.optimize_time += build_stats.optimize_time;
+    for (auto& pass : build_stats.passes) {
+      auto it = std::find_if(stats.passes.begin(), stats.passes.end(),
+                             [&](auto& p) { return p.name == pass.first; });
+      if (it != stats.passes.end()) {
+        it->deleted += pass.second;
+      } else {
+        stats.passes.push_back({pass.first, pass.second});
+      }
+    }
+    for (auto node : ctx->modules()) {
+      add_optimize(reinterpret_cast<moduleimpl*>(node)->target());
+    }
+  };
+  for (auto ctx : contexts_) {
+    stats.elaboration_time += ctx->build_stats().elaboration_time;
+    add_optimize(ctx);
+  }
+  add_optimize(eval_ctx_);
+
+  // the compiled design is shared by simulators of the same devices
+  auto& build_stats = eval_ctx_->build_stats();
+  stats.eval_list_time = build_stats.eval_list_time;
+  stats.compile_time = build_stats.compile_time;
+  stats.eval_nodes = build_stats.eval_nodes;
+  stats.num_nodes = eval_ctx_->nodes().size();
+  stats.code_size = sim_driver_->code_size();
+  stats.state_size = sim_driver_->state_size();
+
+  stats.run_time = run_time_;
+  stats.ticks = ticks_;
+  stats.cycles = ticks_ / this->cycle_ticks();
+  return stats;
+}
+
+simulatorimpl* simulatorimpl::fork() const {
+  // user-defined functions hold host state that cannot be duplicated
+  CH_CHECK(eval_ctx_->udfs().empty(), "cannot fork a simulation with user-defined functions");
+  return new simulatorimpl(*this);
+}
+
+void simulatorimpl::add_clock(const sdata_type* port, ch_tick period, ch_tick phase) {
+  io_value_t value;
+  if (!fork_ports_.empty()) {
+    auto it = fork_ports_.find(port);
+    if (it != fork_ports_.end()) {
+      value = it->second;
+    }
+  } else {
+    for (auto node : eval_ctx_->inputs()) {
+      auto input = reinterpret_cast<inputimpl*>(node);
+      if (input->value().get() == port) {
+        value = input->value();
+        break;
+      }
+    }
+  }
+  CH_CHECK(value.get() != nullptr, "invalid clock port");
+  scheduler_.add_clock(port, value, period, phase);
+}
+
+void simulatorimpl::advance(ch_tick duration) {
+  CH_CHECK(!scheduler_.empty(), "no clock was added to the simulator");
+  // only evaluate at clock edges
+  run_timer timer(this);
+  auto end = scheduler_.time() + duration;
+  while (scheduler_.advance(end)) {
+    this->eval();
+  }
+}
+
+sdata_type* simulatorimpl::port_value(const sdata_type* port) const {
+  if (fork_ports_.empty())
+    return const_cast<sdata_type*>(port);
+  auto it = fork_ports_.find(port);
+  CH_CHECK(it != fork_ports_.end(), "invalid simulator port");
+  return it->second.get();
+}
+
+static constexpr char STATE_MAGIC[8] = {'C', 'H', 'S', 'T', 'A', 'T', 'E', '\0'};
+static constexpr uint32_t STATE_VERSION = 2;
+
+void simulatorimpl::get_state_ports(std::vector<ioportimpl*>& ports) const {
+  this->get_signals(ports);
+  for (auto node : eval_ctx_->nodes()) {
+    if (type_udfin == node->type()
+     || type_udfout == node->type()) {
+      ports.push_back(reinterpret_cast<ioportimpl*>(node));
+    }
+  }
+}
+
+uint64_t simulatorimpl::design_hash() const {
+  // FNV-1a over the evaluation graph structure,
+  // node ids are not stable across contexts,
+  // sources are identified by their position in the node list.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto combine = [&](uint64_t value) {
+    hash = (hash ^ value) * 0x100000001b3ull;
+  };
+  std::unordered_map<uint32_t, uint32_t> indices;
+  for (auto node : eval_ctx_->nodes()) {
+    indices.emplace(node->id(), indices.size());
+  }
+  for (auto node : eval_ctx_->nodes()) {
+    combine(node->type());
+    combine(node->size());
+    combine(node->num_srcs());
+    for (auto& src : node->srcs()) {
+      auto it = indices.find(src.id());
+      combine((it != indices.end()) ? it->second : ~0u);
+    }
+    switch (node->type()) {
+    case type_lit: {
+      auto& value = reinterpret_cast<litimpl*>(node)->value();
+      for (uint32_t i = 0, n = value.num_words(); i < n; ++i) {
+        combine(value.word(i));
+      }
+    } break;
+    case type_op:
+      combine(uint32_t(reinterpret_cast<opimpl*>(node)->op()));
+      break;
+    case type_proxy:
+      for (auto& range : reinterpret_cast<proxyimpl*>(node)->ranges()) {
+        combine(range.src_idx);
+        combine(range.dst_offset);
+        combine(range.src_offset);
+        combine(range.length);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return hash;
+}
+
+void simulatorimpl::save(const std::string& file) const {
+  std::ofstream out(file, std::ios::binary);
+  CH_CHECK(out.is_open(), "couldn't create file '%s'", file.c_str());
+
+  auto write_u64 = [&](uint64_t value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+
+  out.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+  write_u64(STATE_VERSION);
+  write_u64(this->design_hash());
+  write_u64(ticks_);
+  write_u64(clk_driver_.value());
+  write_u64(reset_driver_.value());
+  scheduler_.save(out);
+
+  // port values
+  std::vector<ioportimpl*> ports;
+  this->get_state_ports(ports);
+  for (auto port : ports) {
+    auto& value = *this->port_value(port->value().get());
+    out.write(reinterpret_cast<const char*>(value.words()),
+              sizeof(block_type) * value.num_words());
+  }
+
+  // user-defined functions state
+  for (auto node : eval_ctx_->udfs()) {
+    reinterpret_cast<udfimpl*>(node)->udf()->save(out);
+  }
+
+  sim_driver_->save(out);
+  CH_CHECK(out.good(), "couldn't write file '%s'", file.c_str());
+}
+
+void simulatorimpl::restore(const std::string& file) {
+  std::ifstream in(file, std::ios::binary);
+  CH_CHECK(in.is_open(), "couldn't open file '%s'", file.c_str());
+
+  auto read_u64 = [&]() {
+    uint64_t value = 0;
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    CH_CHECK(in.good(), "corrupted checkpoint file '%s'", file.c_str());
+    return value;
+  };
+
+  char magic[sizeof(STATE_MAGIC)];
+  in.read(magic, sizeof(magic));
+  CH_CHECK(in.good() && 0 == memcmp(magic, STATE_MAGIC, sizeof(magic)),
+           "invalid checkpoint file '%s'", file.c_str());
+  CH_CHECK(STATE_VERSION == read_u64(),
+           "unsupported checkpoint file version in '%s'", file.c_str());
+  CH_CHECK(this->design_hash() == read_u64(),
+           "checkpoint file '%s' was saved from a different design", file.c_str());
+  ticks_ = read_u64();
+  clk_driver_.set_value(read_u64());
+  reset_driver_.set_value(read_u64());
+  scheduler_.restore(in);
+
+  // port values
+  std::vector<ioportimpl*> ports;
+  this->get_state_ports(ports);
+  for (auto port : ports) {
+    auto& value = *this->port_value(port->value().get());
+    in.read(reinterpret_cast<char*>(value.words()),
+            sizeof(block_type) * value.num_words());
+  }
+
+  // user-defined functions state
+  for (auto node : eval_ctx_->udfs()) {
+    reinterpret_cast<udfimpl*>(node)->udf()->restore(in);
+  }
+
+  sim_driver_->restore(in);
+  CH_CHECK(in.good(), "corrupted checkpoint file '%s'", file.c_str());
+}
+
+memimpl* simulatorimpl::find_memory(const std::string& name) const {
+  // merged designs prefix memory names with their module path
+  memimpl* found = nullptr;
+  for (auto node : eval_ctx_->mems()) {
+    auto& mem_name = node->name();
+    if (mem_name != name
+     && !(mem_name.size() > name.size()
+       && '/' == mem_name[mem_name.size() - name.size() - 1]
+       && 0 == mem_name.compare(mem_name.size() - name.size(), name.size(), name)))
+      continue;
+    CH_CHECK(nullptr == found, "ambiguous memory name '%s'", name.c_str());
+    found = reinterpret_cast<memimpl*>(node);
+  }
+  CH_CHECK(found != nullptr, "memory '%s' not found", name.c_str());
+  return found;
+}
+
+// backdoor transfers are split in chunks, the drivers take 32-bit lengths
+static constexpr uint32_t mem_chunk_size = (1 << 24);
+
+void simulatorimpl::load_memory(const std::string& name, const void* data, size_t size, uint32_t start) {
+  static constexpr uint32_t WORD_SIZE = bitwidth_v<block_type>;
+  auto mem = this->find_memory(name);
+  auto data_width = mem->data_width();
+  CH_CHECK(start <= mem->num_items(), "memory '%s' access out of range", name.c_str());
+  auto num_items = std::min<uint64_t>(uint64_t(size) * 8 / data_width, mem->num_items() - start);
+  auto offset = uint64_t(start) * data_width;
+  auto length = num_items * data_width;
+  auto bytes = reinterpret_cast<const uint8_t*>(data);
+  // aligned host buffers are copied from in place up to their last whole word
+  uint64_t body = 0;
+  if (0 == (reinterpret_cast<uintptr_t>(data) % alignof(block_type))) {
+    body = std::min<uint64_t>(length, uint64_t(size / sizeof(block_type)) * WORD_SIZE);
+  }
+  std::vector<block_type> buf;
+  for (uint64_t pos = 0; pos < length; pos += mem_chunk_size) {
+    auto len = uint32_t(std::min<uint64_t>(length - pos, mem_chunk_size));
+    auto direct = uint32_t(std::min<uint64_t>(len, body - std::min(body, pos)));
+    if (direct) {
+      sim_driver_->write_mem(mem, offset + pos, reinterpret_cast<const block_type*>(bytes + pos / 8), direct);
+    }
+    if (len > direct) {
+      buf.resize(ceildiv(len - direct, WORD_SIZE));
+      memcpy(buf.data(), bytes + (pos + direct) / 8, ceildiv<uint32_t>(len - direct, 8));
+      sim_driver_->write_mem(mem, offset + pos + direct, buf.data(), len - direct);
+    }
+  }
+}
+
+void simulatorimpl::dump_memory(const std::string& name, void* data, size_t size, uint32_t start) const {
+  static constexpr uint32_t WORD_SIZE = bitwidth_v<block_type>;
+  auto mem = this->find_memory(name);
+  auto data_width = mem->data_width();
+  CH_CHECK(start <= mem->num_items(), "memory '%s' access out of range", name.c_str());
+  auto num_items = std::min<uint64_t>(uint64_t(size) * 8 / data_width, mem->num_items() - start);
+  auto offset = uint64_t(start) * data_width;
+  auto length = num_items * data_width;
+  auto bytes = reinterpret_cast<uint8_t*>(data);
+  uint64_t body = 0;
+  if (0 == (reinterpret_cast<uintptr_t>(data) % alignof(block_type))) {
+    body = std::min<uint64_t>(length, uint64_t(size / sizeof(block_type)) * WORD_SIZE);
+  }
+  std::vector<block_type> buf;
+  for (uint64_t pos = 0; pos < length; pos += mem_chunk_size) {
+    auto len = uint32_t(std::min<uint64_t>(length - pos, mem_chunk_size));
+    auto direct = uint32_t(std::min<uint64_t>(len, body - std::min(body, pos)));
+    if (direct) {
+      sim_driver_->read_mem(mem, offset + pos, reinterpret_cast<block_type*>(bytes + pos / 8), direct);
+    }
+    if (len > direct) {
+      buf.resize(ceildiv(len - direct, WORD_SIZE));
+      sim_driver_->read_mem(mem, offset + pos + direct, buf.data(), len - direct);
+      memcpy(bytes + (pos + direct) / 8, buf.data(), ceildiv<uint32_t>(len - direct, 8));
+    }
+  }
+}
+
+void simulatorimpl::load_memory_file(const std::string& name, const std::string& file, uint32_t start) {
+  mapped_file mapping(file);
+  this->load_memory(name, mapping.data(), mapping.size(), start);
+}
+
+void simulatorimpl::dump_memory_file(const std::string& name, const std::string& file) const {
+  auto mem = this->find_memory(name);
+  std::vector<uint8_t> buf(ceildiv<uint64_t>(mem->bit_size(), 8));
+  this->dump_memory(name, buf.data(), buf.size(), 0);
+  std::ofstream out(file, std::ios::binary);
+  CH_CHECK(out.is_open(), "couldn't create file '%s'", file.c_str());
+  out.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+  CH_CHECK(out.good(), "couldn't write file '%s'", file.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double ch_coverage::ratio() const {
+  uint64_t total = 0, hits = 0;
+  for (auto& point : points) {
+    for (auto& bin : point.bins) {
+      hits += (bin.hits != 0);
+    }
+    total += point.bins.size();
+  }
+  return total ? (double(hits) / total) : 1.0;
+}
+
+void ch_coverage::merge(const ch_coverage& other) {
+  for (auto& other_point : other.points) {
+    auto point = std::find_if(points.begin(), points.end(), [&](const point_t& p) {
+      return p.name == other_point.name;
+    });
+    if (point == points.end()) {
+      points.push_back(other_point);
+      continue;
+    }
+    for (auto& other_bin : other_point.bins) {
+      auto bin = std::find_if(point->bins.begin(), point->bins.end(), [&](const bin_t& b) {
+        return b.name == other_bin.name;
+      });
+      if (bin == point->bins.end()) {
+        point->bins.push_back(other_bin);
+      } else {
+        bin->hits += other_bin.hits;
+      }
+    }
+  }
+}
+
+void ch_coverage::save(const std::string& file) const {
+  std::ofstream out(file);
+  CH_CHECK(out.is_open(), "couldn't create file '%s'", file.c_str());
+  for (auto& point : points) {
+    out << std::quoted(point.name) << " " << point.bins.size() << std::endl;
+    for (auto& bin : point.bins) {
+      out << std::quoted(bin.name) << " " << bin.hits << std::endl;
+    }
+  }
+}
+
+void ch_coverage::load(const std::string& file) {
+  std::ifstream in(file);
+  CH_CHECK(in.is_open(), "couldn't open file '%s'", file.c_str());
+  points.clear();
+  point_t point;
+  uint32_t num_bins;
+  while (in >> std::quoted(point.name) >> num_bins) {
+    point.bins.resize(num_bins);
+    for (auto& bin : point.bins) {
+      CH_CHECK(in >> std::quoted(bin.name) >> bin.hits,
+               "corrupted coverage file '%s'", file.c_str());
+    }
+    points.push_back(point);
+  }
+  CH_CHECK(in.eof(), "corrupted coverage file '%s'", file.c_str());
+}
+
+void ch_coverage::report(std::ostream& out) const {
+  auto percent = [](uint64_t hits, uint64_t total) {
+    return stringf("%.2f%%", total ? (100.0 * hits / total) : 100.0);
+  };
+  uint64_t total_hits = 0, total_bins = 0;
+  for (auto& point : points) {
+    uint64_t hits = 0;
+    for (auto& bin : point.bins) {
+      hits += (bin.hits != 0);
+    }
+    out << point.name << ": " << percent(hits, point.bins.size())
+        << " (" << hits << "/" << point.bins.size() << ")" << std::endl;
+    for (auto& bin : point.bins) {
+      out << "  " << bin.name << ": " << bin.hits << std::endl;
+    }
+    total_hits += hits;
+    total_bins += point.bins.size();
+  }
+  out << "total: " << percent(total_hits, total_bins)
+      << " (" << total_hits << "/" << total_bins << ")" << std::endl;
+}
+
+void ch_sim_stats::report(std::ostream& out) const {
+  auto seconds = [](double value) {
+    return stringf("%.6fs", value);
+  };
+  out << "elaboration: " << seconds(elaboration_time) << std::endl;
+  out << "optimization: " << seconds(optimize_time);
+  for (auto& pass : passes) {
+    out << ", " << pass.name << "=" << pass.deleted;
+  }
+  out << std::endl;
+  out << "scheduling: " << seconds(eval_list_time) << std::endl;
+  out << "compilation: " << seconds(compile_time) << std::endl;
+  out << "nodes: " << num_nodes << " (" << eval_nodes << " scheduled)" << std::endl;
+  out << "code size: " << code_size << " bytes" << std::endl;
+  out << "state size: " << state_size << " bytes" << std::endl;
+  out << "simulation: " << seconds(run_time) << ", " << ticks << " ticks, "
+      << cycles << " cycles (" << stringf("%.0f", cycles_per_sec()) << " cycles/sec)" << std::endl;
+}
+
+void ch_sim_stats::to_json(std::ostream& out) const {
+  auto number = [](double value) {
+    return stringf("%.9g", value);
+  };
+  out << "{" << std::endl;
+  out << "  \"elaboration_time\": " << number(elaboration_time) << "," << std::endl;
+  out << "  \"optimize_time\": " << number(optimize_time) << "," << std::endl;
+  out << "  \"eval_list_time\": " << number(eval_list_time) << "," << std::endl;
+  out << "  \"compile_time\": " << number(compile_time) << "," << std::endl;
+  out << "  \"run_time\": " << number(run_time) << "," << std::endl;
+  out << "  \"passes\": {";
+  for (size_t i = 0; i < passes.size(); ++i) {
+    out << (i ? ", " : "") << "\"" << passes[i].name << "\": " << passes[i].deleted;
+  }
+  out << "}," << std::endl;
+  out << "  \"num_nodes\": " << num_nodes << "," << std::endl;
+  out << "  \"eval_nodes\": " << eval_nodes << "," << std::endl;
+  out << "  \"code_size\": " << code_size << "," << std::endl;
+  out << "  \"state_size\": " << state_size << "," << std::endl;
+  out << "  \"ticks\": " << ticks << "," << std::endl;
+  out << "  \"cycles\": " << cycles << "," << std::endl;
+  out << "  \"cycles_per_sec\": " << number(cycles_per_sec()) << std::endl;
+  out << "}" << std::endl;
+}
+
+void ch_sim_stats::save(const std::string& file) const {
+  std::ofstream out(file);
+  CH_CHECK(out.is_open(), "couldn't create file '%s'", file.c_str());
+  this->to_json(out);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 ch_simulator::ch_simulator() : impl_(nullptr) {}
@@ -228,5 +1328,95 @@ void ch_simulator::step(ch_tick ticks) {
 }
 
 void ch_simulator::eval() {
+  // timed here rather than in simulatorimpl::eval(),
+  // which also runs once per tick inside run() and step().
+  run_timer timer(impl_);
   impl_->eval();
 }
+
+void ch_simulator::bind_input_stream(const std::string& file,
+                                     const std::vector<const sdata_type*>& ports) {
+  impl_->bind_input_stream(file, ports);
+}
+
+void ch_simulator::bind_output_stream(const std::string& file,
+                                      const std::vector<const sdata_type*>& ports) {
+  impl_->bind_output_stream(file, ports);
+}
+
+ch_tick ch_simulator::run_stream() {
+  return impl_->run_stream();
+}
+
+void ch_simulator::add_watch(const sdata_type& port,
+                             ch_watch kind,
+                             const sdata_type& value,
+                             const std::function<void(ch_tick)>& callback) {
+  impl_->add_watch(&port, kind, value, callback);
+}
+
+void ch_simulator::clear_watches() {
+  impl_->clear_watches();
+}
+
+bool ch_simulator::replay(const std::string& file, ch_divergence* divergence) {
+  return impl_->replay(file, divergence);
+}
+
+ch_coverage ch_simulator::coverage() const {
+  return impl_->coverage();
+}
+
+ch_sim_stats ch_simulator::stats() const {
+  return impl_->stats();
+}
+
+void ch_simulator::save(const std::string& file) const {
+  impl_->save(file);
+}
+
+void ch_simulator::restore(const std::string& file) {
+  impl_->restore(file);
+}
+
+ch_simulator ch_simulator::fork() const {
+  return ch_simulator(impl_->fork());
+}
+
+void ch_simulator::poke_port(const sdata_type& port, const sdata_type& value) {
+  auto dst = impl_->port_value(&port);
+  CH_CHECK(dst->size() == value.size(), "invalid port value size");
+  *dst = value;
+}
+
+const sdata_type& ch_simulator::peek_port(const sdata_type& port) const {
+  return *impl_->port_value(&port);
+}
+
+void ch_simulator::add_clock_port(const sdata_type& port, ch_tick period, ch_tick phase) {
+  impl_->add_clock(&port, period, phase);
+}
+
+void ch_simulator::advance(ch_tick duration) {
+  impl_->advance(duration);
+}
+
+ch_tick ch_simulator::time() const {
+  return impl_->time();
+}
+
+void ch_simulator::load_memory(const std::string& name, const void* data, size_t size, uint32_t start) {
+  impl_->load_memory(name, data, size, start);
+}
+
+void ch_simulator::dump_memory(const std::string& name, void* data, size_t size, uint32_t start) const {
+  impl_->dump_memory(name, data, size, start);
+}
+
+void ch_simulator::load_memory_file(const std::string& name, const std::string& file, uint32_t start) {
+  impl_->load_memory_file(name, file, start);
+}
+
+void ch_simulator::dump_memory_file(const std::string& name, const std::string& file) const {
+  impl_->dump_memory_file(name, file);
+}
@@ -6,14 +6,23 @@ namespace ch {
 namespace internal {
 
 class inputimpl;
+class memimpl;
+class ioportimpl;
+class mapped_file;
+class run_timer;
+struct ch_divergence;
+enum class ch_watch;
+struct ch_coverage;
+struct ch_sim_stats;
 using io_value_t = smart_ptr<sdata_type>;
+using port_map_t = std::unordered_map<const block_type*, block_type*>;
 
 class clock_driver {
 public:
 
   clock_driver(bool value = false) : value_(value) {}
 
-  void add_signal(inputimpl* node);
+  void add_signal(const io_value_t& value);
 
   void eval();
 
@@ -21,12 +30,60 @@ public:
     return nodes_.empty();
   }
 
+  bool value() const {
+    return value_;
+  }
+
+  void set_value(bool value);
+
 protected:
 
   std::vector<io_value_t> nodes_;
   bool value_;
 };
 
+class clock_scheduler {
+public:
+
+  clock_scheduler() : time_(0) {}
+
+  void add_clock(const sdata_type* port, const io_value_t& value, ch_tick period, ch_tick phase);
+
+  // rebind the clocks to a fork's ports
+  void bind(const std::unordered_map<const sdata_type*, io_value_t>& ports);
+
+  // move to the next clock edge up to the given time,
+  // returns false when there are no more edges.
+  bool advance(ch_tick end);
+
+  bool empty() const {
+    return clocks_.empty();
+  }
+
+  ch_tick time() const {
+    return time_;
+  }
+
+  void save(std::ostream& out) const;
+
+  // the clocks must have been added in the same order
+  void restore(std::istream& in);
+
+protected:
+
+  struct clock_t {
+    const sdata_type* port;
+    io_value_t value;
+    ch_tick high;
+    ch_tick low;
+    ch_tick next_edge;
+    bool level;
+  };
+
+  std::vector<clock_t> clocks_;
+  ch_tick time_;
+};
+
 class time_driver {
 public:
 
@@ -46,6 +103,119 @@ protected:
   uint64_t value_;
 };
 
+// input records applied at the start of every cycle and
+// output records captured at its end, each port takes a whole
+// number of bytes and records are packed back to back.
+class stream_driver {
+public:
+
+  stream_driver();
+
+  ~stream_driver();
+
+  void bind_inputs(const std::string& file, const std::vector<sdata_type*>& ports);
+
+  void bind_outputs(const std::string& file, const std::vector<const sdata_type*>& ports);
+
+  bool empty() const {
+    return inputs_.empty() && outputs_.empty();
+  }
+
+  bool has_inputs() const {
+    return !inputs_.empty();
+  }
+
+  // input records left to apply
+  uint64_t remaining() const {
+    return num_records_ - next_record_;
+  }
+
+  void pre_eval() {
+    if (0 == tick_) {
+      this->apply();
+    }
+  }
+
+  void post_eval(uint32_t cycle_ticks) {
+    if (++tick_ == cycle_ticks) {
+      tick_ = 0;
+      this->capture();
+    }
+  }
+
+  void flush();
+
+protected:
+
+  template <typename T>
+  struct field_t {
+    T* value;
+    uint32_t offset;
+  };
+
+  void apply();
+
+  void capture();
+
+  std::unique_ptr<mapped_file> input_file_;
+  std::vector<field_t<sdata_type>> inputs_;
+  uint32_t input_size_;
+  uint64_t num_records_;
+  uint64_t next_record_;
+  std::ofstream output_file_;
+  std::vector<field_t<const sdata_type>> outputs_;
+  uint32_t output_size_;
+  std::vector<uint8_t> output_buf_;
+  uint32_t output_pos_;
+  uint32_t tick_;
+};
+
+// value watches checked after every evaluation, drivers generating
+// code compile the checks, check() interprets them otherwise.
+class watch_driver {
+public:
+
+  struct watch_t {
+    const block_type* value;
+    block_type* prev;
+    const block_type* ref;
+    uint32_t size;
+    ch_watch kind;
+    uint32_t fired;
+  };
+
+  void add(const sdata_type* value,
+           ch_watch kind,
+           const sdata_type& ref,
+           const std::function<void(ch_tick)>& callback);
+
+  void clear();
+
+  bool empty() const {
+    return watches_.empty();
+  }
+
+  watch_t* data() {
+    return watches_.data();
+  }
+
+  uint32_t size() const {
+    return watches_.size();
+  }
+
+  // returns true when a watch fired
+  bool check();
+
+  // invoke the callbacks of the fired watches
+  void notify(ch_tick tick);
+
+protected:
+
+  std::vector<watch_t> watches_;
+  std::vector<std::unique_ptr<block_type[]>> buffers_;
+  std::vector<std::function<void(ch_tick)>> callbacks_;
+};
+
 class sim_driver : public refcounted {
 public:
 
@@ -55,7 +225,40 @@ public:
 
   virtual void initialize(const std::vector<lnodeimpl*>&) = 0;
 
-  virtual void eval() = 0;
+  // returns true when a compiled watch fired
+  virtual bool eval() = 0;
+
+  // compile value watches into the evaluation,
+  // returns false when the driver doesn't support it.
+  virtual bool bind_watches(watch_driver::watch_t* watches, uint32_t count) {
+    CH_UNUSED(watches, count);
+    return false;
+  }
+
+  // hit counters of a cover node
+  virtual const uint64_t* coverage(lnodeimpl* node) const = 0;
+
+  // bytes of generated machine code, 0 if unavailable
+  virtual uint64_t code_size() const {
+    return 0;
+  }
+
+  // bytes of simulation state
+  virtual uint64_t state_size() const = 0;
+
+  // serialize the sequential state
+  virtual void save(std::ostream& out) const = 0;
+
+  virtual void restore(std::istream& in) = 0;
+
+  // backdoor access to a memory's contents, offset and length are in bits
+  virtual void read_mem(memimpl* mem, uint64_t offset, block_type* dst, uint32_t length) const = 0;
+
+  virtual void write_mem(memimpl* mem, uint64_t offset, const block_type* src, uint32_t length) = 0;
+
+  // independent copy of the current state sharing the compiled design,
+  // ports maps the io buffers to the fork's own copies.
+  virtual sim_driver* fork(const port_map_t& ports) const = 0;
 };
 
 class simulatorimpl : public refcounted {
@@ -75,17 +278,92 @@ public:
 
   void run(ch_tick ticks);
 
+  void bind_input_stream(const std::string& file, const std::vector<const sdata_type*>& ports);
+
+  void bind_output_stream(const std::string& file, const std::vector<const sdata_type*>& ports);
+
+  ch_tick run_stream();
+
+  void add_watch(const sdata_type* port,
+                 ch_watch kind,
+                 const sdata_type& value,
+                 const std::function<void(ch_tick)>& callback);
+
+  void clear_watches();
+
   virtual void eval();
 
+  bool replay(const std::string& file, ch_divergence* divergence);
+
+  ch_coverage coverage() const;
+
+  ch_sim_stats stats() const;
+
+  void save(const std::string& file) const;
+
+  void restore(const std::string& file);
+
+  simulatorimpl* fork() const;
+
+  void add_clock(const sdata_type* port, ch_tick period, ch_tick phase);
+
+  void advance(ch_tick duration);
+
+  ch_tick time() const {
+    return scheduler_.time();
+  }
+
+  sdata_type* port_value(const sdata_type* port) const;
+
+  void load_memory(const std::string& name, const void* data, size_t size, uint32_t start);
+
+  void dump_memory(const std::string& name, void* data, size_t size, uint32_t start) const;
+
+  void load_memory_file(const std::string& name, const std::string& file, uint32_t start);
+
+  void dump_memory_file(const std::string& name, const std::string& file) const;
+
 protected:  
 
+  simulatorimpl(const simulatorimpl& parent);
+
+  void build_driver();
+
+  void drop_cache_entry();
+
+  void eval_ticks(ch_tick ticks);
+
+  uint32_t cycle_ticks() const {
+    return clk_driver_.empty() ? 1 : 2;
+  }
+
+  port_map_t get_port_map() const;
+
+  void get_signals(std::vector<ioportimpl*>& signals) const;
+
+  void get_state_ports(std::vector<ioportimpl*>& ports) const;
+
+  uint64_t design_hash() const;
+
+  friend class run_timer;
+
+  memimpl* find_memory(const std::string& name) const;
+
   std::vector<context*> contexts_;
   context*  eval_ctx_;
   clock_driver clk_driver_;
   clock_driver reset_driver_;
+  clock_scheduler scheduler_;
+  stream_driver streams_;
+  watch_driver watches_;
+  bool compiled_watches_;
   sim_driver* sim_driver_;
   ch_tick ticks_;
+  double run_time_;
+  uint32_t run_depth_;
   bool verbose_tracing_;
+  std::unordered_map<const sdata_type*, io_value_t> fork_ports_;
+  std::vector<uint64_t> cache_key_;
 };
 
 }
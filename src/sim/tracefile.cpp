@@ -0,0 +1,314 @@
+#include "tracefile.h"
+#include "tracer.h"
+
+using namespace ch::internal;
+
+static constexpr char TRACE_MAGIC[8] = {'C', 'H', 'T', 'R', 'A', 'C', 'E', '\0'};
+static constexpr uint32_t TRACE_VERSION = 2;
+
+template <typename T>
+static void write_raw(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool read_raw(std::istream& in, T* value) {
+  in.read(reinterpret_cast<char*>(value), sizeof(T));
+  return in.good();
+}
+
+// assign each signal a 64-bit aligned offset into the state buffer,
+// return the state size in bits
+static uint32_t layout_state(const std::vector<trace_signal_t>& signals,
+                             std::vector<uint32_t>& offsets) {
+  uint32_t width = 0;
+  offsets.resize(signals.size());
+  for (uint32_t i = 0, n = signals.size(); i < n; ++i) {
+    offsets[i] = width;
+    width += ceildiv(signals[i].size, bitwidth_v<uint64_t>) * bitwidth_v<uint64_t>;
+  }
+  return width;
+}
+
+// decode the record at offset into the state buffer,
+// return the offset of the next record
+static uint32_t decode_record(const block_type* src,
+                              uint32_t offset,
+                              const std::vector<trace_signal_t>& signals,
+                              const std::vector<uint32_t>& offsets,
+                              block_type* values) {
+  auto mask_offset = offset;
+  offset += signals.size();
+  for (uint32_t i = 0, n = signals.size(); i < n; ++i) {
+    if (!bv_get(src, mask_offset + i))
+      continue;
+    auto size = signals[i].size;
+    bv_copy(values, offsets[i], src, offset, size);
+    offset += size;
+  }
+  return offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+trace_writer::trace_writer(std::ostream& out,
+                           const std::vector<trace_signal_t>& signals,
+                           uint64_t ticks)
+  : out_(out)
+  , signals_(signals) {
+  auto state_width = layout_state(signals, offsets_);
+  values_.resize(state_width / bitwidth_v<block_type>);
+  out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  write_raw<uint32_t>(out, TRACE_VERSION);
+  write_raw<uint32_t>(out, signals.size());
+  write_raw<uint64_t>(out, ticks);
+  for (auto& signal : signals) {
+    write_raw<uint32_t>(out, signal.type);
+    write_raw<uint32_t>(out, signal.size);
+    write_raw<uint32_t>(out, signal.name.size());
+    out.write(signal.name.data(), signal.name.size());
+  }
+}
+
+void trace_writer::write_block(const block_t* data, uint32_t size, uint32_t count) {
+  write_raw<uint32_t>(out_, size);
+  write_raw<uint32_t>(out_, count);
+  out_.write(reinterpret_cast<const char*>(data),
+             sizeof(block_t) * ceildiv(size, bitwidth_v<block_t>));
+
+  // append the block end state
+  auto src = reinterpret_cast<const block_type*>(data);
+  for (uint32_t offset = 0; offset < size;) {
+    offset = decode_record(src, offset, signals_, offsets_, values_.data());
+  }
+  out_.write(reinterpret_cast<const char*>(values_.data()),
+             sizeof(block_type) * values_.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+trace_reader::trace_reader(const std::string& file)
+  : in_(file, std::ios::binary)
+  , file_(file)
+  , block_size_(0)
+  , block_count_(0)
+  , block_records_(0)
+  , state_pending_(false)
+  , offset_(0)
+  , mask_offset_(0)
+  , ticks_(0)
+  , tick_(0) {
+  CH_CHECK(in_.is_open(), "couldn't open trace file '%s'", file.c_str());
+
+  char magic[sizeof(TRACE_MAGIC)];
+  uint32_t version, num_signals;
+  in_.read(magic, sizeof(magic));
+  CH_CHECK(in_.good() && 0 == memcmp(magic, TRACE_MAGIC, sizeof(magic)),
+           "invalid trace file '%s'", file.c_str());
+  CH_CHECK(read_raw(in_, &version) && TRACE_VERSION == version,
+           "unsupported trace file version in '%s'", file.c_str());
+  CH_CHECK(read_raw(in_, &num_signals) && read_raw(in_, &ticks_),
+           "corrupted trace file '%s'", file.c_str());
+
+  signals_.resize(num_signals);
+  for (uint32_t i = 0; i < num_signals; ++i) {
+    auto& signal = signals_[i];
+    uint32_t name_len;
+    CH_CHECK(read_raw(in_, &signal.type)
+          && read_raw(in_, &signal.size)
+          && read_raw(in_, &name_len),
+             "corrupted trace file '%s'", file.c_str());
+    signal.name.resize(name_len);
+    in_.read(signal.name.data(), name_len);
+    CH_CHECK(in_.good(), "corrupted trace file '%s'", file.c_str());
+  }
+  // keep values word-aligned to speed up decoding
+  auto state_width = layout_state(signals_, offsets_);
+  values_.resize(state_width / bitwidth_v<block_type>);
+}
+
+bool trace_reader::next_block() {
+  uint32_t size, count;
+  if (state_pending_) {
+    in_.seekg(sizeof(block_type) * values_.size(), std::ios::cur);
+    state_pending_ = false;
+  }
+  if (!read_raw(in_, &size))
+    return false;
+  CH_CHECK(read_raw(in_, &count), "corrupted trace file '%s'", file_.c_str());
+  block_.resize(ceildiv(size, bitwidth_v<block_t>));
+  auto num_bytes = sizeof(block_t) * block_.size();
+  in_.read(reinterpret_cast<char*>(block_.data()), num_bytes);
+  CH_CHECK(in_.gcount() == std::streamsize(num_bytes),
+           "corrupted trace file '%s'", file_.c_str());
+  block_size_ = size;
+  block_count_ = count;
+  block_records_ = 0;
+  state_pending_ = true;
+  offset_ = 0;
+  return true;
+}
+
+bool trace_reader::next_record() {
+  while (offset_ >= block_size_) {
+    if (!this->next_block())
+      return false;
+  }
+  auto src = reinterpret_cast<const block_type*>(block_.data());
+  mask_offset_ = offset_;
+  offset_ = decode_record(src, offset_, signals_, offsets_, values_.data());
+  CH_CHECK(offset_ <= block_size_, "corrupted trace file '%s'", file_.c_str());
+  ++block_records_;
+  ++tick_;
+  return true;
+}
+
+void trace_reader::skip_block() {
+  if (!this->has_records())
+    return;
+  assert(state_pending_);
+  auto num_bytes = sizeof(block_type) * values_.size();
+  in_.read(reinterpret_cast<char*>(values_.data()), num_bytes);
+  CH_CHECK(in_.gcount() == std::streamsize(num_bytes),
+           "corrupted trace file '%s'", file_.c_str());
+  state_pending_ = false;
+  tick_ += block_count_ - block_records_;
+  block_records_ = block_count_;
+  offset_ = block_size_;
+}
+
+void trace_reader::sync(const trace_reader& other) {
+  assert(values_.size() == other.values_.size());
+  values_ = other.values_;
+  tick_ = other.tick_;
+  block_records_ = block_count_;
+  offset_ = block_size_;
+}
+
+sdata_type trace_reader::value(uint32_t index) const {
+  sdata_type value(signals_[index].size);
+  bv_copy(value.words(), 0, values_.data(), offsets_[index], value.size());
+  return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<ch_divergence>
+ch::internal::ch_traceDiff(const std::string& lhs_file,
+                           const std::string& rhs_file,
+                           uint32_t limit) {
+  std::vector<ch_divergence> divergences;
+  trace_reader lhs(lhs_file), rhs(rhs_file);
+  auto& lhs_signals = lhs.signals();
+  auto& rhs_signals = rhs.signals();
+
+  auto is_same_signal = [](const trace_signal_t& a, const trace_signal_t& b) {
+    return a.name == b.name && a.type == b.type && a.size == b.size;
+  };
+
+  // identical signal tables produce identical blocks for identical runs
+  bool same_layout = std::equal(lhs_signals.begin(), lhs_signals.end(),
+                                rhs_signals.begin(), rhs_signals.end(),
+                                is_same_signal);
+
+  // match signals by name, falling back to the signal order
+  // when context ids differ between the two runs.
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  {
+    std::unordered_map<std::string, uint32_t> names;
+    for (uint32_t i = 0, n = rhs_signals.size(); i < n; ++i) {
+      names[rhs_signals[i].name] = i;
+    }
+    for (uint32_t i = 0, n = lhs_signals.size(); i < n; ++i) {
+      auto it = names.find(lhs_signals[i].name);
+      if (it == names.end())
+        continue;
+      CH_CHECK(lhs_signals[i].size == rhs_signals[it->second].size,
+               "signal '%s' has different sizes", lhs_signals[i].name.c_str());
+      pairs.emplace_back(i, it->second);
+    }
+    if (pairs.empty() && lhs_signals.size() == rhs_signals.size()) {
+      for (uint32_t i = 0, n = lhs_signals.size(); i < n; ++i) {
+        if (lhs_signals[i].type != rhs_signals[i].type
+         || lhs_signals[i].size != rhs_signals[i].size) {
+          pairs.clear();
+          break;
+        }
+        pairs.emplace_back(i, i);
+      }
+    }
+    CH_CHECK(!pairs.empty(), "traces '%s' and '%s' have no common signals",
+             lhs_file.c_str(), rhs_file.c_str());
+  }
+
+  // one trace is a strict prefix of the other
+  auto add_length_divergence = [&]() {
+    divergences.push_back({std::min(lhs.ticks(), rhs.ticks()), "<length>",
+                           sdata_type(64, lhs.ticks()), sdata_type(64, rhs.ticks())});
+  };
+
+  std::vector<bool> diverged(pairs.size(), false);
+  uint32_t num_diverged = 0;
+  auto lhs_values = lhs.value_words();
+  auto rhs_values = rhs.value_words();
+
+  for (;;) {
+    if (same_layout
+     && 0 == num_diverged
+     && !lhs.has_records()
+     && !rhs.has_records()) {
+      // both runs are in sync at a block boundary,
+      // skip blocks with identical encoding.
+      bool lhs_valid = lhs.next_block();
+      bool rhs_valid = rhs.next_block();
+      if (lhs_valid != rhs_valid) {
+        add_length_divergence();
+        break;
+      }
+      if (!lhs_valid)
+        break;
+      auto& lhs_block = lhs.block_data();
+      auto& rhs_block = rhs.block_data();
+      if (lhs.block_size() == rhs.block_size()
+       && 0 == memcmp(lhs_block.data(), rhs_block.data(),
+                      lhs_block.size() * sizeof(trace_reader::block_t))) {
+        lhs.skip_block();
+        rhs.sync(lhs);
+        continue;
+      }
+    }
+
+    bool lhs_valid = lhs.next_record();
+    bool rhs_valid = rhs.next_record();
+    if (lhs_valid != rhs_valid) {
+      add_length_divergence();
+      break;
+    }
+    if (!lhs_valid)
+      break;
+
+    for (uint32_t k = 0, n = pairs.size(); k < n; ++k) {
+      auto l = pairs[k].first;
+      auto r = pairs[k].second;
+      if (!lhs.changed(l) && !rhs.changed(r))
+        continue;
+      bool equal = (0 == bv_cmp(lhs_values, lhs.value_offset(l),
+                                rhs_values, rhs.value_offset(r),
+                                lhs_signals[l].size));
+      if (equal) {
+        if (diverged[k]) {
+          diverged[k] = false;
+          --num_diverged;
+        }
+      } else if (!diverged[k]) {
+        diverged[k] = true;
+        ++num_diverged;
+        divergences.push_back({lhs.tick(), lhs_signals[l].name, lhs.value(l), rhs.value(r)});
+        if (limit && divergences.size() == limit)
+          return divergences;
+      }
+    }
+  }
+
+  return divergences;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "traits.h"
+
+namespace ch {
+namespace internal {
+
+//
+// binary trace file layout (host byte order):
+//   header  : magic[8], version(u32), num_signals(u32), ticks(u64)
+//   signals : { type(u32), size(u32), name_len(u32), name[name_len] }*
+//   blocks  : { size(u32), count(u32), words(u64)[ceil(size/64)], state }*
+// each record inside a block is a signal valid mask followed by the
+// values of the signals that changed since the previous record.
+// the state snapshot holds all signal values at the end of the block,
+// each padded to 64 bits, so that readers can skip a block without
+// decoding its records.
+//
+
+struct trace_signal_t {
+  std::string name;
+  uint32_t type;
+  uint32_t size;
+};
+
+class trace_writer {
+public:
+
+  using block_t = uint64_t;
+
+  trace_writer(std::ostream& out,
+               const std::vector<trace_signal_t>& signals,
+               uint64_t ticks);
+
+  void write_block(const block_t* data, uint32_t size, uint32_t count);
+
+protected:
+
+  std::ostream& out_;
+  std::vector<trace_signal_t> signals_;
+  std::vector<uint32_t> offsets_;
+  std::vector<block_type> values_;
+};
+
+class trace_reader {
+public:
+
+  using block_t = uint64_t;
+
+  trace_reader(const std::string& file);
+
+  const std::vector<trace_signal_t>& signals() const {
+    return signals_;
+  }
+
+  uint64_t ticks() const {
+    return ticks_;
+  }
+
+  // load the next block, return false at end of file
+  bool next_block();
+
+  // decode the next record, loading blocks as needed,
+  // return false at end of file
+  bool next_record();
+
+  // skip the remaining records of the current block,
+  // loading the block state snapshot
+  void skip_block();
+
+  // copy the decoded state of a reader with the same signals
+  void sync(const trace_reader& other);
+
+  // true if the current block still has records to decode
+  bool has_records() const {
+    return offset_ < block_size_;
+  }
+
+  const std::vector<block_t>& block_data() const {
+    return block_;
+  }
+
+  uint32_t block_size() const {
+    return block_size_;
+  }
+
+  uint32_t block_count() const {
+    return block_count_;
+  }
+
+  // index of the last decoded record
+  uint64_t tick() const {
+    return tick_ - 1;
+  }
+
+  bool changed(uint32_t index) const {
+    return bv_get(block_.data(), mask_offset_ + index);
+  }
+
+  // current value of signal
+  sdata_type value(uint32_t index) const;
+
+  const block_type* value_words() const {
+    return values_.data();
+  }
+
+  uint32_t value_offset(uint32_t index) const {
+    return offsets_[index];
+  }
+
+protected:
+
+  std::ifstream in_;
+  std::string file_;
+  std::vector<trace_signal_t> signals_;
+  std::vector<uint32_t> offsets_;
+  std::vector<block_type> values_;
+  std::vector<block_t> block_;
+  uint32_t block_size_;
+  uint32_t block_count_;
+  uint32_t block_records_;
+  bool state_pending_;
+  uint32_t offset_;
+  uint32_t mask_offset_;
+  uint64_t ticks_;
+  uint64_t tick_;
+};
+
+}
+}
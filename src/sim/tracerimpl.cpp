@@ -4,6 +4,7 @@
 #include "moduleimpl.h"
 #include "context.h"
 #include "verilogwriter.h"
+#include "tracefile.h"
 
 using namespace ch::internal;
 
@@ -30,6 +31,11 @@ auto remove_path = [](const std::string& path) {
   return (pos != std::string::npos) ? path.substr(pos+1) : path;
 };
 
+auto remove_extension = [](const std::string& file) {
+  auto pos = file.find_last_of('.');
+  return (pos != std::string::npos && pos > file.find_last_of('/')+1) ? file.substr(0, pos) : file;
+};
+
 tracerimpl::tracerimpl(const std::vector<device_base>& devices)
   : simulatorimpl(devices)
   , trace_width_(0)
@@ -57,38 +63,11 @@ void tracerimpl::initialize() {
   simulatorimpl::initialize();
 
   //--
-  auto add_signal = [&](ioportimpl* node) {
-    signals_.emplace_back(node);
-    return node->size();
-  };
+  this->get_signals(signals_);
 
-  //--
-  auto trace_width = 0;
-  auto clk = eval_ctx_->sys_clk();
-  if (clk) {
-    trace_width += add_signal(clk);
-  }
-
-  auto reset = eval_ctx_->sys_reset();
-  if (reset) {
-    trace_width += add_signal(reset);
-  }
-
-  for (auto node : eval_ctx_->inputs()) {
-    auto signal = reinterpret_cast<ioportimpl*>(node);
-    if (signal == clk || signal == reset)
-      continue;
-    trace_width += add_signal(signal);
-  }
-
-  for (auto node : eval_ctx_->outputs()) {
-    auto signal = reinterpret_cast<ioportimpl*>(node);
-    trace_width += add_signal(signal);
-  }
-
-  for (auto node : eval_ctx_->taps()) {
-    auto signal = reinterpret_cast<ioportimpl*>(node);
-    trace_width += add_signal(signal);
+  uint32_t trace_width = 0;
+  for (auto signal : signals_) {
+    trace_width += signal->size();
   }
 
   trace_width_ = trace_width + signals_.size();
@@ -133,6 +112,7 @@ void tracerimpl::eval() {
 
   // updsate offset
   trace_tail_->size = dst_offset;
+  ++trace_tail_->count;
 }
 
 void tracerimpl::allocate_trace(uint32_t block_width) {
@@ -207,6 +187,20 @@ void tracerimpl::toText(std::ofstream& out) const {
   }
 }
 
+void tracerimpl::toTrace(std::ofstream& out) const {
+  std::vector<trace_signal_t> signals;
+  for (auto signal : signals_) {
+    signals.push_back({signal->name(), signal->type(), signal->size()});
+  }
+
+  trace_writer writer(out, signals, ticks_);
+  auto trace_block = trace_head_;
+  while (trace_block) {
+    writer.write_block(trace_block->data, trace_block->size, trace_block->count);
+    trace_block = trace_block->next;
+  }
+}
+
 void tracerimpl::toVCD(std::ofstream& out) const {  
   dup_tracker<std::string> dup_mod_names;
   std::list<std::string> mod_stack;
@@ -313,6 +307,7 @@ void tracerimpl::toVCD(std::ofstream& out) const {
 
 void tracerimpl::toVerilog(std::ofstream& out,
                            const std::string& moduleFileName,
+                           const std::string& dataFilePrefix,
                            bool passthru) const {
   //--
   auto netlist_name = [&](lnodeimpl* node)->std::string {
@@ -402,6 +397,19 @@ void tracerimpl::toVerilog(std::ofstream& out,
     out.flags(oldflags);
   };
 
+  //--
+  auto print_hex = [](std::ostream& out, const bv_t& value) {
+    static const char digits[] = "0123456789abcdef";
+    for (int32_t i = ceildiv<int32_t>(value.size(), 4) - 1; i >= 0; --i) {
+      uint32_t pos = i * 4;
+      auto len = std::min<uint32_t>(4, value.size() - pos);
+      block_t nibble = 0;
+      bv_slice(&nibble, len, value.words(), pos);
+      out << digits[nibble];
+    }
+    out << '\n';
+  };
+
   //--
   auto print_module = [&](std::ostream& out, context* ctx) {
     auto_separator sep(", ");
@@ -467,17 +475,42 @@ void tracerimpl::toVerilog(std::ofstream& out,
       out << "end" << std::endl << std::endl;
     }
 
-    // declare simulation process
-    out << "initial begin" << std::endl;
+    // write stimulus and expected values into data files
+    std::vector<std::pair<ioportimpl*, uint32_t>> stim_signals, check_signals;
+    uint32_t stim_width = 0, check_width = 0;
+    for (auto it = signals_.rbegin(), end = signals_.rend(); it != end; ++it) {
+      auto signal = *it;
+      if (type_input == signal->type()) {
+        if (get_signal_name(signal) == "clk")
+          continue;
+        stim_signals.emplace_back(signal, stim_width);
+        stim_width += signal->size();
+      } else {
+        check_signals.emplace_back(signal, check_width);
+        check_width += signal->size();
+      }
+    }
+
+    auto stim_file  = dataFilePrefix + "_stimulus.hex";
+    auto check_file = dataFilePrefix + "_expected.hex";
+    uint64_t num_ticks = 0;
+    bv_t clk_value;
     {
-      auto_indent indent1(out);
+      std::ofstream stim_out(stim_file);
+      std::ofstream check_out(check_file);
+      bv_t stim_row(std::max<uint32_t>(stim_width, 1));
+      bv_t check_row(std::max<uint32_t>(check_width, 1));
+      std::vector<int32_t> row_offsets(signals_.size(), -1);
+      for (auto& signal : stim_signals) {
+        auto it = std::find(signals_.begin(), signals_.end(), signal.first);
+        row_offsets.at(it - signals_.begin()) = signal.second;
+      }
+      for (auto& signal : check_signals) {
+        auto it = std::find(signals_.begin(), signals_.end(), signal.first);
+        row_offsets.at(it - signals_.begin()) = signal.second;
+      }
 
-      uint64_t tc = 0, tp = 0;
       auto mask_width = valid_mask_.size();
-
-      std::vector<std::pair<block_t*, uint32_t>> 
-          prev_values(signals_.size(), std::make_pair<block_t*, uint32_t>(nullptr, 0));
-
       auto trace_block = trace_head_;
       while (trace_block) {
         auto src_block = trace_block->data;
@@ -485,106 +518,82 @@ void tracerimpl::toVerilog(std::ofstream& out,
         uint32_t src_offset = 0;
         while (src_offset < src_width) {
           uint32_t mask_offset = src_offset;
-          auto in_offset = mask_offset + mask_width;
-          auto out_offset = mask_offset + mask_width;
-          bool in_trace = false;
-          bool out_trace = false;
-          {
-            for (uint32_t i = 0, n = signals_.size(); i < n; ++i) {
-              bool valid = bv_get(src_block, mask_offset + i);
-              if (valid) {
-                auto signal = signals_[i];
-                auto signal_type = signal->type();
-                auto signal_size = signal->size();
-                auto signal_name = get_signal_name(signal);
-                if ((type_input != signal_type) // is not an input signal
-                 || (tc != 0 && signal_name == "clk")) {  // is not clk signal initialization
-                  in_offset += signal_size;
-                  continue;
-                }
-                if (!in_trace) {
-                  out << "#" << (tc - tp);
-                  tp = tc;
-                  in_trace = true;
-                }
-                auto value = get_value(src_block, signal_size, in_offset);
-                in_offset += signal_size;
-                out << " " << signal_name << "=";
-                print_value(out, value);
-                out << ";";
-              }
-            }
-            if (in_trace) {
-              out << std::endl;
+          src_offset += mask_width;
+          for (uint32_t i = 0, n = signals_.size(); i < n; ++i) {
+            if (!bv_get(src_block, mask_offset + i))
+              continue;
+            auto signal = signals_[i];
+            auto signal_size = signal->size();
+            auto row_offset = row_offsets[i];
+            if (row_offset >= 0) {
+              auto& row = (type_input == signal->type()) ? stim_row : check_row;
+              bv_copy(row.words(), row_offset, src_block, src_offset, signal_size);
+            } else if (0 == num_ticks) {
+              clk_value = get_value(src_block, signal_size, src_offset);
             }
+            src_offset += signal_size;
           }
+          print_hex(stim_out, stim_row);
+          print_hex(check_out, check_row);
+          ++num_ticks;
+        }
+        trace_block = trace_block->next;
+      }
+    }
 
+    // declare stimulus memories
+    auto max_tick = std::max<uint64_t>(num_ticks, 1) - 1;
+    out << "reg[" << (std::max<uint32_t>(stim_width, 1) - 1) << ":0] tb_stimulus[0:"
+        << max_tick << "];" << std::endl;
+    out << "reg[" << (std::max<uint32_t>(check_width, 1) - 1) << ":0] tb_expected[0:"
+        << max_tick << "];" << std::endl;
+    out << "reg[" << (std::max<uint32_t>(check_width, 1) - 1) << ":0] tb_value;" << std::endl;
+    out << "integer tb_tick;" << std::endl << std::endl;
+
+    // declare simulation process
+    out << "initial begin" << std::endl;
+    {
+      auto_indent indent1(out);
+      out << "$readmemh(\"" << stim_file << "\", tb_stimulus);" << std::endl;
+      out << "$readmemh(\"" << check_file << "\", tb_expected);" << std::endl;
+      if (has_clock) {
+        out << "clk = ";
+        print_value(out, clk_value);
+        out << ";" << std::endl;
+      }
+      out << "for (tb_tick = 0; tb_tick < " << num_ticks
+          << "; tb_tick = tb_tick + 1) begin" << std::endl;
+      {
+        auto_indent indent2(out);
+        if (stim_width) {
+          auto_separator sep(", ");
+          out << "{";
+          for (auto it = stim_signals.rbegin(), end = stim_signals.rend(); it != end; ++it) {
+            out << sep << get_signal_name(it->first);
+          }
+          out << "} = tb_stimulus[tb_tick];" << std::endl;
+        }
+        out << "#1;" << std::endl;
+        if (check_width) {
+          if (passthru) {
+            // only validate the final state
+            out << "if (tb_tick == " << (num_ticks - 1) << ") begin" << std::endl;
+          } else {
+            out << "begin" << std::endl;
+          }
           {
-            for (uint32_t i = 0, n = signals_.size(); i < n; ++i) {
-              auto signal = signals_[i];
-              auto signal_type = signal->type();
-              auto signal_size = signal->size();
-              auto signal_name = get_signal_name(signal);
-              bool valid = bv_get(src_block, mask_offset + i);
-              if (valid) {
-                if (type_input == signal_type) {
-                  out_offset += signal_size;
-                  continue;
-                }
-
-                auto& prev = prev_values.at(i);
-                prev.first = src_block;
-                prev.second = out_offset;
-
-                if (passthru
-                 && (tc + 1) < ticks_) {
-                  out_offset += signal_size;
-                  continue; // skip signals value validation
-                }
-
-                if (!out_trace) {
-                  out << "#" << (tc - tp + 1);
-                  tp = tc + 1;
-                  out_trace = true;
-                }
-
-                auto value = get_value(src_block, signal_size, out_offset);
-                out_offset += signal_size;
-                out << " `check(" << signal_name << ", ";
-                print_value(out, value);
-                out << ");";
-              } else {
-                if (type_input == signal_type)
-                  continue;
-
-                if (passthru
-                 && (tc + 1) < ticks_)
-                  continue;
-
-                if (!out_trace) {
-                  out << "#" << (tc - tp  + 1);
-                  tp = tc + 1;
-                  out_trace = true;
-                }
-
-                auto& prev = prev_values.at(i);
-                assert(prev.first);
-                auto value = get_value(prev.first, signal_size, prev.second);
-                out << " `check(" << signal_name << ", ";
-                print_value(out, value);
-                out << ");";
-              }
-            }
-            if (out_trace) {
-              out << std::endl;
+            auto_indent indent3(out);
+            out << "tb_value = tb_expected[tb_tick];" << std::endl;
+            for (auto it = check_signals.rbegin(), end = check_signals.rend(); it != end; ++it) {
+              auto signal = it->first;
+              out << "`check(" << get_signal_name(signal) << ", tb_value["
+                  << (it->second + signal->size() - 1) << ":" << it->second << "]);" << std::endl;
             }
           }
-
-          src_offset = in_offset;
-          ++tc;
+          out << "end" << std::endl;
         }
-        trace_block = trace_block->next;
       }
+      out << "end" << std::endl;
       out << "#1 $finish;" << std::endl;
     }
     out << "end" << std::endl << std::endl;
@@ -1517,10 +1526,23 @@ void ch_tracer::toVCD(std::ofstream& out) {
   return reinterpret_cast<tracerimpl*>(impl_)->toVCD(out);
 }
 
-void ch_tracer::toVerilog(std::ofstream& out,
+void ch_tracer::toTrace(std::ofstream& out) {
+  return reinterpret_cast<tracerimpl*>(impl_)->toTrace(out);
+}
+
+void ch_tracer::toVerilog(const std::string& file,
                           const std::string& moduleFileName,
                           bool passthru) {
-  return reinterpret_cast<tracerimpl*>(impl_)->toVerilog(out, moduleFileName, passthru);
+  std::ofstream out(file);
+  this->toVerilog(out, moduleFileName, passthru, remove_extension(file));
+}
+
+void ch_tracer::toVerilog(std::ofstream& out,
+                          const std::string& moduleFileName,
+                          bool passthru,
+                          const std::string& dataFilePrefix) {
+  auto prefix = dataFilePrefix.empty() ? (remove_extension(moduleFileName) + "_tb") : dataFilePrefix;
+  return reinterpret_cast<tracerimpl*>(impl_)->toVerilog(out, moduleFileName, prefix, passthru);
 }
 
 void ch_tracer::toVerilator(std::ofstream& out,
@@ -19,8 +19,11 @@ public:
 
   void toVCD(std::ofstream& out) const;
 
+  void toTrace(std::ofstream& out) const;
+
   void toVerilog(std::ofstream& out,
                  const std::string& moduleFileName,
+                 const std::string& dataFilePrefix,
                  bool passthru) const;
 
   void toVerilator(std::ofstream& out,
@@ -43,11 +46,13 @@ protected:
     trace_block_t(block_t* data)
       : data(data)
       , size(0)
+      , count(0)
       , next(nullptr)
     {}
 
     block_t* data;
     uint32_t size;
+    uint32_t count;
     trace_block_t* next;
   };
 
@@ -0,0 +1,244 @@
+#include "udfasync.h"
+
+using namespace ch::internal;
+
+udf_worker_pool& udf_worker_pool::instance() {
+  static udf_worker_pool pool;
+  return pool;
+}
+
+udf_worker_pool::udf_worker_pool() : running_(true) {
+  auto num_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&udf_worker_pool::run, this);
+  }
+}
+
+udf_worker_pool::~udf_worker_pool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void udf_worker_pool::submit(const std::function<void()>& task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  cv_.notify_one();
+}
+
+void udf_worker_pool::run() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&]{ return !tasks_.empty() || !running_; });
+      if (tasks_.empty())
+        break;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+udf_async_state::udf_async_state(udf_async_base* udf, uint32_t latency)
+  : udf_(udf)
+  , latency_(latency)
+  , issued_(0)
+  , running_(false) {
+  CH_CHECK(latency_ > 0, "invalid udf latency");
+}
+
+udf_async_state::~udf_async_state() {
+  this->wait_all();
+}
+
+void udf_async_state::add_port(bool is_output,
+                               const io_value_t& value,
+                               const io_value_t& shadow) {
+  auto& ports = is_output ? outputs_ : inputs_;
+  ports.push_back({value, shadow});
+  slots_.clear();
+}
+
+udf_async_state::slot_t& udf_async_state::get_slot(uint64_t index) {
+  if (slots_.empty()) {
+    slots_.resize(latency_);
+    for (auto& slot : slots_) {
+      for (auto& port : inputs_) {
+        slot.inputs.emplace_back(port.value->size());
+      }
+      for (auto& port : outputs_) {
+        slot.outputs.emplace_back(port.value->size());
+      }
+      slot.done = true;
+    }
+  }
+  return slots_[index % latency_];
+}
+
+void udf_async_state::commit(const slot_t& slot) {
+  for (uint32_t i = 0, n = outputs_.size(); i < n; ++i) {
+    auto& value = *outputs_[i].value;
+    value.copy(0, slot.outputs[i], 0, value.size());
+  }
+}
+
+void udf_async_state::eval() {
+  // commit the evaluation issued latency cycles ago,
+  // its slot is then reused for the current inputs.
+  auto& slot = this->get_slot(issued_);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]{ return slot.done; });
+  }
+  if (issued_ >= latency_) {
+    this->commit(slot);
+  }
+
+  for (uint32_t i = 0, n = inputs_.size(); i < n; ++i) {
+    auto& value = *inputs_[i].value;
+    slot.inputs[i].copy(0, value, 0, value.size());
+  }
+
+  bool start;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slot.done = false;
+    queue_.push_back(issued_ % latency_);
+    start = !running_;
+    running_ = true;
+  }
+  if (start) {
+    udf_worker_pool::instance().submit([this]() { this->drain(); });
+  }
+  ++issued_;
+}
+
+void udf_async_state::drain() {
+  for (;;) {
+    slot_t* slot;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.empty()) {
+        running_ = false;
+        cv_.notify_all();
+        break;
+      }
+      slot = &slots_[queue_.front()];
+      queue_.pop_front();
+    }
+
+    for (uint32_t i = 0, n = inputs_.size(); i < n; ++i) {
+      auto& shadow = *inputs_[i].shadow;
+      shadow.copy(0, slot->inputs[i], 0, shadow.size());
+    }
+    udf_->eval_async();
+    for (uint32_t i = 0, n = outputs_.size(); i < n; ++i) {
+      auto& shadow = *outputs_[i].shadow;
+      slot->outputs[i].copy(0, shadow, 0, shadow.size());
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slot->done = true;
+    }
+    cv_.notify_all();
+  }
+}
+
+void udf_async_state::wait_all() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&]{ return !running_; });
+}
+
+void udf_async_state::reset() {
+  // pending evaluations are discarded
+  this->wait_all();
+  for (auto& slot : slots_) {
+    slot.done = true;
+  }
+  issued_ = 0;
+  udf_->reset_async();
+  for (auto& port : outputs_) {
+    auto& value = *port.value;
+    value.copy(0, *port.shadow, 0, value.size());
+  }
+}
+
+void udf_async_state::save(std::ostream& out) {
+  // pending evaluations are completed before saving their results
+  this->wait_all();
+  out.write(reinterpret_cast<const char*>(&issued_), sizeof(issued_));
+  for (uint64_t i = 0, n = std::min<uint64_t>(issued_, latency_); i < n; ++i) {
+    auto& slot = this->get_slot(i);
+    for (auto& output : slot.outputs) {
+      out.write(reinterpret_cast<const char*>(output.words()),
+                sizeof(block_type) * output.num_words());
+    }
+  }
+  udf_->save_async(out);
+}
+
+void udf_async_state::restore(std::istream& in) {
+  this->wait_all();
+  in.read(reinterpret_cast<char*>(&issued_), sizeof(issued_));
+  for (uint64_t i = 0, n = std::min<uint64_t>(issued_, latency_); i < n; ++i) {
+    auto& slot = this->get_slot(i);
+    for (auto& output : slot.outputs) {
+      in.read(reinterpret_cast<char*>(output.words()),
+              sizeof(block_type) * output.num_words());
+    }
+    slot.done = true;
+  }
+  udf_->restore_async(in);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+udf_async_base::udf_async_base(uint32_t latency)
+  : state_(new udf_async_state(this, latency))
+{}
+
+udf_async_base::~udf_async_base() {
+  delete state_;
+}
+
+uint32_t udf_async_base::latency() const {
+  return state_->latency();
+}
+
+void udf_async_base::wait() const {
+  state_->wait_all();
+}
+
+void udf_async_base::eval() {
+  state_->eval();
+}
+
+void udf_async_base::reset() {
+  state_->reset();
+}
+
+void udf_async_base::save(std::ostream& out) const {
+  state_->save(out);
+}
+
+void udf_async_base::restore(std::istream& in) {
+  state_->restore(in);
+}
+
+void udf_async_base::add_port(bool is_output,
+                              const io_value_t& value,
+                              const io_value_t& shadow) {
+  state_->add_port(is_output, value, shadow);
+}
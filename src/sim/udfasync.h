@@ -0,0 +1,94 @@
+#pragma once
+
+#include "udf.h"
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+namespace ch {
+namespace internal {
+
+// shared worker threads executing asynchronous udf evaluations
+class udf_worker_pool {
+public:
+
+  static udf_worker_pool& instance();
+
+  void submit(const std::function<void()>& task);
+
+private:
+
+  udf_worker_pool();
+
+  ~udf_worker_pool();
+
+  void run();
+
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool running_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// evaluations of a given udf are queued in order and executed
+// one at a time, results are staged in a ring of latency slots.
+class udf_async_state {
+public:
+
+  udf_async_state(udf_async_base* udf, uint32_t latency);
+
+  ~udf_async_state();
+
+  uint32_t latency() const {
+    return latency_;
+  }
+
+  void add_port(bool is_output, const io_value_t& value, const io_value_t& shadow);
+
+  void eval();
+
+  void reset();
+
+  void save(std::ostream& out);
+
+  void restore(std::istream& in);
+
+  void wait_all();
+
+private:
+
+  struct port_t {
+    io_value_t value;
+    io_value_t shadow;
+  };
+
+  struct slot_t {
+    std::vector<sdata_type> inputs;
+    std::vector<sdata_type> outputs;
+    bool done;
+  };
+
+  slot_t& get_slot(uint64_t index);
+
+  void commit(const slot_t& slot);
+
+  void drain();
+
+  udf_async_base* udf_;
+  uint32_t latency_;
+  std::vector<port_t> inputs_;
+  std::vector<port_t> outputs_;
+  std::vector<slot_t> slots_;
+  std::deque<uint32_t> queue_;
+  uint64_t issued_;
+  bool running_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}
+}
@@ -1,5 +1,7 @@
 #include "common.h"
 #include <limits>
+#include <filesystem>
+#include <unistd.h>
 
 static int g_test_number = 0;
 
@@ -212,3 +214,8 @@ bool checkVerilog(const std::string& file) {
           | system(stringf("! vvp %s.iv | grep 'ERROR' || false", file.c_str()).c_str());
   return (0 == ret);
 }
+
+std::string tempFile(const std::string& name) {
+  auto file = stringf("cash_%d_%s", getpid(), name.c_str());
+  return (std::filesystem::temp_directory_path() / file).string();
+}
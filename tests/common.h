@@ -171,6 +171,9 @@ auto TestFunction(F&& f, const T0& a, const T1& b, const T2& c, const T2& d) {
 
 bool checkVerilog(const std::string& moduleName);
 
+// unique path in the system temporary directory
+std::string tempFile(const std::string& name);
+
 bool TEST(const std::function<ch_bool()> &test, ch_tick cycles = 0, CH_SLOC);
 
 bool TESTG(const std::function<ch_bool()> &test, ch_tick cycles = 0, CH_SLOC);
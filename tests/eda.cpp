@@ -0,0 +1,672 @@
+#include "common.h"
+#include <eda/altera/avalon_sim.h>
+#include <eda/arm/axi4_sim.h>
+
+using namespace eda::altera::avalon;
+using namespace eda::arm::axi4;
+
+namespace {
+
+// drives the Avalon slave driver with a single port and 8-byte data
+class AvmDriver : public avm_slave_driver_base {
+public:
+
+  static constexpr uint32_t data_size = 8;
+  static constexpr uint32_t max_burst = 4;
+  static constexpr uint32_t queue_size = 8;
+
+  AvmDriver(uint32_t latency, const std::optional<avm_dram_config>& dram = std::nullopt)
+    : avm_slave_driver_base(1, data_size, max_burst, queue_size, latency, dram)
+    , req_({})
+    , time_(0)
+  {}
+
+  using avm_slave_driver_base::bind;
+
+  // submits a request, returns the cycle it was accepted
+  uint64_t submit(bool write, uint64_t address, uint32_t burstcount = 1,
+                  const uint8_t* wdata = nullptr, uint64_t byteenable = 0xff) {
+    req_ = request_t{write, wdata, address, byteenable, burstcount};
+    for (;;) {
+      auto accepted = time_;
+      auto status = this->step(true);
+      if (0 == (status.wait_mask & 0x1))
+        return accepted;
+    }
+  }
+
+  // waits for the next response, returns its cycle and read data
+  std::pair<uint64_t, const uint8_t*> wait() {
+    for (;;) {
+      auto time = time_;
+      auto status = this->step(false);
+      if (0 == status.rsp_channel)
+        return std::make_pair(time, status.rsp_wdata);
+    }
+  }
+
+  // runs idle cycles until the given time
+  void idle(uint64_t time) {
+    while (time_ < time) {
+      this->step(false);
+    }
+  }
+
+  std::vector<uint64_t> responses;
+
+protected:
+
+  status_t step(bool request) {
+    auto status = avm_slave_driver_base::tick(request ? 0x1 : 0x0);
+    if (0 == status.rsp_channel) {
+      responses.push_back(time_);
+    }
+    ++time_;
+    return status;
+  }
+
+  request_t get_request_info(uint32_t) override {
+    return req_;
+  }
+
+  request_t req_;
+  uint64_t time_;
+};
+
+// drives the AXI4 slave driver with a single port and 8-byte data
+class Axi4Driver : public axi4_slave_driver_base {
+public:
+
+  static constexpr uint32_t data_size = 8;
+
+  struct rbeat_t {
+    uint64_t time;
+    uint32_t id;
+    bool last;
+    const uint8_t* data;
+  };
+
+  struct bresp_t {
+    uint64_t time;
+    uint32_t id;
+  };
+
+  Axi4Driver(const axi4_config& config = axi4_config())
+    : axi4_slave_driver_base(1, data_size, config)
+    , master({})
+    , slave({})
+    , aw_count(0)
+    , ar_count(0)
+    , time_(0) {
+    master.bready = true;
+    master.rready = true;
+  }
+
+  using axi4_slave_driver_base::bind;
+
+  // issues a read burst, returns the cycle it was accepted
+  uint64_t read(uint32_t id, uint64_t addr, uint32_t len, axi4_burst burst, uint32_t size = 3) {
+    master.arvalid = true;
+    master.ar = addr_t{id, addr, len - 1, size, uint32_t(burst)};
+    auto time = this->wait_ready(slave.arready);
+    master.arvalid = false;
+    return time;
+  }
+
+  // issues a write burst address, returns the cycle it was accepted
+  uint64_t write(uint32_t id, uint64_t addr, uint32_t len, axi4_burst burst, uint32_t size = 3) {
+    master.awvalid = true;
+    master.aw = addr_t{id, addr, len - 1, size, uint32_t(burst)};
+    auto time = this->wait_ready(slave.awready);
+    master.awvalid = false;
+    return time;
+  }
+
+  // transfers a write data beat
+  void write_data(const uint8_t* data, uint64_t wstrb, bool last) {
+    master.wvalid = true;
+    master.wdata = data;
+    master.wstrb = wstrb;
+    master.wlast = last;
+    this->wait_ready(slave.wready);
+    master.wvalid = false;
+  }
+
+  void wait_reads(size_t count) {
+    while (rbeats.size() < count) {
+      this->step();
+    }
+  }
+
+  void wait_writes(size_t count) {
+    while (bresps.size() < count) {
+      this->step();
+    }
+  }
+
+  void run(uint64_t cycles) {
+    for (uint64_t i = 0; i < cycles; ++i) {
+      this->step();
+    }
+  }
+
+  uint64_t time() const {
+    return time_;
+  }
+
+  master_t master;
+  slave_t slave;
+  std::vector<rbeat_t> rbeats;
+  std::vector<bresp_t> bresps;
+  uint32_t aw_count;
+  uint32_t ar_count;
+
+protected:
+
+  // a transfer completes on the cycle where valid and ready are both asserted
+  void step() {
+    if (master.awvalid && slave.awready) {
+      ++aw_count;
+    }
+    if (master.arvalid && slave.arready) {
+      ++ar_count;
+    }
+    if (slave.rvalid && master.rready) {
+      rbeats.push_back({time_, slave.rid, slave.rlast, slave.rdata});
+    }
+    if (slave.bvalid && master.bready) {
+      bresps.push_back({time_, slave.bid});
+    }
+    axi4_slave_driver_base::tick(&master, &slave);
+    ++time_;
+  }
+
+  uint64_t wait_ready(const bool& ready) {
+    for (;;) {
+      auto time = time_;
+      bool accepted = ready;
+      this->step();
+      if (accepted)
+        return time;
+    }
+  }
+
+  uint64_t time_;
+};
+
+template <typename AXI>
+struct Axi4Passthru {
+  __io (
+    (ch_flip_io<axi4_mm_io<AXI>>) in,
+    (axi4_mm_io<AXI>) out
+  );
+
+  void describe() {
+    io.out(io.in);
+  }
+};
+
+avm_dram_config dram_config() {
+  avm_dram_config dram;
+  dram.num_banks = 2;
+  dram.row_size = 64;
+  dram.tCAS = 3;
+  dram.tRCD = 5;
+  dram.tRP  = 7;
+  dram.tREFI = 0;
+  return dram;
+}
+
+}
+
+TEST_CASE("avalon", "[avalon]") {
+  SECTION("latency", "[latency]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(64);
+      AvmDriver driver(5);
+      driver.bind(0, buffer.data(), buffer.size());
+      auto t0 = driver.submit(false, 0);
+      auto r0 = driver.wait();
+      ret &= (r0.first - t0) == 5;
+      ret &= (r0.second == buffer.data());
+      auto t1 = driver.submit(false, 8);
+      auto r1 = driver.wait();
+      ret &= (r1.first - t1) == 5;
+      ret &= (r1.second == buffer.data() + 8);
+      ret &= (driver.stats().reads == 2);
+      ret &= (driver.stats().row_hits + driver.stats().row_misses == 0);
+      return !!ret;
+    });
+  }
+
+  SECTION("rows", "[rows]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      AvmDriver driver(1, dram_config());
+      driver.bind(0, buffer.data(), buffer.size());
+      // bank 0 row 0 miss: tRCD + tCAS
+      auto t = driver.submit(false, 0);
+      ret &= (driver.wait().first - t) == 5 + 3 + 1;
+      // same row hit: tCAS
+      t = driver.submit(false, 8);
+      ret &= (driver.wait().first - t) == 3 + 1;
+      // bank 0 row 1 conflict: tRP + tRCD + tCAS
+      t = driver.submit(false, 128);
+      ret &= (driver.wait().first - t) == 7 + 5 + 3 + 1;
+      // bank 1 row 0 miss
+      t = driver.submit(false, 64);
+      ret &= (driver.wait().first - t) == 5 + 3 + 1;
+      // bank 0 row 1 is still open
+      t = driver.submit(false, 136);
+      ret &= (driver.wait().first - t) == 3 + 1;
+      auto& stats = driver.stats();
+      ret &= (stats.row_hits == 2);
+      ret &= (stats.row_misses == 2);
+      ret &= (stats.row_conflicts == 1);
+      ret &= (stats.refreshes == 0);
+      ret &= (stats.reads == 5);
+      ret &= (stats.max_latency == 16);
+      return !!ret;
+    });
+  }
+
+  SECTION("refresh", "[refresh]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      auto dram = dram_config();
+      dram.tREFI = 50;
+      dram.tRFC = 20;
+      AvmDriver driver(1, dram);
+      driver.bind(0, buffer.data(), buffer.size());
+      auto t = driver.submit(false, 0);
+      ret &= (driver.wait().first - t) == 5 + 3 + 1;
+      // the request waits for the refresh to complete and the row is closed
+      driver.idle(55);
+      t = driver.submit(false, 8);
+      ret &= (t >= 50 && t < 70);
+      ret &= driver.wait().first == 70 + 5 + 3 + 1;
+      // the row stays open until the next refresh
+      t = driver.submit(false, 16);
+      ret &= (t < 100);
+      ret &= (driver.wait().first - t) == 3 + 1;
+      ret &= (driver.stats().refreshes == 1);
+      // the second refresh closes the row again
+      driver.idle(120);
+      t = driver.submit(false, 24);
+      ret &= (driver.wait().first - t) == 5 + 3 + 1;
+      auto& stats = driver.stats();
+      ret &= (stats.refreshes == 2);
+      ret &= (stats.row_hits == 1);
+      ret &= (stats.row_misses == 3);
+      ret &= (stats.row_conflicts == 0);
+      return !!ret;
+    });
+  }
+
+  SECTION("bus", "[bus]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      {
+        // unlimited bus, the burst is returned on consecutive cycles
+        AvmDriver driver(1, dram_config());
+        driver.bind(0, buffer.data(), buffer.size());
+        auto t = driver.submit(false, 0, 4);
+        driver.idle(t + 20);
+        ret &= (driver.responses.size() == 4);
+        for (uint32_t i = 0; i < driver.responses.size(); ++i) {
+          ret &= (driver.responses[i] - t) == 5 + 3 + 1 + i;
+        }
+      }
+      {
+        // 2 bytes per cycle, each 8-byte beat holds the bus for 4 cycles
+        auto dram = dram_config();
+        dram.bus_width = 2;
+        AvmDriver driver(1, dram);
+        driver.bind(0, buffer.data(), buffer.size());
+        auto t = driver.submit(false, 0, 4);
+        driver.idle(t + 40);
+        ret &= (driver.responses.size() == 4);
+        for (uint32_t i = 0; i < driver.responses.size(); ++i) {
+          ret &= (driver.responses[i] - t) == 5 + 3 + 4 * (i + 1) + 1;
+        }
+        ret &= (driver.stats().row_misses == 1);
+        ret &= (driver.stats().row_hits == 3);
+        ret &= (driver.stats().bytes_read == 32);
+      }
+      return !!ret;
+    });
+  }
+
+  SECTION("queue", "[queue]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      // more requests than the queue capacity to wrap around the ring buffers
+      uint32_t count = 5 * AvmDriver::queue_size;
+      std::vector<uint8_t> buffer(count * AvmDriver::data_size);
+      AvmDriver driver(3);
+      driver.bind(0, buffer.data(), buffer.size());
+      for (uint32_t i = 0; i < count; ++i) {
+        uint8_t wdata[AvmDriver::data_size];
+        for (uint32_t j = 0; j < AvmDriver::data_size; ++j) {
+          wdata[j] = i + j;
+        }
+        // partial writes on odd entries only update the low half
+        driver.submit(true, i * AvmDriver::data_size, 1, wdata, (i & 1) ? 0x0f : 0xff);
+      }
+      driver.flush();
+      for (uint32_t i = 0; i < count; ++i) {
+        for (uint32_t j = 0; j < AvmDriver::data_size; ++j) {
+          uint8_t expected = ((i & 1) && j >= 4) ? 0 : (i + j);
+          ret &= (buffer[i * AvmDriver::data_size + j] == expected);
+        }
+      }
+      for (uint32_t i = 0; i < count; i += AvmDriver::max_burst) {
+        driver.submit(false, i * AvmDriver::data_size, AvmDriver::max_burst);
+      }
+      driver.flush();
+      ret &= (driver.stats().reads == count);
+      ret &= (driver.stats().writes == count);
+      ret &= (driver.stats().bytes_written == count * AvmDriver::data_size);
+      // responses are returned in order
+      std::vector<uint8_t> result;
+      for (uint32_t i = 0; i < count; i += AvmDriver::max_burst) {
+        driver.submit(false, i * AvmDriver::data_size, AvmDriver::max_burst);
+        for (uint32_t k = 0; k < AvmDriver::max_burst; ++k) {
+          auto rsp = driver.wait();
+          result.insert(result.end(), rsp.second, rsp.second + AvmDriver::data_size);
+        }
+      }
+      ret &= (result == buffer);
+      return !!ret;
+    });
+  }
+}
+
+TEST_CASE("axi4", "[axi4]") {
+  SECTION("bursts", "[bursts]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      for (uint32_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = i;
+      }
+      Axi4Driver driver;
+      driver.bind(0, buffer.data(), buffer.size());
+      auto base = buffer.data();
+      // incrementing
+      driver.read(0, 16, 4, axi4_burst::incr);
+      driver.wait_reads(4);
+      for (uint32_t i = 0; i < 4; ++i) {
+        ret &= (driver.rbeats[i].data == base + 16 + 8 * i);
+        ret &= (driver.rbeats[i].last == (3 == i));
+      }
+      // wrapping at the 32-byte burst boundary
+      driver.read(0, 40, 4, axi4_burst::wrap);
+      driver.wait_reads(8);
+      ret &= (driver.rbeats[4].data == base + 40);
+      ret &= (driver.rbeats[5].data == base + 48);
+      ret &= (driver.rbeats[6].data == base + 56);
+      ret &= (driver.rbeats[7].data == base + 32);
+      ret &= driver.rbeats[7].last;
+      // fixed
+      driver.read(0, 64, 3, axi4_burst::fixed);
+      driver.wait_reads(11);
+      for (uint32_t i = 8; i < 11; ++i) {
+        ret &= (driver.rbeats[i].data == base + 64);
+      }
+      // narrow incrementing, beats are aligned to the transfer size
+      driver.read(0, 6, 4, axi4_burst::incr, 1);
+      driver.wait_reads(15);
+      ret &= (driver.rbeats[11].data == base + 0);
+      ret &= (driver.rbeats[12].data == base + 8);
+      ret &= (driver.rbeats[13].data == base + 8);
+      ret &= (driver.rbeats[14].data == base + 8);
+
+      uint8_t wdata[2][Axi4Driver::data_size];
+      for (uint32_t i = 0; i < Axi4Driver::data_size; ++i) {
+        wdata[0][i] = 0xa0 + i;
+        wdata[1][i] = 0xb0 + i;
+      }
+      driver.write(1, 128, 2, axi4_burst::incr);
+      driver.write_data(wdata[0], 0xff, false);
+      driver.write_data(wdata[1], 0xff, true);
+      driver.write(1, 200, 2, axi4_burst::wrap);
+      driver.write_data(wdata[0], 0xff, false);
+      driver.write_data(wdata[1], 0xff, true);
+      driver.write(1, 160, 2, axi4_burst::fixed);
+      driver.write_data(wdata[0], 0xff, false);
+      driver.write_data(wdata[1], 0xff, true);
+      driver.wait_writes(3);
+      ret &= (0 == memcmp(base + 128, wdata[0], 8));
+      ret &= (0 == memcmp(base + 136, wdata[1], 8));
+      ret &= (0 == memcmp(base + 200, wdata[0], 8));
+      ret &= (0 == memcmp(base + 192, wdata[1], 8));
+      ret &= (0 == memcmp(base + 160, wdata[1], 8));
+      ret &= (buffer[168] == 168);
+      ret &= (buffer[208] == 208);
+      return !!ret;
+    });
+  }
+
+  SECTION("wstrb", "[wstrb]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(64, 0xff);
+      Axi4Driver driver;
+      driver.bind(0, buffer.data(), buffer.size());
+      uint8_t wdata[Axi4Driver::data_size] = {0, 1, 2, 3, 4, 5, 6, 7};
+      driver.write(0, 8, 2, axi4_burst::incr);
+      driver.write_data(wdata, 0x5a, false);
+      driver.write_data(wdata, 0x01, true);
+      driver.wait_writes(1);
+      uint8_t expected[16] = {0xff, 1, 0xff, 3, 4, 0xff, 6, 0xff,
+                              0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+      ret &= (0 == memcmp(buffer.data() + 8, expected, 16));
+      ret &= (buffer[7] == 0xff);
+      ret &= (buffer[24] == 0xff);
+      ret &= (driver.stats().write_beats == 2);
+      ret &= (driver.stats().bytes_written == 5);
+      return !!ret;
+    });
+  }
+
+  SECTION("outstanding", "[outstanding]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      axi4_config config;
+      config.latency = 4;
+      config.max_outstanding = 2;
+      Axi4Driver driver(config);
+      driver.bind(0, buffer.data(), buffer.size());
+      // reads are held back while their data is not consumed
+      driver.master.rready = false;
+      driver.master.arvalid = true;
+      driver.master.ar = {0, 0, 0, 3, uint32_t(axi4_burst::incr)};
+      driver.run(20);
+      ret &= (driver.ar_count == 2);
+      ret &= !driver.slave.arready;
+      driver.master.rready = true;
+      driver.run(20);
+      driver.master.arvalid = false;
+      ret &= (driver.ar_count > 2);
+      driver.run(20);
+      ret &= (driver.rbeats.size() == driver.ar_count);
+      // writes are held back until their data is received
+      driver.master.awvalid = true;
+      driver.master.aw = {0, 0, 0, 3, uint32_t(axi4_burst::incr)};
+      driver.run(20);
+      ret &= (driver.aw_count == 2);
+      ret &= !driver.slave.awready;
+      driver.master.awvalid = false;
+      uint8_t wdata[Axi4Driver::data_size] = {};
+      driver.write_data(wdata, 0xff, true);
+      ret &= !driver.slave.awready;
+      // the address slot is released once the response is accepted
+      driver.wait_writes(1);
+      ret &= driver.slave.awready;
+      driver.write_data(wdata, 0xff, true);
+      driver.wait_writes(2);
+      ret &= (driver.stats().writes == 2);
+      return !!ret;
+    });
+  }
+
+  SECTION("reorder", "[reorder]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      for (int reorder = 0; reorder < 2; ++reorder) {
+        axi4_config config;
+        config.latency = 4;
+        config.reorder = reorder;
+        Axi4Driver driver(config);
+        driver.bind(0, buffer.data(), buffer.size());
+        // single beat reads, two per id
+        driver.master.rready = false;
+        for (uint32_t i = 0; i < 8; ++i) {
+          driver.read(i % 4, i * 8, 1, axi4_burst::incr);
+        }
+        driver.run(10);
+        driver.master.rready = true;
+        driver.wait_reads(8);
+        bool in_order = true;
+        for (uint32_t i = 0; i < 8; ++i) {
+          auto index = (driver.rbeats[i].data - buffer.data()) / 8;
+          ret &= (driver.rbeats[i].id == index % 4);
+          in_order &= (index == i);
+          // transactions with the same id complete in order
+          for (uint32_t j = 0; j < i; ++j) {
+            if (driver.rbeats[j].id == driver.rbeats[i].id) {
+              ret &= (driver.rbeats[j].data < driver.rbeats[i].data);
+            }
+          }
+        }
+        ret &= (in_order == !reorder);
+      }
+      return !!ret;
+    });
+  }
+
+  SECTION("stats", "[stats]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      std::vector<uint8_t> buffer(256);
+      axi4_config config;
+      config.latency = 5;
+      config.bus_width = 4;
+      Axi4Driver driver(config);
+      driver.bind(0, buffer.data(), buffer.size());
+      // 4 bytes per cycle, each 8-byte beat holds the bus for 2 cycles
+      auto t = driver.read(0, 0, 4, axi4_burst::incr);
+      driver.wait_reads(4);
+      for (uint32_t i = 0; i < 4; ++i) {
+        ret &= (driver.rbeats[i].time - t) == 5 + 1 + 2 * i;
+      }
+      auto& stats = driver.stats();
+      ret &= (stats.reads == 1);
+      ret &= (stats.read_beats == 4);
+      ret &= (stats.bytes_read == 32);
+      ret &= (stats.read_latency == 5 + 1 + 6);
+      ret &= (stats.max_read_latency == 12);
+      uint8_t wdata[Axi4Driver::data_size] = {};
+      t = driver.write(0, 0, 2, axi4_burst::incr);
+      driver.write_data(wdata, 0xff, false);
+      driver.write_data(wdata, 0x0f, true);
+      auto w = driver.time() - 1;
+      driver.wait_writes(1);
+      ret &= (driver.bresps[0].time == w + 5 + 1);
+      ret &= (stats.writes == 1);
+      ret &= (stats.write_beats == 2);
+      ret &= (stats.bytes_written == 12);
+      ret &= (stats.write_latency == w + 5 + 1 - t);
+      ret &= (stats.max_write_latency == stats.write_latency);
+      driver.run(10);
+      ret &= (stats.cycles == driver.time());
+      ret &= (stats.avg_read_latency() == 12.0);
+      return !!ret;
+    });
+  }
+
+  SECTION("device", "[device]") {
+    TESTX([]()->bool {
+      RetCheck ret;
+      using Cfg = axi4_properties<64, 32, 4>;
+      std::vector<uint64_t> buffer(8);
+      ch_device<Axi4Passthru<Cfg>> device;
+      ch_simulator sim(device);
+      axi4_slave_driver<Cfg> driver(1);
+      driver.bind(0, device.io.out, buffer.data(), buffer.size() * 8);
+      auto& in = device.io.in;
+      in.awvalid = false;
+      in.wvalid  = false;
+      in.arvalid = false;
+      in.bready  = true;
+      in.rready  = true;
+      sim.eval();
+      auto cycle = [&]() {
+        sim.eval();
+        driver.tick();
+        sim.eval();
+      };
+      // slave signals are sampled before the tick that completes the transfer
+      auto wait_ready = [&](const auto& ready) {
+        for (;;) {
+          bool accepted = static_cast<bool>(ready);
+          cycle();
+          if (accepted)
+            break;
+        }
+      };
+      // 2-beat write
+      in.awid = 3; in.awaddr = 8; in.awlen = 1; in.awsize = 3;
+      in.awburst = uint32_t(axi4_burst::incr);
+      in.awvalid = true;
+      wait_ready(in.awready);
+      in.awvalid = false;
+      for (uint32_t i = 0; i < 2; ++i) {
+        in.wdata = 0x1111111111111111ull * (i + 1);
+        in.wstrb = 0xff;
+        in.wlast = (1 == i);
+        in.wvalid = true;
+        wait_ready(in.wready);
+        in.wvalid = false;
+      }
+      while (!in.bvalid) {
+        cycle();
+      }
+      ret &= (3 == static_cast<uint32_t>(in.bid));
+      cycle();
+      ret &= (buffer[1] == 0x1111111111111111ull);
+      ret &= (buffer[2] == 0x2222222222222222ull);
+      // 2-beat read
+      in.arid = 5; in.araddr = 8; in.arlen = 1; in.arsize = 3;
+      in.arburst = uint32_t(axi4_burst::incr);
+      in.arvalid = true;
+      wait_ready(in.arready);
+      in.arvalid = false;
+      std::vector<uint64_t> rdata;
+      for (;;) {
+        bool valid = static_cast<bool>(in.rvalid);
+        bool last = static_cast<bool>(in.rlast);
+        if (valid) {
+          ret &= (5 == static_cast<uint32_t>(in.rid));
+          rdata.push_back(static_cast<uint64_t>(in.rdata));
+        }
+        cycle();
+        if (valid && last)
+          break;
+      }
+      ret &= (rdata.size() == 2);
+      ret &= (rdata[0] == buffer[1] && rdata[1] == buffer[2]);
+      ret &= (driver.stats().writes == 1);
+      ret &= (driver.stats().reads == 1);
+      ret &= (driver.stats().read_beats == 2);
+      return !!ret;
+    });
+  }
+}
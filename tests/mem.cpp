@@ -112,6 +112,32 @@ TEST_CASE("memory", "[memory]") {
       //ch_println("t={}, rst={}, clk={}, a={}, q={}, e={}", ch_now(), ch_reset(), ch_clock(), a, q, e);
       return (q == e);
     }, 4);
+    TEST([]()->ch_bool {
+      ch_reg<ch_uint2> a(0);
+      ch_rom<ch_bit16, 4> rom("res/rom.bin");
+      auto q = rom.read(a);
+      a->next = a + 1;
+      auto e = ch_case(a,
+            0, 0x1234_h)
+           (1, 0x5678_h)
+           (2, 0x9abc_h)
+               (0xdef0_h);
+      //ch_println("t={}, a={}, q={}, e={}", ch_now(), a, q, e);
+      return (q == e);
+    }, 4);
+    TEST([]()->ch_bool {
+      ch_reg<ch_uint2> a(0);
+      ch_rom<ch_bit4, 4> rom("res/rom.bin");
+      auto q = rom.read(a);
+      a->next = a + 1;
+      auto e = ch_case(a,
+            0, 0x4_h)
+           (1, 0x3_h)
+           (2, 0x2_h)
+               (0x1_h);
+      //ch_println("t={}, a={}, q={}, e={}", ch_now(), a, q, e);
+      return (q == e);
+    }, 4);
   }
   
   SECTION("mem", "[mem]") {
@@ -252,4 +278,104 @@ TEST_CASE("memory", "[memory]") {
       return (ch_now() < 1 || q == e);
     }, 4);
   }
+
+  SECTION("paged", "[paged]") {
+    TEST([]()->ch_bool {
+      auto_cflags_disable reg_init_off(ch_flags::force_reg_init);
+      ch_mem<ch_uint32, (1 << 20)> mem;
+      ch_reg<ch_uint<20>> i(0);
+      i->next = i + 1;
+      auto wa = i * 4099;
+      auto ra = (i - 1) * 4099;
+      mem.write(wa, ch_pad<12>(i));
+      auto q = mem.read(ra);
+      auto z = mem.read(wa);
+      //ch_println("t={0}, i={1}, wa={2}, ra={3}, q={4}, z={5}", ch_now(), i, wa, ra, q, z);
+      return (ch_now() < 2 || (q == ch_pad<12>(i - 1) && z == 0));
+    }, 8);
+
+    TEST([]()->ch_bool {
+      auto_cflags_disable reg_init_off(ch_flags::force_reg_init);
+      ch_mem<ch_bit<96>, (1 << 18)> mem;
+      ch_reg<ch_uint<18>> i(0);
+      i->next = i + 1;
+      auto wa = i * 1031;
+      auto ra = (i - 1) * 1031;
+      mem.write(wa, ch_cat(i, ch_bit<60>(0), i));
+      auto q = mem.read(ra);
+      auto z = mem.read(wa);
+      auto p = i - 1;
+      //ch_println("t={0}, i={1}, wa={2}, ra={3}, q={4}, z={5}", ch_now(), i, wa, ra, q, z);
+      return (ch_now() < 2 || (q == ch_cat(p, ch_bit<60>(0), p) && z == 0));
+    }, 8);
+
+    TESTX([]()->bool {
+      // addresses past the last page read zeros and drop writes,
+      // the JIT compiler range-checks addresses instead.
+      auto_cflags_enable jit_off(ch_flags::disable_jit);
+      ch_device<GenericModule2<ch_uint<20>, ch_uint32, ch_uint32>> device(
+        [](ch_uint<20> addr, ch_uint32 data)->ch_uint32 {
+          ch_mem<ch_uint32, 600000> mem;
+          mem.write(addr, data, data != 0);
+          return mem.read(addr);
+        }
+      );
+      ch_simulator sim(device);
+      auto access = [&](uint32_t addr, uint32_t data) {
+        device.io.lhs = addr;
+        device.io.rhs = data;
+        sim.step(2);
+        return static_cast<uint32_t>(device.io.out);
+      };
+      return (7 == access(5, 7))
+          && (0 == access(1000000, 11))
+          && (0 == access(1000000, 0))
+          && (7 == access(5, 0));
+    });
+
+    TESTX([]()->bool {
+      // memories past 2^32 bits
+      auto run = [](int flags) {
+        auto_cflags_enable cflags(flags);
+        ch_device<GenericModule2<ch_uint<27>, ch_uint64, ch_uint64>> device(
+          [](ch_uint<27> addr, ch_uint64 data)->ch_uint64 {
+            ch_mem<ch_uint64, (1 << 27)> mem;
+            mem.set_name("big");
+            mem.write(addr, data, data != 0);
+            return mem.read(addr);
+          }
+        );
+        ch_simulator sim(device);
+        auto access = [&](uint32_t addr, uint64_t data) {
+          device.io.lhs = addr;
+          device.io.rhs = data;
+          sim.step(2);
+          return static_cast<uint64_t>(device.io.out);
+        };
+        uint64_t image[2] = {0x0123456789abcdef, 0xfedcba9876543210};
+        sim.load_memory("big", image, sizeof(image), (1 << 27) - 2);
+        bool ok = (image[1] == access((1 << 27) - 1, 0));
+        ok &= (42 == access((1 << 26) + 3, 42));
+        uint64_t dump[3] = {1, 1, 1};
+        sim.dump_memory("big", dump, sizeof(dump), (1 << 26) + 2);
+        ok &= (0 == dump[0] && 42 == dump[1] && 0 == dump[2]);
+        return ok;
+      };
+      return run(static_cast<int>(ch_flags::disable_jit)) && run(0);
+    });
+
+    TESTX([]()->bool {
+      try {
+        ch_device<GenericModule2<ch_uint<27>, ch_uint64, ch_uint64>> device(
+          [](ch_uint<27> addr, ch_uint64)->ch_uint64 {
+            ch_mem<ch_uint64, (1 << 27)> mem(1);
+            return mem.read(addr);
+          }
+        );
+        return false;
+      } catch (const std::exception&) {
+        return true;
+      }
+    });
+  }
 }
@@ -2,6 +2,7 @@
 #include <htl/complex.h>
 #include <htl/queue.h>
 #include <htl/fixed.h>
+#include <thread>
 
 using namespace ch::htl;
 using namespace ch::extension;
@@ -55,6 +56,51 @@ namespace {
     }
   };
 
+  struct ManyPrints {
+    __io (
+      __in (ch_uint8)  in,
+      __out (ch_uint8) out
+    );
+
+    void describe() {
+      io.out = io.in;
+      // enough formats for ids to overflow a single byte
+      for (int i = 0; i < 300; ++i) {
+        ch_println("print" + std::to_string(i) + "={0}", io.in);
+      }
+    }
+  };
+
+  struct SubCover {
+    __io (
+      __in (ch_bit4)  in,
+      __out (ch_bit4) out
+    );
+
+    void describe() {
+      io.out = io.in;
+      ch_cover("in", io.in, {ch_bin("zero", 0),
+                             ch_bin("low", 1, 7),
+                             ch_bin("high", 8, 15),
+                             ch_bin::transition("up", 3, 4)});
+    }
+  };
+
+  struct Cover {
+    __io (
+      __in (ch_bit4) in,
+      __in (ch_bool) sel,
+      __out (ch_bit4) out
+    );
+
+    void describe() {
+      ch_module<SubCover> m;
+      m.io.in = io.in;
+      io.out = m.io.out;
+      ch_cover("cross", ch_slice<1>(io.in), {}, io.sel, {ch_bin("off", 0), ch_bin("on", 1)});
+    }
+  };
+
   template <typename T>
   struct Bypass2 {
     __io (
@@ -83,6 +129,30 @@ namespace {
     }
     ch_module<Bypass2<T>> bypass_;
   };
+
+  // records whether the creating thread wrote to the stream
+  class ThreadCapture : public std::stringbuf {
+  public:
+    ThreadCapture() : owner_(std::this_thread::get_id()), owner_writes_(false) {}
+
+    bool owner_writes() const {
+      return owner_writes_;
+    }
+
+  protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+      owner_writes_ = owner_writes_ || (std::this_thread::get_id() == owner_);
+      return std::stringbuf::xsputn(s, n);
+    }
+
+    int_type overflow(int_type c) override {
+      owner_writes_ = owner_writes_ || (std::this_thread::get_id() == owner_);
+      return std::stringbuf::overflow(c);
+    }
+
+    std::thread::id owner_;
+    std::atomic<bool> owner_writes_;
+  };
 }
 
 TEST_CASE("misc", "[misc]") {
@@ -291,6 +361,134 @@ TEST_CASE("misc", "[misc]") {
       ch_println("a={0:e}", a);
       return ch_true;
     });
+
+  #ifndef NDEBUG
+    // prints are compiled out of release builds
+    TESTX([]()->bool {
+      auto capture = [](bool deferred) {
+        auto_cflags_enable cflags(deferred ? ch_flags::deferred_print : ch_flags(0));
+        std::stringstream ss;
+        auto old_buf = std::cout.rdbuf(ss.rdbuf());
+        {
+          ch_device<Print<ch_bit128>> device;
+          ch_simulator sim(device);
+          for (int i = 0; i < 64; ++i) {
+            device.io.in = i;
+            sim.step();
+          }
+        }
+        std::cout.rdbuf(old_buf);
+        return ss.str();
+      };
+      auto immediate = capture(false);
+      auto deferred = capture(true);
+      return !immediate.empty() && (immediate == deferred);
+    });
+
+    TESTX([]()->bool {
+      auto capture = [](bool deferred) {
+        auto_cflags_enable cflags(deferred ? ch_flags::deferred_print : ch_flags(0));
+        std::stringstream ss;
+        auto old_buf = std::cout.rdbuf(ss.rdbuf());
+        {
+          ch_device<ManyPrints> device;
+          ch_simulator sim(device);
+          for (int i = 0; i < 4; ++i) {
+            device.io.in = i;
+            sim.step();
+          }
+        }
+        std::cout.rdbuf(old_buf);
+        return ss.str();
+      };
+      auto immediate = capture(false);
+      auto deferred = capture(true);
+      return immediate.find("print299=0x3") != std::string::npos
+          && (immediate == deferred);
+    });
+
+    TESTX([]()->bool {
+      // cached instances and forks log through their own deferred logger
+      auto capture = [](bool deferred) {
+        auto_cflags_enable cflags(deferred ? ch_flags::deferred_print : ch_flags(0));
+        ThreadCapture buf;
+        auto old_buf = std::cout.rdbuf(&buf);
+        {
+          ch_device<Print<ch_bit8>> device;
+          auto run = [&](ch_simulator& sim, int start) {
+            for (int i = start; i < start + 8; ++i) {
+              sim.poke(device.io.in, i);
+              sim.step();
+            }
+          };
+          ch_simulator fork;
+          {
+            ch_simulator sim1(device);
+            run(sim1, 0);
+            fork = sim1.fork();
+          }
+          {
+            ch_simulator sim2(device);
+            run(sim2, 16);
+          }
+          run(fork, 32);
+        }
+        std::cout.rdbuf(old_buf);
+        return std::make_pair(buf.str(), buf.owner_writes());
+      };
+      auto immediate = capture(false);
+      auto deferred = capture(true);
+      return (immediate.first.find("io.in=0x27") != std::string::npos)
+          && (immediate.first == deferred.first)
+          && immediate.second
+          && !deferred.second;
+    });
+  #endif
+  }
+
+  SECTION("cover", "[cover]") {
+    TESTX([]()->bool {
+      ch_device<Cover> device;
+      ch_simulator sim(device);
+      for (int i = 0; i < 32; ++i) {
+        device.io.in  = i % 16;
+        device.io.sel = (i / 4) % 2;
+        sim.step(2);
+      }
+      auto coverage = sim.coverage();
+      if (coverage.points.size() != 2)
+        return false;
+      std::map<std::string, uint64_t> hits;
+      for (auto& point : coverage.points) {
+        auto pos = point.name.rfind('/');
+        auto name = point.name.substr(pos + 1);
+        for (auto& bin : point.bins) {
+          hits[name + "." + bin.name] = bin.hits;
+        }
+      }
+      bool ret = (hits.size() == 8)
+              && (hits["in.zero"] == 2)
+              && (hits["in.low"] == 14)
+              && (hits["in.high"] == 16)
+              && (hits["in.up"] == 2)
+              && (hits["cross.0,off"] == 8)
+              && (hits["cross.1,off"] == 8)
+              && (hits["cross.0,on"] == 8)
+              && (hits["cross.1,on"] == 8)
+              && (coverage.ratio() == 1.0);
+
+      coverage.save("cover.txt");
+      ch_coverage loaded;
+      loaded.load("cover.txt");
+      loaded.merge(coverage);
+      ret &= (loaded.points.size() == 2)
+          && (loaded.points[0].bins[0].hits == 2 * coverage.points[0].bins[0].hits);
+
+      std::stringstream ss;
+      loaded.report(ss);
+      ret &= (ss.str().find("total: 100.00% (8/8)") != std::string::npos);
+      return ret;
+    });
   }
 
   SECTION("streams", "[streams]") {
@@ -1,5 +1,6 @@
 #include "common.h"
 #include <htl/queue.h>
+#include <thread>
 
 using namespace ch::htl;
 namespace {
@@ -18,6 +19,96 @@ struct inverter {
   }
 };
 
+struct DualClock {
+  __io (
+    __in (ch_bool)   clk1,
+    __in (ch_bool)   clk2,
+    __out (ch_uint8) out1,
+    __out (ch_uint8) out2
+  );
+
+  void describe() {
+    ch_pushcd(io.clk1);
+    ch_reg<ch_uint8> count1(0);
+    count1->next = count1 + 1;
+    ch_popcd();
+
+    ch_pushcd(io.clk2);
+    ch_reg<ch_uint8> count2(0);
+    count2->next = count2 + 1;
+    ch_popcd();
+
+    io.out1 = count1;
+    io.out2 = count2;
+  }
+};
+
+struct DualClockLogic {
+  __io (
+    __in (ch_bool)   clk1,
+    __in (ch_bool)   clk2,
+    __out (ch_uint8) a,
+    __out (ch_uint8) b,
+    __out (ch_uint8) x,
+    __out (ch_uint8) z
+  );
+
+  void describe() {
+    ch_pushcd(io.clk1);
+    ch_reg<ch_uint8> a(0);
+    a->next = a + 1;
+    ch_popcd();
+
+    ch_pushcd(io.clk2);
+    ch_reg<ch_uint8> b(0);
+    b->next = b + 2;
+    ch_popcd();
+
+    auto x = (b << 1) + 3;
+    auto y = a ^ 0x5a;
+    io.a = a;
+    io.b = b;
+    io.x = x;
+    io.z = x + y;
+  }
+};
+
+struct AddChain {
+  __io (
+    __in (ch_uint32)  in,
+    __out (ch_uint32) out,
+    __out (ch_uint32) wide
+  );
+
+  void describe() {
+    std::vector<ch_uint32> x;
+    x.emplace_back(io.in);
+    for (uint32_t i = 0; i < 4000; ++i) {
+      x.emplace_back(x.back() + (i + 1));
+    }
+    ch_reg<ch_uint32> r(0);
+    r->next = x.back();
+    io.out = r;
+    auto w = ch_pad<131040>(io.in) << 131000;
+    io.wide = ch_slice<ch_uint32>(w, 131000);
+  }
+};
+
+struct MemTable {
+  __io (
+    __in (ch_uint8)   addr,
+    __in (ch_uint16)  wdata,
+    __out (ch_uint16) rdata
+  );
+
+  void describe() {
+    ch_mem<ch_uint16, 256> mem;
+    mem.set_name("ram");
+    mem.write(io.addr ^ 0x80, io.wdata);
+    io.rdata = mem.read(io.addr);
+  }
+};
+
 }
 
 TEST_CASE("simulation", "[sim]") {
@@ -37,6 +128,20 @@ TEST_CASE("simulation", "[sim]") {
       s4.eval();
       return (1 == device.io.out);
     });
+    TESTX([]()->bool {
+      // the instructions span several arena chunks, wide nodes get their own
+      auto_cflags_enable jit_off(ch_flags::disable_jit);
+      ch_device<AddChain> device;
+      ch_simulator sim(device);
+      RetCheck ret;
+      for (uint32_t value : {5u, 0xfffffff0u}) {
+        device.io.in = value;
+        sim.step(2);
+        ret &= (device.io.out == value + 8002000);
+        ret &= (device.io.wide == value);
+      }
+      return !!ret;
+    });
   }
 
   SECTION("tracer", "[tracer]") {
@@ -67,6 +172,631 @@ TEST_CASE("simulation", "[sim]") {
       t4.toVCD("trace.vcd");
       return (1 == device1.io.out && 1 == device2.io.out);
     });
+    TESTX([]()->bool {
+      ch_device<inverter<ch_bit4>> device;
+      ch_toVerilog("inverter.v", device);
+      ch_tracer tracer(device);
+      tracer.run([&](ch_tick t)->bool {
+        device.io.in = t;
+        return t < 8;
+      });
+      tracer.toVerilog("inverter_tb.v", "inverter.v");
+      RetCheck ret;
+      ret &= checkVerilog("inverter_tb.v");
+
+      auto read_lines = [](const std::string& file) {
+        std::vector<std::string> lines;
+        std::ifstream in(file);
+        for (std::string line; std::getline(in, line);) {
+          lines.push_back(line);
+        }
+        return lines;
+      };
+      std::stringstream tb;
+      tb << std::ifstream("inverter_tb.v").rdbuf();
+      auto stimulus = read_lines("inverter_tb_stimulus.hex");
+      auto expected = read_lines("inverter_tb_expected.hex");
+      ret &= (tb.str().find("$readmemh(\"inverter_tb_stimulus.hex\", tb_stimulus);") != std::string::npos);
+      ret &= (tb.str().find("$readmemh(\"inverter_tb_expected.hex\", tb_expected);") != std::string::npos);
+      ret &= (stimulus.size() == expected.size() && stimulus.size() > 1);
+      for (uint32_t i = 0; i < stimulus.size() && i < expected.size(); ++i) {
+        // the output and its tap both hold the inverted input,
+        // taps are compiled out of release builds.
+        auto out = stringf("%x", ~std::stoul(stimulus[i], nullptr, 16) & 0xf);
+      #ifndef NDEBUG
+        out += out;
+      #endif
+        ret &= (stimulus[i].size() == 1 && expected[i] == out);
+      }
+      for (auto file : {"inverter.v", "inverter_tb.v", "inverter_tb_stimulus.hex", "inverter_tb_expected.hex"}) {
+        std::remove(file);
+      }
+      return ret;
+    });
+  }
+
+  SECTION("replay", "[replay]") {
+    TESTX([]()->bool {
+      auto accumulate = [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+        ch_reg<ch_int4> sum(0);
+        sum->next = sum + lhs + rhs;
+        return sum;
+      };
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(accumulate);
+      ch_tracer tracer(device);
+      tracer.run([&](ch_tick t)->bool {
+        device.io.lhs = t & 0x7;
+        device.io.rhs = 3;
+        return t < 20;
+      });
+      tracer.toTrace("replay.trc");
+
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device2(accumulate);
+      ch_simulator sim(device2);
+      return sim.replay("replay.trc");
+    });
+    TESTX([]()->bool {
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(
+        [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+          ch_reg<ch_int4> sum(0);
+          sum->next = sum - lhs - rhs;
+          return sum;
+        }
+      );
+      ch_divergence divergence;
+      ch_simulator sim(device);
+      bool ret = sim.replay("replay.trc", &divergence);
+      return !ret 
+          && divergence.tick > 0
+          && divergence.signal.find("out") != std::string::npos
+          && divergence.expected != divergence.actual;
+    });
+    TESTX([]()->bool {
+      auto pipeline = [](ch_int2 lhs, ch_int2 rhs)->ch_int2 {
+        ch_module<ch_pipequeue<ch_int2, 4>> pipe;
+        pipe.io.enq.data = lhs + rhs;
+        pipe.io.enq.valid = true;
+        pipe.io.deq.ready = true;
+        return pipe.io.deq.data;
+      };
+      ch_device<GenericModule2<ch_int2, ch_int2, ch_int2>> device(pipeline);
+      ch_tracer tracer(device);
+      tracer.run([&](ch_tick t)->bool {
+        device.io.lhs = t & 0x1;
+        device.io.rhs = (t >> 1) & 0x1;
+        return t < 16;
+      });
+      tracer.toTrace("replay2.trc");
+
+      ch_device<GenericModule2<ch_int2, ch_int2, ch_int2>> device2(pipeline);
+      ch_simulator sim(device2);
+      return sim.replay("replay2.trc");
+    });
+  }
+
+  SECTION("checkpoint", "[checkpoint]") {
+    TESTX([]()->bool {
+      auto design = [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+        ch_reg<ch_int4> sum(0);
+        sum->next = sum + lhs + rhs;
+        ch_module<ch_queue<ch_int4, 4, true>> queue;
+        queue.io.enq.data  = sum;
+        queue.io.enq.valid = lhs[0];
+        queue.io.deq.ready = rhs[0];
+        return queue.io.deq.data;
+      };
+      auto run = [](auto& device, ch_simulator& sim, ch_tick start, ch_tick end) {
+        std::vector<int> outputs;
+        for (ch_tick t = start; t < end; ++t) {
+          device.io.lhs = t & 0x7;
+          device.io.rhs = (t >> 1) & 0x3;
+          sim.step(2);
+          outputs.push_back(static_cast<int>(device.io.out));
+        }
+        return outputs;
+      };
+
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(design);
+      ch_simulator sim(device);
+      sim.reset();
+      run(device, sim, 0, 20);
+      sim.save("sim.ckpt");
+      auto expected = run(device, sim, 20, 40);
+
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device2(design);
+      ch_simulator sim2(device2);
+      sim2.restore("sim.ckpt");
+      auto actual = run(device2, sim2, 20, 40);
+      return (expected == actual);
+    });
+    TESTX([]()->bool {
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(
+        [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+          return lhs ^ rhs;
+        }
+      );
+      ch_simulator sim(device);
+      try {
+        sim.restore("sim.ckpt");
+      } catch (const std::exception&) {
+        return true;
+      }
+      return false;
+    });
+    TESTX([]()->bool {
+      // designs only differing in a literal or in their source order
+      auto design = [](int value, bool swap) {
+        return [value, swap](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+          ch_reg<ch_int4> r(0);
+          r->next = (swap ? (rhs - lhs) : (lhs - rhs)) ^ value;
+          return r;
+        };
+      };
+      auto restores = [&](int value, bool swap) {
+        ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(design(value, swap));
+        ch_simulator sim(device);
+        try {
+          sim.restore("sim2.ckpt");
+        } catch (const std::exception&) {
+          return false;
+        }
+        return true;
+      };
+      {
+        ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(design(3, false));
+        ch_simulator sim(device);
+        sim.save("sim2.ckpt");
+      }
+      bool ret = restores(3, false) && !restores(5, false) && !restores(3, true);
+      std::remove("sim2.ckpt");
+      return ret;
+    });
+  }
+
+  SECTION("fork", "[fork]") {
+    TESTX([]()->bool {
+      auto design = [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+        ch_reg<ch_int4> sum(0);
+        sum->next = sum + lhs + rhs;
+        ch_module<ch_queue<ch_int4, 4, true>> queue;
+        queue.io.enq.data  = sum;
+        queue.io.enq.valid = lhs[0];
+        queue.io.deq.ready = rhs[0];
+        return queue.io.deq.data;
+      };
+      auto run = [](auto& device, ch_simulator& sim, ch_tick start, ch_tick end, int seed) {
+        std::vector<int> outputs;
+        for (ch_tick t = start; t < end; ++t) {
+          sim.poke(device.io.lhs, (t * seed) & 0x7);
+          sim.poke(device.io.rhs, ((t >> 1) + seed) & 0x3);
+          sim.step(2);
+          outputs.push_back(static_cast<int>(sim.peek(device.io.out)));
+        }
+        return outputs;
+      };
+
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(design);
+      ch_simulator sim(device);
+      sim.reset();
+      run(device, sim, 0, 20, 1);
+      auto fork1 = sim.fork();
+      auto fork2 = sim.fork();
+      auto fork3 = sim.fork();
+
+      std::vector<int> out2;
+      std::thread thread([&]() {
+        out2 = run(device, fork2, 20, 40, 3);
+      });
+      auto out1 = run(device, fork1, 20, 40, 1);
+      thread.join();
+
+      auto expected1 = run(device, sim, 20, 40, 1);
+      auto expected2 = run(device, fork3, 20, 40, 3);
+      return (out1 == expected1)
+          && (out2 == expected2)
+          && (out1 != out2);
+    });
+  }
+
+  SECTION("shared", "[shared]") {
+    TESTX([]()->bool {
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(
+        [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+          ch_reg<ch_int4> sum(0);
+          sum->next = sum + lhs + rhs;
+          return sum;
+        }
+      );
+      auto run = [&](ch_simulator& sim) {
+        std::vector<int> outputs;
+        for (ch_tick t = 0; t < 20; ++t) {
+          device.io.lhs = t & 0x7;
+          device.io.rhs = 1;
+          sim.step(2);
+          outputs.push_back(static_cast<int>(device.io.out));
+        }
+        return outputs;
+      };
+      ch_simulator sim1(device);
+      auto out1 = run(sim1);
+      // starts from the initial state of the shared design
+      ch_simulator sim2(device);
+      auto out2 = run(sim2);
+      return (out1 == out2);
+    });
+    TESTX([]()->bool {
+      // instances of different designs are created concurrently,
+      // instances of the same design wait for its first build.
+      auto adder = [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+        return ch_next(lhs + rhs);
+      };
+      auto suber = [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+        return ch_next(lhs - rhs);
+      };
+      using device_t = ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>>;
+      device_t device1(adder), device2(suber);
+      std::vector<int> outputs(8);
+      std::vector<std::thread> threads;
+      for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i]() {
+          auto& device = (i & 1) ? device2 : device1;
+          ch_simulator sim(device);
+          auto fork = sim.fork();
+          fork.poke(device.io.lhs, i);
+          fork.poke(device.io.rhs, 1);
+          fork.step(2);
+          outputs[i] = static_cast<int>(fork.peek(device.io.out));
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      bool ret = true;
+      for (int i = 0; i < 8; ++i) {
+        ret &= (outputs[i] == ((i & 1) ? i - 1 : i + 1));
+      }
+      return ret;
+    });
+  }
+
+  SECTION("clocks", "[clocks]") {
+    TESTX([]()->bool {
+      ch_device<DualClock> device;
+      ch_simulator sim(device);
+      sim.add_clock(device.io.clk1, 10, 5);
+      sim.add_clock(device.io.clk2, 15, 5);
+      sim.advance(100);
+      auto a = static_cast<int>(device.io.out1);
+      auto b = static_cast<int>(device.io.out2);
+      sim.advance(200);
+      auto da = (static_cast<int>(device.io.out1) - a) & 0xff;
+      auto db = (static_cast<int>(device.io.out2) - b) & 0xff;
+      // rising edges in (100, 300]
+      return (300 == sim.time())
+          && (20 == da)
+          && (13 == db);
+    });
+    TESTX([]()->bool {
+      // checkpoints resume the clocks at their saved time and phase
+      ch_device<DualClock> device;
+      ch_simulator sim(device);
+      sim.add_clock(device.io.clk1, 10, 5);
+      sim.add_clock(device.io.clk2, 15, 5);
+      sim.advance(103);
+      sim.save("clocks.ckpt");
+      sim.advance(200);
+      auto a = static_cast<int>(device.io.out1);
+      auto b = static_cast<int>(device.io.out2);
+
+      ch_device<DualClock> device2;
+      ch_simulator sim2(device2);
+      sim2.add_clock(device2.io.clk1, 10, 5);
+      sim2.add_clock(device2.io.clk2, 15, 5);
+      sim2.restore("clocks.ckpt");
+      bool ret = (103 == sim2.time());
+      sim2.advance(200);
+      ret &= (303 == sim2.time())
+          && (a == static_cast<int>(device2.io.out1))
+          && (b == static_cast<int>(device2.io.out2));
+      std::remove("clocks.ckpt");
+      return ret;
+    });
+    TESTX([]()->bool {
+      ch_device<DualClockLogic> device;
+      ch_simulator sim(device);
+      sim.add_clock(device.io.clk1, 4);
+      sim.add_clock(device.io.clk2, 22, 3);
+      bool ret = true;
+      for (int i = 0; i < 40; ++i) {
+        sim.advance(7);
+        auto a = static_cast<int>(device.io.a);
+        auto b = static_cast<int>(device.io.b);
+        auto x = static_cast<int>(device.io.x);
+        auto z = static_cast<int>(device.io.z);
+        ret &= (x == ((b * 2 + 3) & 0xff));
+        ret &= (z == ((x + (a ^ 0x5a)) & 0xff));
+      }
+      return ret;
+    });
+  }
+
+  SECTION("activity", "[activity]") {
+    TESTX([]()->bool {
+      auto design = [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+        ch_reg<ch_int4> sum(0);
+        sum->next = sum + lhs + rhs;
+        ch_module<ch_queue<ch_int4, 4, true>> queue;
+        queue.io.enq.data  = sum;
+        queue.io.enq.valid = lhs[0];
+        queue.io.deq.ready = rhs[0];
+        return queue.io.deq.data ^ (lhs - rhs);
+      };
+      auto run = [&](int flags) {
+        auto_cflags_enable cflags(flags);
+        ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(design);
+        ch_simulator sim(device);
+        sim.reset();
+        std::vector<int> outputs;
+        for (int t = 0; t < 400; ++t) {
+          // quiet phases with bursts of high input activity
+          int shift = (t >= 100 && t < 250) ? 0 : 4;
+          device.io.lhs = (t >> shift) & 0x7;
+          device.io.rhs = (t >> (shift + 1)) & 0x3;
+          sim.step();
+          outputs.push_back(static_cast<int>(device.io.out));
+          if (t == 300) {
+            sim.save("activity.ckpt");
+            sim.restore("activity.ckpt");
+          }
+        }
+        return outputs;
+      };
+      auto expected = run(static_cast<int>(ch_flags::disable_jit));
+      auto actual = run(ch_flags::activity_sim | ch_flags::disable_jit);
+      return (expected == actual);
+    });
+  }
+
+  SECTION("backdoor", "[backdoor]") {
+    TESTX([]()->bool {
+      auto design = [](ch_uint8 addr, ch_uint16 wdata)->ch_uint16 {
+        ch_module<MemTable> table;
+        table.io.addr  = addr;
+        table.io.wdata = wdata;
+        return table.io.rdata;
+      };
+      auto run = [&](int flags) {
+        auto_cflags_enable cflags(flags);
+        ch_device<GenericModule2<ch_uint8, ch_uint16, ch_uint16>> device(design);
+        ch_simulator sim(device);
+
+        std::vector<uint16_t> image(128);
+        for (int i = 0; i < 128; ++i) {
+          image[i] = i * 3 + 1;
+        }
+        // aligned and unaligned host buffers
+        std::vector<uint8_t> bytes(129);
+        memcpy(bytes.data() + 1, image.data() + 64, 128);
+        sim.load_memory("ram", image.data(), 128);
+        sim.load_memory("ram", bytes.data() + 1, 128, 64);
+
+        bool ok = true;
+        for (int t = 0; t < 128; ++t) {
+          device.io.lhs = t;
+          device.io.rhs = t * 5;
+          sim.step(2);
+          ok &= (static_cast<int>(device.io.out) == image[t]);
+        }
+
+        std::vector<uint16_t> dump(128);
+        sim.dump_memory("ram", dump.data(), 256, 128);
+        for (int i = 0; i < 128; ++i) {
+          ok &= (dump[i] == i * 5);
+        }
+
+        auto file = tempFile("ram.bin");
+        sim.dump_memory_file("ram", file);
+        ch_simulator sim2(device);
+        sim2.load_memory_file("ram", file);
+        std::vector<uint16_t> dump1(256), dump2(256);
+        sim.dump_memory("ram", dump1.data(), 512);
+        sim2.dump_memory("ram", dump2.data(), 512);
+        ok &= (dump1 == dump2);
+        // an image larger than the remaining items is clamped
+        sim2.load_memory_file("ram", file, 128);
+        sim2.dump_memory("ram", dump2.data(), 256, 128);
+        ok &= std::equal(dump2.begin(), dump2.begin() + 128, dump1.begin());
+        std::remove(file.c_str());
+        try {
+          sim.load_memory("ram", image.data(), 2, 257);
+          ok = false;
+        } catch (const std::exception&) {}
+
+        try {
+          sim.load_memory("rom", image.data(), 128);
+          ok = false;
+        } catch (const std::exception&) {}
+        return ok;
+      };
+      return run(static_cast<int>(ch_flags::disable_jit)) && run(0);
+    });
+  }
+
+  SECTION("handles", "[handles]") {
+    TESTX([]()->bool {
+      auto run = [&](int flags) {
+        auto_cflags_enable cflags(flags);
+        ch_device<GenericModule2<ch_uint64, ch_uint64, ch_uint64>> device(
+          [](ch_uint64 lhs, ch_uint64 rhs)->ch_uint64 {
+            return ch_next(lhs ^ rhs) + rhs;
+          }
+        );
+        ch_simulator sim(device);
+        ch_port_handle lhs(device.io.lhs);
+        ch_port_handle rhs(device.io.rhs);
+        ch_port_handle out(device.io.out);
+        bool ok = true;
+        for (uint64_t t = 0; t < 64; ++t) {
+          uint64_t a = 0x9e3779b97f4a7c15ull * (t + 1);
+          uint64_t b = ~a >> (t % 7);
+          lhs = a;
+          rhs = b;
+          sim.step(2);
+          auto value = out.read<uint64_t>();
+          ok &= (value == (a ^ b) + b);
+          ok &= (value == static_cast<uint64_t>(device.io.out));
+        }
+        return ok;
+      };
+      return run(static_cast<int>(ch_flags::disable_jit)) && run(0);
+    });
+    TESTX([]()->bool {
+      ch_device<GenericModule2<ch_int<12>, ch_int<12>, ch_int<12>>> device(
+        [](ch_int<12> lhs, ch_int<12> rhs)->ch_int<12> { return lhs - rhs; }
+      );
+      ch_simulator sim(device);
+      ch_port_handle lhs(device.io.lhs);
+      ch_port_handle rhs(device.io.rhs);
+      ch_port_handle out(device.io.out);
+      lhs = int16_t(-3);
+      rhs = int16_t(2000);
+      sim.eval();
+      return (-2003 == out.read<int16_t>())
+          && (-2003 == static_cast<int>(device.io.out))
+          && (-3 == lhs.read<int32_t>())
+          && (-3 == static_cast<int>(device.io.lhs));
+    });
+    TESTX([]()->bool {
+      ch_device<GenericModule2<ch_bool, ch_bool, ch_bool>> device(
+        [](ch_bool lhs, ch_bool rhs)->ch_bool { return lhs && !rhs; }
+      );
+      ch_simulator sim(device);
+      ch_port_handle lhs(device.io.lhs);
+      ch_port_handle rhs(device.io.rhs);
+      ch_port_handle out(device.io.out);
+      lhs = true;
+      rhs.write(false);
+      sim.eval();
+      bool ret = out.read<bool>() && static_cast<bool>(out);
+      rhs = true;
+      sim.eval();
+      ret &= !out.read<bool>() && lhs.read<bool>() && !static_cast<bool>(device.io.out);
+      return ret;
+    });
+  }
+
+  SECTION("streams", "[streams]") {
+    TESTX([]()->bool {
+      auto run = [&](int flags) {
+        auto_cflags_enable cflags(flags);
+        ch_device<GenericModule2<ch_uint16, ch_uint<12>, ch_uint16>> device(
+          [](ch_uint16 lhs, ch_uint<12> rhs)->ch_uint16 {
+            return ch_next(lhs + rhs);
+          }
+        );
+        // records hold lhs and rhs on 2 bytes each
+        int N = 1000;
+        std::vector<uint16_t> stimulus(2 * N);
+        for (int i = 0; i < N; ++i) {
+          stimulus[2 * i + 0] = i * 37;
+          stimulus[2 * i + 1] = (i * 11) & 0xfff;
+        }
+        auto stimulus_file = tempFile("stimulus.bin");
+        auto capture_file = tempFile("capture.bin");
+        {
+          std::ofstream out(stimulus_file, std::ios::binary);
+          out.write((const char*)stimulus.data(), stimulus.size() * 2);
+        }
+        ch_tick cycles;
+        {
+          ch_simulator sim(device);
+          sim.stream_inputs(stimulus_file, device.io.lhs, device.io.rhs);
+          sim.stream_outputs(capture_file, device.io.out);
+          cycles = sim.run_stream();
+        }
+        std::vector<uint16_t> capture(N);
+        std::ifstream in(capture_file, std::ios::binary | std::ios::ate);
+        bool ok = (cycles == ch_tick(N)) && (in.tellg() == 2 * N);
+        in.seekg(0);
+        in.read((char*)capture.data(), 2 * N);
+        in.close();
+        for (int i = 0; i < N; ++i) {
+          ok &= (capture[i] == uint16_t(stimulus[2 * i] + stimulus[2 * i + 1]));
+        }
+        std::remove(stimulus_file.c_str());
+        std::remove(capture_file.c_str());
+        return ok;
+      };
+      return run(static_cast<int>(ch_flags::disable_jit)) && run(0);
+    });
+  }
+
+  SECTION("watches", "[watches]") {
+    TESTX([]()->bool {
+      auto run = [&](int flags) {
+        auto_cflags_enable cflags(flags);
+        ch_device<GenericModule2<ch_uint<70>, ch_bool, ch_uint<70>>> device(
+          [](ch_uint<70> lhs, ch_bool)->ch_uint<70> {
+            return ch_next(lhs);
+          }
+        );
+        ch_simulator sim(device);
+        int changes = 0, equals = 0, rising = 0;
+        ch_tick equals_tick = 0;
+        auto key = sdata_type(70, std::array<uint64_t, 2>{5, 0x2a});
+        sim.watch(device.io.out, ch_watch::changes, [&](ch_tick) { ++changes; });
+        sim.watch(device.io.out, ch_watch::equals, key, [&](ch_tick t) { ++equals; equals_tick = t; });
+        sim.watch(device.io.rhs, ch_watch::rising, [&](ch_tick) { ++rising; });
+        for (int i = 0; i < 64; ++i) {
+          sim.poke(device.io.lhs, sdata_type(70, std::array<uint64_t, 2>{uint64_t(i & 0xf), 0x2a}));
+          device.io.rhs = (1 == (i % 4));
+          sim.step(2);
+        }
+        bool ok = (64 == changes) && (16 == rising) && (4 == equals) && (equals_tick > 100);
+        sim.clear_watches();
+        sim.step(8);
+        return ok && (64 == changes);
+      };
+      return run(static_cast<int>(ch_flags::disable_jit)) && run(0);
+    });
+  }
+
+  SECTION("tracediff", "[tracediff]") {
+    TESTX([]()->bool {
+      auto record = [](const std::string& file, int offset, int ticks = 1000) {
+        ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(
+          [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+            ch_reg<ch_int4> sum(0);
+            sum->next = sum + lhs + rhs;
+            return sum;
+          }
+        );
+        ch_tracer tracer(device);
+        tracer.run([&](ch_tick t)->bool {
+          device.io.lhs = t & 0x7;
+          device.io.rhs = (t < 400) ? 1 : offset;
+          return t < ticks;
+        });
+        tracer.toTrace(file);
+      };
+      record("diff1.trc", 1);
+      record("diff2.trc", 1);
+      record("diff3.trc", 2);
+      record("diff4.trc", 1, 600);
+      auto d12 = ch_traceDiff("diff1.trc", "diff2.trc", 0);
+      auto d13 = ch_traceDiff("diff1.trc", "diff3.trc");
+      auto d13_all = ch_traceDiff("diff1.trc", "diff3.trc", 0);
+      auto d14 = ch_traceDiff("diff1.trc", "diff4.trc", 0);
+      return d12.empty()
+          && 1 == d13.size()
+          && d13[0].tick >= 400
+          && d13[0].signal.find("rhs") != std::string::npos
+          && d13_all.size() > 1
+          && 1 == d14.size()
+          && "<length>" == d14[0].signal
+          && d14[0].tick >= 600 && d14[0].tick < 1000
+          && d14[0].expected != d14[0].actual;
+    });
   }
 
   SECTION("stats", "[stats]") {
@@ -91,5 +821,52 @@ TEST_CASE("simulation", "[sim]") {
       ch_stats(std::cout, device);
       return true;
     });
+
+    TESTX([]()->bool {
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(
+        [](ch_int4 lhs, ch_int4 rhs)->ch_int4 {
+          ch_module<ch_pipequeue<ch_int4, 4>> pipe;
+          pipe.io.enq.data = lhs + rhs;
+          pipe.io.enq.valid = true;
+          pipe.io.deq.ready = true;
+          return pipe.io.deq.data;
+        }
+      );
+      ch_simulator sim(device);
+      for (int t = 0; t < 100; ++t) {
+        device.io.lhs = t & 0x7;
+        device.io.rhs = 1;
+        sim.step(2);
+      }
+      auto stats = sim.stats();
+      stats.report(std::cout);
+      std::stringstream json;
+      stats.to_json(json);
+      return (200 == stats.ticks)
+          && (100 == stats.cycles)
+          && stats.eval_nodes > 0
+          && stats.num_nodes > 0
+          && stats.state_size > 0
+          && !stats.passes.empty()
+          && stats.elaboration_time > 0
+          && stats.run_time > 0
+          && stats.cycles_per_sec() > 0
+          && json.str().find("\"cycles\": 100,") != std::string::npos;
+    });
+
+    TESTX([]()->bool {
+      // direct eval() calls are timed too
+      ch_device<GenericModule2<ch_int4, ch_int4, ch_int4>> device(
+        [](ch_int4 lhs, ch_int4 rhs)->ch_int4 { return lhs + rhs; }
+      );
+      ch_simulator sim(device);
+      for (int t = 0; t < 100; ++t) {
+        device.io.lhs = t & 0x7;
+        sim.eval();
+      }
+      auto stats = sim.stats();
+      return (100 == stats.ticks)
+          && stats.run_time > 0;
+    });
   }
 }
@@ -24,6 +24,65 @@ namespace {
       return true;
     }
   };
+
+  struct AddPtr {
+    __sio (
+      __in (ch_int32)  lhs,
+      __in (ch_int32)  rhs,
+      __out (ch_int32) dst
+    );
+
+    void bind() {
+      lhs_ = ch_udf_ptr<int32_t>(io.lhs);
+      rhs_ = ch_udf_ptr<int32_t>(io.rhs);
+      dst_ = ch_udf_ptr<uint32_t>(io.dst);
+    }
+
+    void eval() {
+      *dst_ = *lhs_ + *rhs_;
+    }
+
+    const int32_t* lhs_;
+    const int32_t* rhs_;
+    uint32_t* dst_;
+  };
+
+  struct Xor128 {
+    __sio (
+      __in (ch_bit128)  lhs,
+      __in (ch_bit128)  rhs,
+      __out (ch_bit128) dst
+    );
+
+    void eval() {
+      auto lhs = ch_udf_ptr<uint64_t>(io.lhs);
+      auto rhs = ch_udf_ptr<uint64_t>(io.rhs);
+      auto dst = ch_udf_ptr<uint64_t>(io.dst);
+      for (uint32_t i = 0; i < 2; ++i) {
+        dst[i] = lhs[i] ^ rhs[i];
+      }
+    }
+  };
+
+  template <unsigned Latency>
+  struct AsyncPipe {
+    __io (
+      __in (ch_int32)  in,
+      __out (ch_int32) seq,
+      __out (ch_int32) async
+    );
+
+    void describe() {
+      ch_udf_seq<Add> seq;
+      seq.io.lhs = io.in;
+      seq.io.rhs = 1;
+      io.seq = seq.io.dst;
+      ch_udf_async<Add, Latency> async;
+      async.io.lhs = io.in;
+      async.io.rhs = 1;
+      io.async = async.io.dst;
+    }
+  };
 }
 
 TEST_CASE("udf", "[udf]") {
@@ -62,4 +121,52 @@ TEST_CASE("udf", "[udf]") {
       return (3 == udfs[0].io.dst && 3 == udfs[1].io.dst);
     }, 1);
   }
+
+  SECTION("udf_ptr", "[udf_ptr]") {
+    TEST([]()->ch_bool {
+      ch_udf_comb<AddPtr> udf;
+      udf.io.lhs = 5;
+      udf.io.rhs = -7;
+      return (-2 == udf.io.dst);
+    });
+
+    TEST([]()->ch_bool {
+      ch_udf_seq<AddPtr> udf;
+      udf.io.lhs = 1;
+      udf.io.rhs = 2;
+      return (3 == udf.io.dst);
+    }, 1);
+
+    TEST([]()->ch_bool {
+      ch_udf_comb<Xor128> udf;
+      udf.io.lhs = 0x123456780000000000000000ff_h128;
+      udf.io.rhs = 0x0f;
+      return (0x123456780000000000000000f0_h128 == udf.io.dst);
+    });
+  }
+
+  SECTION("udf_async", "[udf_async]") {
+    TESTX([]()->bool {
+      // async outputs trail the sequential ones by the latency
+      auto run = [](auto& device, int latency) {
+        ch_simulator sim(device);
+        std::vector<int32_t> seq;
+        bool ret = true;
+        sim.run([&](ch_tick t)->bool {
+          seq.push_back(static_cast<int32_t>(device.io.seq));
+          auto n = static_cast<int>(seq.size());
+          if (n > latency + 2) {
+            ret &= (static_cast<int32_t>(device.io.async) == seq[n - 1 - latency]);
+          }
+          device.io.in = static_cast<int32_t>(t * 3);
+          return (t < 60);
+        }, 2);
+        return ret;
+      };
+      ch_device<AsyncPipe<1>> device1;
+      ch_device<AsyncPipe<4>> device4;
+      // a second simulator recompiles designs with user-defined functions
+      return run(device1, 1) && run(device4, 4) && run(device1, 1);
+    });
+  }
 }
@@ -0,0 +1,45 @@
+#include <core.h>
+
+using namespace ch::core;
+
+static void usage(const char* prog) {
+  std::cerr << "usage: " << prog << " [-a] [-n <count>] <trace1> <trace2>" << std::endl;
+  std::cerr << "  -a          report all divergences" << std::endl;
+  std::cerr << "  -n <count>  report up to <count> divergences" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  uint32_t limit = 1;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "-a") {
+      limit = 0;
+    } else if (arg == "-n" && (i + 1) < argc) {
+      limit = std::stoul(argv[++i]);
+    } else if (arg == "-h" || arg == "--help") {
+      usage(argv[0]);
+      return 0;
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 2) {
+    usage(argv[0]);
+    return -1;
+  }
+
+  try {
+    auto divergences = ch_traceDiff(files[0], files[1], limit);
+    for (auto& d : divergences) {
+      std::cout << "tick " << d.tick << ": " << d.signal
+                << " = " << d.expected << " vs " << d.actual << std::endl;
+    }
+    return divergences.empty() ? 0 : 1;
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return -1;
+  }
+}